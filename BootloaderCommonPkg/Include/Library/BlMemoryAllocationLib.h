@@ -16,6 +16,36 @@ typedef struct {
   UINT32                Type;
 } EFI_MEMORY_RANGE_ENTRY;
 
+#define MEMORY_POOL_CLASS_MAX    8
+
+typedef struct {
+  UINT32                SlotSize;
+  UINT32                MaxSize;
+  UINT32                Slabs;
+  UINT32                InUse;
+  UINT32                Free;
+  UINT32                Reserved;
+  UINT64                Hits;
+  UINT64                Misses;
+  UINT64                Requested;
+} MEMORY_POOL_CLASS_STATS;
+
+typedef struct {
+  UINT32                   SlabSize;
+  UINT32                   ClassCount;
+  MEMORY_POOL_CLASS_STATS  Class[MEMORY_POOL_CLASS_MAX];
+} MEMORY_POOL_STATS;
+
+#define TEMPORARY_MEMORY_ARENA_SIGNATURE  SIGNATURE_32 ('T', 'A', 'R', 'N')
+
+typedef struct {
+  UINT32                Signature;
+  UINT32                Base;
+  UINT32                SavedHighWater;
+  UINT32                Peak;
+  CONST CHAR8          *Name;
+} TEMPORARY_MEMORY_ARENA;
+
 /**
   This function allocates temporary memory pool.
 
@@ -42,4 +72,68 @@ FreeTemporaryMemory (
   IN VOID   *Buffer
   );
 
+/**
+  Open a temporary memory arena.
+
+  The arena marks the current temporary memory pool position. All temporary
+  memory allocated after this point belongs to the arena until it is closed,
+  and the peak usage of the arena is tracked. Arenas can be nested.
+
+  @param[out] Arena     The arena handle to initialize.
+  @param[in]  Name      The arena name used in the debug log.
+
+**/
+VOID
+EFIAPI
+OpenTemporaryMemoryArena (
+  OUT TEMPORARY_MEMORY_ARENA  *Arena,
+  IN  CONST CHAR8             *Name
+  );
+
+/**
+  Release all temporary memory allocated within an arena.
+
+  The arena stays open and can be used again. Its peak usage is retained.
+
+  @param[in]  Arena     The arena handle.
+
+**/
+VOID
+EFIAPI
+ReleaseTemporaryMemoryArena (
+  IN  TEMPORARY_MEMORY_ARENA  *Arena
+  );
+
+/**
+  Close a temporary memory arena.
+
+  All temporary memory allocated within the arena is released and the arena
+  peak usage is reported.
+
+  @param[in]  Arena     The arena handle.
+
+  @retval     The peak temporary memory usage in bytes within the arena.
+
+**/
+UINT32
+EFIAPI
+CloseTemporaryMemoryArena (
+  IN  TEMPORARY_MEMORY_ARENA  *Arena
+  );
+
+/**
+  Retrieve the small pool allocator statistics.
+
+  @param[out]  Stats         The pointer to receive the statistics.
+
+  @retval     EFI_INVALID_PARAMETER  Stats is NULL.
+              EFI_UNSUPPORTED        The allocator does not keep statistics.
+              EFI_SUCCESS            Statistics are returned successfully.
+**/
+EFI_STATUS
+EFIAPI
+GetMemoryPoolStats (
+  OUT  MEMORY_POOL_STATS  *Stats
+  );
+
 #endif
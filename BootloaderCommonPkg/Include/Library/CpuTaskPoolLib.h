@@ -0,0 +1,203 @@
+/** @file
+  Task pool running parallel work on the APs parked in the MP task loop.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _CPU_TASK_POOL_LIB_H_
+#define _CPU_TASK_POOL_LIB_H_
+
+#include <Guid/MpCpuTaskInfoHob.h>
+
+#define CPU_TASK_POOL_MAX_WORKERS   32
+#define CPU_TASK_QUEUE_ALIGN        64
+
+/**
+  Task function processing the index range [Start, End).
+
+  @param[in]  Context   Caller context given when the group was started.
+  @param[in]  Start     First index to process.
+  @param[in]  End       One past the last index to process.
+
+**/
+typedef
+VOID
+(EFIAPI *CPU_TASK_RANGE_FUNC) (
+  IN  VOID    *Context,
+  IN  UINT32   Start,
+  IN  UINT32   End
+  );
+
+//
+// Per worker range of indexes still to process, and trace counters.
+// The range is packed as (End << 32) | Next so that it can be popped by
+// the owner and stolen by other workers with a single compare-exchange.
+// A queue is one cache line long, and Queue points to the first cache
+// line aligned entry of QueueBuffer so that no two queues share a line.
+//
+typedef struct {
+  volatile UINT64       Range;
+  UINT64                Ticks;
+  UINT32                Items;
+  UINT32                Steals;
+  UINT8                 Reserved[40];
+} CPU_TASK_QUEUE;
+
+typedef struct {
+  CPU_TASK_RANGE_FUNC   Func;
+  VOID                 *Context;
+  UINT32                Grain;
+  UINT32                WorkerCount;
+  volatile UINT32       NextWorker;
+  UINT32                Reserved;
+  UINT64                StartTick;
+  UINT64                EndTick;
+  CPU_TASK_QUEUE       *Queue;
+  CPU_TASK_QUEUE        QueueBuffer[CPU_TASK_POOL_MAX_WORKERS + 1];
+} CPU_TASK_GROUP;
+
+/**
+  Attach the task pool to the MP task slots of the current stage.
+
+  @param[in]  SysCpuTask      MP task slots, from MpGetTask () in Stage2 or
+                              from the SYS_CPU_TASK_HOB in a payload.
+                              NULL detaches the pool, so all work runs on
+                              the calling CPU.
+
+  @retval EFI_SUCCESS         The pool is ready.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskPoolInit (
+  IN  SYS_CPU_TASK    *SysCpuTask
+  );
+
+/**
+  Get the number of CPUs that can work on a task group, including the
+  calling CPU.
+
+  @retval     Number of CPUs available to the pool.
+
+**/
+UINT32
+EFIAPI
+CpuTaskPoolGetWorkerCount (
+  VOID
+  );
+
+/**
+  Start a task group processing indexes [0, Count) on the idle APs.
+
+  The index range is split evenly between the workers. Each worker takes
+  Grain indexes at a time from its own range and, once that is empty,
+  steals half of the remaining range of another worker. The caller joins
+  the work in CpuTaskGroupWait (), and may do unrelated work before that.
+
+  @param[out] Group           Group descriptor, must stay valid until
+                              CpuTaskGroupWait () returns.
+  @param[in]  Count           Number of indexes to process.
+  @param[in]  Grain           Indexes taken per call of Func, 0 for 1.
+  @param[in]  MaxWorkers      Maximum CPUs to use including the caller,
+                              0 for all available.
+  @param[in]  Func            Task function.
+  @param[in]  Context         Context passed to Func.
+
+  @retval EFI_SUCCESS           The group was started.
+  @retval EFI_INVALID_PARAMETER Group or Func is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskGroupStart (
+  OUT CPU_TASK_GROUP       *Group,
+  IN  UINT32                Count,
+  IN  UINT32                Grain,
+  IN  UINT32                MaxWorkers,
+  IN  CPU_TASK_RANGE_FUNC   Func,
+  IN  VOID                 *Context
+  );
+
+/**
+  Join a task group: process indexes on the calling CPU until no work is
+  left, then wait for the APs to finish.
+
+  On return Group->Queue[] holds, per worker, the indexes processed, the
+  ranges stolen and the TSC ticks spent, and Group->StartTick/EndTick
+  bound the whole group.
+
+  @param[in]  Group           Group started by CpuTaskGroupStart ().
+
+**/
+VOID
+EFIAPI
+CpuTaskGroupWait (
+  IN  CPU_TASK_GROUP       *Group
+  );
+
+/**
+  Process indexes [0, Count) in parallel and wait for completion.
+
+  @param[in]  Count           Number of indexes to process.
+  @param[in]  Grain           Indexes taken per call of Func, 0 for 1.
+  @param[in]  Func            Task function.
+  @param[in]  Context         Context passed to Func.
+
+  @retval EFI_SUCCESS           All indexes were processed.
+  @retval EFI_INVALID_PARAMETER Func is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskParallelFor (
+  IN  UINT32                Count,
+  IN  UINT32                Grain,
+  IN  CPU_TASK_RANGE_FUNC   Func,
+  IN  VOID                 *Context
+  );
+
+/**
+  Fill a memory range with a byte value, spreading the work over all CPUs
+  of the pool and using non-temporal stores so the caches are not flushed
+  by the fill.
+
+  @param[in]  Address             Start address.
+  @param[in]  Length              Length in bytes.
+  @param[in]  Value               Byte value to fill, normally 0.
+
+  @retval EFI_SUCCESS             The range was filled.
+  @retval EFI_INVALID_PARAMETER   The range is empty or not addressable.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskPoolScrubMemory (
+  IN  EFI_PHYSICAL_ADDRESS   Address,
+  IN  UINT64                 Length,
+  IN  UINT8                  Value
+  );
+
+/**
+  Check that every byte of a memory range holds a value, spreading the
+  work over all CPUs of the pool.
+
+  @param[in]  Address             Start address.
+  @param[in]  Length              Length in bytes.
+  @param[in]  Value               Expected byte value.
+
+  @retval EFI_SUCCESS             The whole range holds Value.
+  @retval EFI_INVALID_PARAMETER   The range is empty or not addressable.
+  @retval EFI_COMPROMISED_DATA    The range holds other bytes.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskPoolVerifyMemory (
+  IN  EFI_PHYSICAL_ADDRESS   Address,
+  IN  UINT64                 Length,
+  IN  UINT8                  Value
+  );
+
+#endif
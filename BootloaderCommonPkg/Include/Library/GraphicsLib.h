@@ -70,6 +70,10 @@ typedef struct {
   UINTN                         CursorY;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL ForegroundColor;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL BackgroundColor;
+  UINT32                        *GlyphPattern;
+  UINT32                        GlyphPatternFg;
+  UINT32                        GlyphPatternBg;
+  UINT32                        *LineBuf;
 } FRAME_BUFFER_CONSOLE;
 
 
@@ -15,6 +15,7 @@
 #include <Library/DebugLib.h>
 
 #define  LZMA_SIGNATURE    SIGNATURE_32 ('L', 'Z', 'M', 'A')
+#define  LZMF_SIGNATURE    SIGNATURE_32 ('L', 'Z', 'M', 'F')
 
 
 /**
@@ -87,5 +88,31 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+/**
+  Decompresses a Lzma compressed source buffer whose data went through the
+  x86 BCJ filter before compression, and reverses the filter.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+                      This is an optional parameter that may be NULL if the
+                      required scratch buffer size is 0.
+
+  @retval  RETURN_SUCCESS Decompression completed successfully, and
+                          the uncompressed buffer is returned in Destination.
+  @retval  RETURN_INVALID_PARAMETER
+                          The source buffer specified by Source is corrupted
+                          (not in a valid compressed format).
+**/
+RETURN_STATUS
+EFIAPI
+LzmaF86UefiDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  );
+
 #endif
 
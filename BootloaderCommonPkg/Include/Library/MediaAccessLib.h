@@ -11,6 +11,21 @@
 #include <BlockDevice.h>
 #include <Guid/OsBootOptionGuid.h>
 
+//
+// Number of device indexes tracked by the media block cache
+//
+#define MEDIA_CACHE_MAX_DEVICES    8
+
+typedef struct {
+  UINT64   Requests;
+  UINT64   RequestBytes;
+  UINT64   Hits;
+  UINT64   Misses;
+  UINT64   Bypassed;
+  UINT64   DeviceReads;
+  UINT64   DeviceBytes;
+} MEDIA_CACHE_STATS;
+
 /**
   Get current media interface type.
 
@@ -211,5 +226,24 @@ MediaTuning (
   IN UINTN                     MediaHcPciBase
   );
 
+/**
+  Get the block cache statistics of a device on the current media interface.
+
+  @param[in]  DeviceIndex    Specifies the block device to query.
+  @param[out] Stats          Pointer to receive the cache statistics.
+
+  @retval EFI_SUCCESS            The statistics were returned successfully.
+  @retval EFI_INVALID_PARAMETER  DeviceIndex is out of range or Stats is NULL.
+  @retval EFI_UNSUPPORTED        The block cache is disabled.
+  @retval EFI_NOT_READY          The MediaSetInterfaceType() has not been called yet.
+
+**/
+EFI_STATUS
+EFIAPI
+MediaGetCacheStats (
+  IN  UINTN                     DeviceIndex,
+  OUT MEDIA_CACHE_STATS        *Stats
+  );
+
 #endif
 
@@ -121,6 +121,29 @@ CreateIdentityMappingPageTables (
   IN  UINT8         RequestedAddressBits
   );
 
+/**
+  Extend the current long mode page tables to identity map a memory range.
+
+  Only the 1GB regions covering the requested range are populated, using 1GB
+  pages if supported or a single 2MB page directory per 1GB region otherwise.
+  Regions that are already mapped are left untouched.
+
+  @param[in] Base          Base address of the range to map.
+  @param[in] Length        Length of the range to map.
+
+  @retval    EFI_SUCCESS            The range is identity mapped.
+  @retval    EFI_UNSUPPORTED        Long mode is not enabled.
+  @retval    EFI_INVALID_PARAMETER  The range is beyond 4-level paging limit.
+  @retval    EFI_OUT_OF_RESOURCES   Failed to allocate page buffer.
+
+**/
+EFI_STATUS
+EFIAPI
+IdentityMapMemoryRange (
+  IN  UINT64        Base,
+  IN  UINT64        Length
+  );
+
 /**
   ASM inline function Paging32.nasm - Enable Paging
   Set Page Global Enable (Set PGE in CR4)
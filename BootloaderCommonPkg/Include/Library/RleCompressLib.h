@@ -1,5 +1,5 @@
 /** @file
-  RLE Decompress Library header.
+  RLE and NV blob compress library header.
 
   Copyright (c) 2018 - 2019, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -9,6 +9,30 @@
 #ifndef _LRE_COMPRESS_LIB_H_
 #define _LRE_COMPRESS_LIB_H_
 
+#define NV_BLOB_SIGNATURE       SIGNATURE_32 ('N', 'V', 'L', 'Z')
+
+#define NV_BLOB_METHOD_STORE    0
+#define NV_BLOB_METHOD_LZ4      1
+
+//
+// NV blob header, followed by the encoded data.
+// With NV_BLOB_METHOD_LZ4 the data is an LZ4 block. When DeltaStride is
+// not 0, each decoded byte is added to the one DeltaStride bytes before it
+// to get the original data.
+//
+typedef struct {
+  UINT32  Signature;
+  UINT32  Length;
+  UINT8   Method;
+  UINT8   DeltaStride;
+  UINT16  Reserved;
+} NV_BLOB_HEADER;
+
+//
+// Largest size of an NV blob for Length bytes of data
+//
+#define NV_BLOB_MAX_SIZE(Length)  ((Length) + sizeof (NV_BLOB_HEADER))
+
 /**
   Decompress data blob using RLE.
 
@@ -47,4 +71,49 @@ RleCompressData (
   IN  OUT UINT8             *Buffer
   );
 
+/**
+  Compress a small non-volatile data blob, such as memory training data.
+
+  The data is LZ4 compressed, either directly or after a byte delta
+  against the previous 1, 2 or 4 bytes, whichever is the smallest. If the
+  data does not compress it is stored as is.
+
+  @param  Data             Source data buffer pointer.
+  @param  Length           Source data size.
+  @param  Buffer           Destination data buffer.
+                           If NULL, no data will be written.
+                           The caller needs to ensure the buffer holds at
+                           least NV_BLOB_MAX_SIZE (Length) bytes.
+
+  @retval Compressed data length, including the NV_BLOB_HEADER.
+
+**/
+UINTN
+NvBlobCompress (
+  IN      CONST UINT8       *Data,
+  IN      UINTN              Length,
+  IN  OUT UINT8             *Buffer
+  );
+
+/**
+  Decompress a data blob created by NvBlobCompress ().
+
+  @param  Data             Source data buffer pointer.
+  @param  Length           Source data size.
+  @param  Buffer           Destination data buffer.
+                           If NULL, only the decompressed length is returned.
+  @param  BufferSize       Destination data buffer size.
+
+  @retval Decompressed data length, or 0 if the blob is not valid or does
+          not fit in the buffer.
+
+**/
+UINTN
+NvBlobDecompress (
+  IN      CONST UINT8       *Data,
+  IN      UINTN              Length,
+  IN  OUT UINT8             *Buffer,
+  IN      UINTN              BufferSize
+  );
+
 #endif
@@ -128,6 +128,24 @@ TpmExtendPcrAndLogEvent (
   );
 
 
+/**
+  Send all queued PCR extends to the TPM and log their events.
+
+  TpmExtendPcrAndLogEvent() may queue the PCR extend together with its
+  event. The event is logged only once its extend succeeded, so the TCG
+  event log always matches the PCR values. This function must be called
+  before PCR values are consumed, e.g. before handing off to a payload
+  that is not aware of the queue.
+
+  @retval RETURN_SUCCESS      All queued extends completed, or none were queued.
+  @retval Others              At least one queued extend failed.
+**/
+RETURN_STATUS
+TpmFlushPendingExtends (
+  VOID
+  );
+
+
 /**
   Log a PCR event in TCG 2.0 format.
 
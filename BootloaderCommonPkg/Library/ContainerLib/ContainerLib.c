@@ -738,6 +738,7 @@ LoadComponentWithCallback (
   UINT32                    ComponentId;
   UINT64                    ContainerIdBuf;
   UINT64                    ComponentIdBuf;
+  TEMPORARY_MEMORY_ARENA    Arena;
 
   ComponentId = ContainerSig;
   CompLoc = 0;
@@ -840,8 +841,11 @@ LoadComponentWithCallback (
   if (IsInFlash) {
     AllocLen += SignedDataLen;
   }
+  // Scratch and any temporary memory used by the callback are released together
+  OpenTemporaryMemoryArena (&Arena, "LoadComponent");
   AllocBuf = AllocateTemporaryMemory (AllocLen);
   if (AllocBuf == NULL) {
+    CloseTemporaryMemoryArena (&Arena);
     return EFI_OUT_OF_RESOURCES;
   }
   if (IsInFlash) {
@@ -905,6 +909,7 @@ LoadComponentWithCallback (
     Status = EFI_SECURITY_VIOLATION;
   }
   FreeTemporaryMemory (AllocBuf);
+  CloseTemporaryMemoryArena (&Arena);
 
   if (!EFI_ERROR (Status)) {
     if (Buffer != NULL) {
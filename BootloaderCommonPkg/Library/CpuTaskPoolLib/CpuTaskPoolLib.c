@@ -0,0 +1,639 @@
+/** @file
+  Task pool running parallel work on the APs parked in the MP task loop.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/CpuTaskPoolLib.h>
+
+#define RANGE_NEXT(Range)           ((UINT32)(Range))
+#define RANGE_END(Range)            ((UINT32)RShiftU64 ((Range), 32))
+#define RANGE_PACK(Next, End)       (LShiftU64 ((End), 32) | (Next))
+
+#define SCRUB_CHUNK_SIZE            SIZE_1MB
+#define SCRUB_ALIGN                 64
+
+typedef struct {
+  UINTN             Base;
+  UINTN             Length;
+  UINTN             Pattern;
+  volatile UINT32   Errors;
+} SCRUB_CONTEXT;
+
+STATIC volatile SYS_CPU_TASK  *mSysCpuTask;
+
+//
+// Group used by ScrubRange () and CpuTaskParallelFor (), kept off the
+// stack since it is over 2KB. mGroupBusy is set while it is in use.
+//
+STATIC CPU_TASK_GROUP          mGroup;
+STATIC volatile UINT32         mGroupBusy;
+
+/**
+  Fill memory with non-temporal stores, bypassing the caches.
+
+  @param[in]  Buffer      Start address, 4 or 8 byte aligned.
+  @param[in]  Length      Length in bytes, rounded down to 64 bytes.
+  @param[in]  Pattern     Value stored to each UINTN.
+
+**/
+VOID
+EFIAPI
+AsmScrubMemory (
+  IN  VOID    *Buffer,
+  IN  UINTN    Length,
+  IN  UINTN    Pattern
+  );
+
+/**
+  Take up to Grain indexes from the front of a worker's own range.
+
+  @param[in]   Queue    Worker queue.
+  @param[in]   Grain    Maximum indexes to take.
+  @param[out]  Start    First index taken.
+  @param[out]  End      One past the last index taken.
+
+  @retval      TRUE     Indexes were taken.
+  @retval      FALSE    The range is empty.
+
+**/
+STATIC
+BOOLEAN
+PopLocal (
+  IN   CPU_TASK_QUEUE   *Queue,
+  IN   UINT32            Grain,
+  OUT  UINT32           *Start,
+  OUT  UINT32           *End
+  )
+{
+  UINT64   Range;
+  UINT32   Next;
+  UINT32   Last;
+  UINT32   Take;
+
+  do {
+    Range = Queue->Range;
+    Next  = RANGE_NEXT (Range);
+    Last  = RANGE_END (Range);
+    if (Next >= Last) {
+      return FALSE;
+    }
+    Take = MIN (Grain, Last - Next);
+  } while (InterlockedCompareExchange64 (&Queue->Range, Range, RANGE_PACK (Next + Take, Last)) != Range);
+
+  *Start = Next;
+  *End   = Next + Take;
+  return TRUE;
+}
+
+/**
+  Steal the back half of another worker's remaining range into the
+  (empty) range of the calling worker.
+
+  @param[in]   Group    Task group.
+  @param[in]   Id       Calling worker index.
+
+  @retval      TRUE     A range was stolen.
+  @retval      FALSE    No work is left in any queue.
+
+**/
+STATIC
+BOOLEAN
+StealRange (
+  IN   CPU_TASK_GROUP   *Group,
+  IN   UINT32            Id
+  )
+{
+  CPU_TASK_QUEUE  *Victim;
+  CPU_TASK_QUEUE  *Own;
+  UINT64           Range;
+  UINT64           OwnRange;
+  UINT32           Next;
+  UINT32           Last;
+  UINT32           Split;
+  UINT32           Index;
+
+  Own = &Group->Queue[Id];
+  for (Index = 1; Index < Group->WorkerCount; Index++) {
+    Victim = &Group->Queue[(Id + Index) % Group->WorkerCount];
+    do {
+      Range = Victim->Range;
+      Next  = RANGE_NEXT (Range);
+      Last  = RANGE_END (Range);
+      if (Next >= Last) {
+        break;
+      }
+      Split = Last - (Last - Next + 1) / 2;
+    } while (InterlockedCompareExchange64 (&Victim->Range, Range, RANGE_PACK (Next, Split)) != Range);
+
+    if (Next < Last) {
+      //
+      // Publish the stolen part in the own queue so that other workers can
+      // steal from it again. The queue is empty, but a thief may still be
+      // reading it, and a plain 64-bit store is two stores on IA32.
+      //
+      do {
+        OwnRange = Own->Range;
+      } while (InterlockedCompareExchange64 (&Own->Range, OwnRange, RANGE_PACK (Split, Last)) != OwnRange);
+      Own->Steals++;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Process indexes of a task group as one worker until no work is left.
+
+  @param[in]  Group       Task group.
+  @param[in]  Id          Worker index.
+
+**/
+STATIC
+VOID
+RunWorker (
+  IN  CPU_TASK_GROUP   *Group,
+  IN  UINT32            Id
+  )
+{
+  CPU_TASK_QUEUE  *Queue;
+  UINT64           Tick;
+  UINT32           Start;
+  UINT32           End;
+
+  Queue = &Group->Queue[Id];
+  Tick  = AsmReadTsc ();
+  Start = 0;
+  End   = 0;
+  while (PopLocal (Queue, Group->Grain, &Start, &End) || StealRange (Group, Id)) {
+    if (Start < End) {
+      Group->Func (Group->Context, Start, End);
+      Queue->Items += End - Start;
+    }
+    Start = 0;
+    End   = 0;
+  }
+  Queue->Ticks = AsmReadTsc () - Tick;
+}
+
+/**
+  AP entry point for a task group.
+
+  @param[in]  Arg         Task group address.
+
+  @retval     0
+
+**/
+STATIC
+UINT64
+EFIAPI
+ApWorkerEntry (
+  IN  UINT64   Arg
+  )
+{
+  CPU_TASK_GROUP  *Group;
+
+  Group = (CPU_TASK_GROUP *)(UINTN)Arg;
+  RunWorker (Group, InterlockedIncrement (&Group->NextWorker));
+
+  return 0;
+}
+
+/**
+  Attach the task pool to the MP task slots of the current stage.
+
+  @param[in]  SysCpuTask      MP task slots, from MpGetTask () in Stage2 or
+                              from the SYS_CPU_TASK_HOB in a payload.
+                              NULL detaches the pool, so all work runs on
+                              the calling CPU.
+
+  @retval EFI_SUCCESS         The pool is ready.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskPoolInit (
+  IN  SYS_CPU_TASK    *SysCpuTask
+  )
+{
+  mSysCpuTask = SysCpuTask;
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the number of CPUs that can work on a task group, including the
+  calling CPU.
+
+  @retval     Number of CPUs available to the pool.
+
+**/
+UINT32
+EFIAPI
+CpuTaskPoolGetWorkerCount (
+  VOID
+  )
+{
+  UINT32   Count;
+  UINT32   Index;
+
+  Count = 1;
+  if (mSysCpuTask != NULL) {
+    for (Index = 1; Index < mSysCpuTask->CpuCount; Index++) {
+      if (mSysCpuTask->CpuTask[Index].State == EnumCpuReady) {
+        Count++;
+      }
+    }
+  }
+
+  return MIN (Count, CPU_TASK_POOL_MAX_WORKERS);
+}
+
+/**
+  Start a task group processing indexes [0, Count) on the idle APs.
+
+  The index range is split evenly between the workers. Each worker takes
+  Grain indexes at a time from its own range and, once that is empty,
+  steals half of the remaining range of another worker. The caller joins
+  the work in CpuTaskGroupWait (), and may do unrelated work before that.
+
+  @param[out] Group           Group descriptor, must stay valid until
+                              CpuTaskGroupWait () returns.
+  @param[in]  Count           Number of indexes to process.
+  @param[in]  Grain           Indexes taken per call of Func, 0 for 1.
+  @param[in]  MaxWorkers      Maximum CPUs to use including the caller,
+                              0 for all available.
+  @param[in]  Func            Task function.
+  @param[in]  Context         Context passed to Func.
+
+  @retval EFI_SUCCESS           The group was started.
+  @retval EFI_INVALID_PARAMETER Group or Func is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskGroupStart (
+  OUT CPU_TASK_GROUP       *Group,
+  IN  UINT32                Count,
+  IN  UINT32                Grain,
+  IN  UINT32                MaxWorkers,
+  IN  CPU_TASK_RANGE_FUNC   Func,
+  IN  VOID                 *Context
+  )
+{
+  volatile CPU_TASK   *CpuTask;
+  UINT32               Workers;
+  UINT32               Index;
+  UINT32               Start;
+  UINT32               Step;
+
+  if ((Group == NULL) || (Func == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Workers = CpuTaskPoolGetWorkerCount ();
+  if ((MaxWorkers != 0) && (Workers > MaxWorkers)) {
+    Workers = MaxWorkers;
+  }
+  if (Workers > Count) {
+    Workers = MAX (Count, 1);
+  }
+
+  ZeroMem (Group, sizeof (CPU_TASK_GROUP));
+  Group->Queue       = ALIGN_POINTER (Group->QueueBuffer, CPU_TASK_QUEUE_ALIGN);
+  Group->Func        = Func;
+  Group->Context     = Context;
+  Group->Grain       = (Grain == 0) ? 1 : Grain;
+  Group->WorkerCount = Workers;
+  Group->StartTick   = AsmReadTsc ();
+
+  //
+  // Split the indexes evenly, the first queues get the remainder
+  //
+  Start = 0;
+  for (Index = 0; Index < Workers; Index++) {
+    Step = Count / Workers + ((Index < Count % Workers) ? 1 : 0);
+    Group->Queue[Index].Range = RANGE_PACK (Start, Start + Step);
+    Start += Step;
+  }
+
+  //
+  // Hand the group to idle APs, worker 0 is the caller
+  //
+  for (Index = 1; (mSysCpuTask != NULL) && (Index < mSysCpuTask->CpuCount) && (Workers > 1); Index++) {
+    CpuTask = &mSysCpuTask->CpuTask[Index];
+    if (CpuTask->State == EnumCpuReady) {
+      CpuTask->TaskFunc = (UINT64)(UINTN)(CPU_TASK_FUNC)ApWorkerEntry;
+      CpuTask->Argument = (UINT64)(UINTN)Group;
+      CpuTask->State    = EnumCpuStart;
+      Workers--;
+    }
+  }
+
+  //
+  // Work of APs that could not be started is stolen by the others
+  //
+  return EFI_SUCCESS;
+}
+
+/**
+  Join a task group: process indexes on the calling CPU until no work is
+  left, then wait for the APs to finish.
+
+  On return Group->Queue[] holds, per worker, the indexes processed, the
+  ranges stolen and the TSC ticks spent, and Group->StartTick/EndTick
+  bound the whole group.
+
+  @param[in]  Group           Group started by CpuTaskGroupStart ().
+
+**/
+VOID
+EFIAPI
+CpuTaskGroupWait (
+  IN  CPU_TASK_GROUP       *Group
+  )
+{
+  UINT32   Index;
+
+  RunWorker (Group, 0);
+
+  if (mSysCpuTask != NULL) {
+    for (Index = 1; Index < mSysCpuTask->CpuCount; Index++) {
+      while ((mSysCpuTask->CpuTask[Index].State == EnumCpuStart) ||
+             (mSysCpuTask->CpuTask[Index].State == EnumCpuBusy)) {
+        CpuPause ();
+      }
+    }
+  }
+
+  Group->EndTick = AsmReadTsc ();
+}
+
+/**
+  Run indexes [0, Count) on all CPUs of the pool with the shared group,
+  or only on the calling CPU if the shared group is already in use, as
+  when a task function calls back into the pool.
+
+  @param[in]  Count           Number of indexes to process.
+  @param[in]  Grain           Indexes taken per call of Func, 0 for 1.
+  @param[in]  Func            Task function.
+  @param[in]  Context         Context passed to Func.
+
+  @retval     Number of CPUs that worked on the indexes.
+
+**/
+STATIC
+UINT32
+RunSharedGroup (
+  IN  UINT32                Count,
+  IN  UINT32                Grain,
+  IN  CPU_TASK_RANGE_FUNC   Func,
+  IN  VOID                 *Context
+  )
+{
+  UINT32   Workers;
+
+  if (InterlockedCompareExchange32 (&mGroupBusy, 0, 1) != 0) {
+    if (Count > 0) {
+      Func (Context, 0, Count);
+    }
+    return 1;
+  }
+
+  CpuTaskGroupStart (&mGroup, Count, Grain, 0, Func, Context);
+  CpuTaskGroupWait (&mGroup);
+  Workers = mGroup.WorkerCount;
+
+  mGroupBusy = 0;
+  return Workers;
+}
+
+/**
+  Fill the chunks [Start, End) of a scrub range.
+
+  @param[in]  Context     SCRUB_CONTEXT.
+  @param[in]  Start       First chunk.
+  @param[in]  End         One past the last chunk.
+
+**/
+STATIC
+VOID
+EFIAPI
+ScrubChunks (
+  IN  VOID    *Context,
+  IN  UINT32   Start,
+  IN  UINT32   End
+  )
+{
+  SCRUB_CONTEXT  *Scrub;
+  UINTN           Offset;
+  UINTN           Limit;
+
+  Scrub  = (SCRUB_CONTEXT *)Context;
+  Offset = (UINTN)Start * SCRUB_CHUNK_SIZE;
+  Limit  = MIN ((UINTN)End * SCRUB_CHUNK_SIZE, Scrub->Length);
+  AsmScrubMemory ((VOID *)(Scrub->Base + Offset), Limit - Offset, Scrub->Pattern);
+}
+
+/**
+  Check the chunks [Start, End) of a scrub range.
+
+  @param[in]  Context     SCRUB_CONTEXT.
+  @param[in]  Start       First chunk.
+  @param[in]  End         One past the last chunk.
+
+**/
+STATIC
+VOID
+EFIAPI
+VerifyChunks (
+  IN  VOID    *Context,
+  IN  UINT32   Start,
+  IN  UINT32   End
+  )
+{
+  SCRUB_CONTEXT  *Scrub;
+  UINTN          *Data;
+  UINTN           Count;
+  UINT32          Chunk;
+
+  Scrub = (SCRUB_CONTEXT *)Context;
+  for (Chunk = Start; Chunk < End; Chunk++) {
+    Data  = (UINTN *)(Scrub->Base + (UINTN)Chunk * SCRUB_CHUNK_SIZE);
+    Count = MIN (SCRUB_CHUNK_SIZE, Scrub->Length - (UINTN)Chunk * SCRUB_CHUNK_SIZE) / sizeof (UINTN);
+    while (Count > 0) {
+      if (*Data != Scrub->Pattern) {
+        InterlockedIncrement (&Scrub->Errors);
+        break;
+      }
+      Data++;
+      Count--;
+    }
+  }
+}
+
+/**
+  Run a scrub or verify pass over a memory range on all CPUs of the pool.
+
+  The unaligned head and tail bytes are handled on the calling CPU.
+
+  @param[in]  Address     Start address.
+  @param[in]  Length      Length in bytes.
+  @param[in]  Value       Byte value.
+  @param[in]  Verify      TRUE to check the range instead of filling it.
+
+  @retval EFI_SUCCESS             The pass completed and, for a verify
+                                  pass, the whole range holds Value.
+  @retval EFI_INVALID_PARAMETER   The range is not addressable.
+  @retval EFI_COMPROMISED_DATA    A verify pass found other bytes.
+
+**/
+STATIC
+EFI_STATUS
+ScrubRange (
+  IN  EFI_PHYSICAL_ADDRESS   Address,
+  IN  UINT64                 Length,
+  IN  UINT8                  Value,
+  IN  BOOLEAN                Verify
+  )
+{
+  SCRUB_CONTEXT    Scrub;
+  UINT8           *Head;
+  UINT8           *Tail;
+  UINTN            Index;
+  UINTN            HeadLen;
+  UINTN            TailLen;
+  UINT64           Start;
+  UINT64           TimeNs;
+  UINT32           Rate;
+  UINT32           Workers;
+
+  if ((Length == 0) || (Length > MAX_ADDRESS) || (Address > MAX_ADDRESS - Length + 1)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Start   = GetPerformanceCounter ();
+  Head    = (UINT8 *)(UINTN)Address;
+  HeadLen = MIN ((UINTN)(ALIGN_VALUE (Address, SCRUB_ALIGN) - Address), (UINTN)Length);
+  Scrub.Base    = (UINTN)Address + HeadLen;
+  Scrub.Length  = ((UINTN)Length - HeadLen) & ~(SCRUB_ALIGN - 1);
+  Scrub.Pattern = (UINTN)MultU64x32 (0x0101010101010101ULL, Value);
+  Scrub.Errors  = 0;
+  Tail    = (UINT8 *)(Scrub.Base + Scrub.Length);
+  TailLen = (UINTN)Length - HeadLen - Scrub.Length;
+
+  if (Verify) {
+    for (Index = 0; Index < HeadLen; Index++) {
+      Scrub.Errors += (Head[Index] != Value) ? 1 : 0;
+    }
+    for (Index = 0; Index < TailLen; Index++) {
+      Scrub.Errors += (Tail[Index] != Value) ? 1 : 0;
+    }
+  } else {
+    SetMem (Head, HeadLen, Value);
+    SetMem (Tail, TailLen, Value);
+  }
+
+  Workers = 1;
+  if (Scrub.Length > 0) {
+    Workers = RunSharedGroup ((UINT32)((Scrub.Length + SCRUB_CHUNK_SIZE - 1) / SCRUB_CHUNK_SIZE), 1,
+                              Verify ? VerifyChunks : ScrubChunks, &Scrub);
+  }
+
+  TimeNs = GetTimeInNanoSecond (GetPerformanceCounter () - Start);
+  Rate   = (TimeNs == 0) ? 0 : (UINT32)DivU64x64Remainder (MultU64x32 (Length, 100), TimeNs, NULL);
+  DEBUG ((DEBUG_INFO, "%a 0x%lx bytes @ 0x%lx on %d CPUs: %d.%02d GB/s\n", Verify ? "Verify" : "Scrub",
+          Length, Address, Workers, Rate / 100, Rate % 100));
+
+  if (Scrub.Errors != 0) {
+    DEBUG ((DEBUG_ERROR, "Memory @ 0x%lx does not hold 0x%02X in %d places!\n", Address, Value, Scrub.Errors));
+    return EFI_COMPROMISED_DATA;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Fill a memory range with a byte value, spreading the work over all CPUs
+  of the pool and using non-temporal stores so the caches are not flushed
+  by the fill.
+
+  @param[in]  Address             Start address.
+  @param[in]  Length              Length in bytes.
+  @param[in]  Value               Byte value to fill, normally 0.
+
+  @retval EFI_SUCCESS             The range was filled.
+  @retval EFI_INVALID_PARAMETER   The range is empty or not addressable.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskPoolScrubMemory (
+  IN  EFI_PHYSICAL_ADDRESS   Address,
+  IN  UINT64                 Length,
+  IN  UINT8                  Value
+  )
+{
+  return ScrubRange (Address, Length, Value, FALSE);
+}
+
+/**
+  Check that every byte of a memory range holds a value, spreading the
+  work over all CPUs of the pool.
+
+  @param[in]  Address             Start address.
+  @param[in]  Length              Length in bytes.
+  @param[in]  Value               Expected byte value.
+
+  @retval EFI_SUCCESS             The whole range holds Value.
+  @retval EFI_INVALID_PARAMETER   The range is empty or not addressable.
+  @retval EFI_COMPROMISED_DATA    The range holds other bytes.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskPoolVerifyMemory (
+  IN  EFI_PHYSICAL_ADDRESS   Address,
+  IN  UINT64                 Length,
+  IN  UINT8                  Value
+  )
+{
+  return ScrubRange (Address, Length, Value, TRUE);
+}
+
+/**
+  Process indexes [0, Count) in parallel and wait for completion.
+
+  @param[in]  Count           Number of indexes to process.
+  @param[in]  Grain           Indexes taken per call of Func, 0 for 1.
+  @param[in]  Func            Task function.
+  @param[in]  Context         Context passed to Func.
+
+  @retval EFI_SUCCESS           All indexes were processed.
+  @retval EFI_INVALID_PARAMETER Func is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+CpuTaskParallelFor (
+  IN  UINT32                Count,
+  IN  UINT32                Grain,
+  IN  CPU_TASK_RANGE_FUNC   Func,
+  IN  VOID                 *Context
+  )
+{
+  if (Func == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  RunSharedGroup (Count, Grain, Func, Context);
+  return EFI_SUCCESS;
+}
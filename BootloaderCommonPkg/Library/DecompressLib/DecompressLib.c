@@ -63,7 +63,7 @@ DecompressGetInfo (
     }
     Status = RETURN_SUCCESS;
   } else if (!FeaturePcdGet (PcdMinDecompression)) {
-    if (Signature == LZMA_SIGNATURE) {
+    if ((Signature == LZMA_SIGNATURE) || (Signature == LZMF_SIGNATURE)) {
       Status = LzmaUefiDecompressGetInfo (Source, SourceSize, DestinationSize, ScratchSize);
     }
   }
@@ -115,6 +115,8 @@ Decompress (
   } else if (!FeaturePcdGet (PcdMinDecompression)) {
     if (Signature == LZMA_SIGNATURE) {
       Status = LzmaUefiDecompress (Source, SourceSize, Destination, Scratch);
+    } else if (Signature == LZMF_SIGNATURE) {
+      Status = LzmaF86UefiDecompress (Source, SourceSize, Destination, Scratch);
     }
   }
 
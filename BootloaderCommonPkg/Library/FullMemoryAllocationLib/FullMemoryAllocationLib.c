@@ -649,3 +649,62 @@ FreeTemporaryMemory (
 {
   FreePool (Buffer);
 }
+
+/**
+  Open a temporary memory arena.
+
+  Temporary memory is allocated from the pool here and freed individually,
+  so the arena only records its name for the callers.
+
+  @param[out] Arena     The arena handle to initialize.
+  @param[in]  Name      The arena name used in the debug log.
+
+**/
+VOID
+EFIAPI
+OpenTemporaryMemoryArena (
+  OUT TEMPORARY_MEMORY_ARENA  *Arena,
+  IN  CONST CHAR8             *Name
+  )
+{
+  ZeroMem (Arena, sizeof (TEMPORARY_MEMORY_ARENA));
+  Arena->Signature = TEMPORARY_MEMORY_ARENA_SIGNATURE;
+  Arena->Name      = Name;
+}
+
+/**
+  Release all temporary memory allocated within an arena.
+
+  Temporary memory must be freed individually with FreeTemporaryMemory ()
+  here, so this function does nothing.
+
+  @param[in]  Arena     The arena handle.
+
+**/
+VOID
+EFIAPI
+ReleaseTemporaryMemoryArena (
+  IN  TEMPORARY_MEMORY_ARENA  *Arena
+  )
+{
+  ASSERT (Arena->Signature == TEMPORARY_MEMORY_ARENA_SIGNATURE);
+}
+
+/**
+  Close a temporary memory arena.
+
+  @param[in]  Arena     The arena handle.
+
+  @retval     0         Arena usage is not tracked by this allocator.
+
+**/
+UINT32
+EFIAPI
+CloseTemporaryMemoryArena (
+  IN  TEMPORARY_MEMORY_ARENA  *Arena
+  )
+{
+  ASSERT (Arena->Signature == TEMPORARY_MEMORY_ARENA_SIGNATURE);
+  Arena->Signature = 0;
+  return 0;
+}
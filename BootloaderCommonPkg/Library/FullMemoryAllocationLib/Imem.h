@@ -14,6 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/BlMemoryAllocationLib.h>
 
 #define  EFI_LOCK    UINTN
 
@@ -80,7 +81,8 @@ typedef enum {
 
 #define MEMORY_MAP_SIGNATURE   SIGNATURE_32('m','m','a','p')
 
-typedef struct {
+typedef struct _MEMORY_MAP MEMORY_MAP;
+struct _MEMORY_MAP {
   UINTN           Signature;
   LIST_ENTRY      Link;
   BOOLEAN         FromPages;
@@ -91,7 +93,16 @@ typedef struct {
 
   UINT64          VirtualStart;
   UINT64          Attribute;
-} MEMORY_MAP;
+
+  //
+  // Address ordered AVL index of the memory map. MaxFreeSize is the size of
+  // the largest free range within this subtree.
+  //
+  MEMORY_MAP      *Left;
+  MEMORY_MAP      *Right;
+  UINT64          MaxFreeSize;
+  UINTN           Height;
+};
 
 //
 // Internal prototypes
@@ -350,6 +361,50 @@ CoreInitializePool (
   VOID
   );
 
+/**
+  Called to initialize the slab size classes.
+
+**/
+VOID
+CoreInitializeSlab (
+  VOID
+  );
+
+/**
+  Internal function to allocate a small pool buffer from the slabs.
+  Caller must have the memory lock held
+
+  @param  PoolType               Type of pool to allocate
+  @param  Size                   The amount of pool to allocate
+
+  @return The allocated buffer, or NULL if the request is not served by slabs
+          or no memory is available.
+
+**/
+VOID *
+CoreAllocateSlabI (
+  IN EFI_MEMORY_TYPE  PoolType,
+  IN UINTN            Size
+  );
+
+/**
+  Internal function to free a slab buffer.
+  Caller must have the memory lock held
+
+  @param  Buffer                 The allocated pool entry to free
+  @param  PoolType               Pointer to pool type
+
+  @retval EFI_NOT_FOUND          Buffer was not allocated from a slab.
+  @retval EFI_INVALID_PARAMETER  Buffer not valid
+  @retval EFI_SUCCESS            Buffer successfully freed.
+
+**/
+EFI_STATUS
+CoreFreeSlabI (
+  IN VOID               *Buffer,
+  OUT EFI_MEMORY_TYPE   *PoolType OPTIONAL
+  );
+
 /**
   Called to initialize the Pages.
 
@@ -43,6 +43,10 @@ UINTN         mFreeMapStack = 0;
 /// This list maintain the free memory map list
 ///
 LIST_ENTRY    mFreeMemoryMapEntryList = INITIALIZE_LIST_HEAD_VARIABLE (mFreeMemoryMapEntryList);
+///
+/// Root of the address ordered index of all gMemoryMap descriptors
+///
+MEMORY_MAP    *mMemoryMapRoot = NULL;
 
 CONST EFI_MEMORY_TYPE_STATISTICS mMemoryTypeStatisticsInit[EfiMaxMemoryType + 1] = {
   { 0, 0, 0, 0, EfiMaxMemoryType, TRUE,  FALSE },  // EfiReservedMemoryType
@@ -77,6 +81,7 @@ CoreInitializePages (
   mMemoryMapKey = 0;
   mMapDepth     = 0;
   mFreeMapStack = 0;
+  mMemoryMapRoot = NULL;
 
   InitializeListHead (&mFreeMemoryMapEntryList);
   InitializeListHead (&gMemoryMap);
@@ -110,11 +115,290 @@ CoreReleaseMemoryLock (
   CoreReleaseLock (&gMemoryLock);
 }
 
+/**
+  Internal function.  Get the height of a memory map index subtree.
+
+  @param  Node                   The subtree root, or NULL
+
+  @return The height of the subtree
+
+**/
+STATIC
+UINTN
+MemoryMapIndexHeight (
+  IN MEMORY_MAP      *Node
+  )
+{
+  return (Node == NULL) ? 0 : Node->Height;
+}
+
+/**
+  Internal function.  Recompute the height and the largest free range size
+  of a memory map index node from its children.
+
+  @param  Node                   The node to update
+
+**/
+STATIC
+VOID
+MemoryMapIndexUpdate (
+  IN OUT MEMORY_MAP  *Node
+  )
+{
+  UINT64          MaxFreeSize;
+
+  MaxFreeSize = 0;
+  if (Node->Type == EfiConventionalMemory) {
+    MaxFreeSize = Node->End - Node->Start + 1;
+  }
+  if ((Node->Left != NULL) && (Node->Left->MaxFreeSize > MaxFreeSize)) {
+    MaxFreeSize = Node->Left->MaxFreeSize;
+  }
+  if ((Node->Right != NULL) && (Node->Right->MaxFreeSize > MaxFreeSize)) {
+    MaxFreeSize = Node->Right->MaxFreeSize;
+  }
+
+  Node->MaxFreeSize = MaxFreeSize;
+  Node->Height      = MAX (MemoryMapIndexHeight (Node->Left), MemoryMapIndexHeight (Node->Right)) + 1;
+}
+
+/**
+  Internal function.  Rebalance a memory map index subtree after its children
+  have changed.
+
+  @param  Node                   The subtree root
+
+  @return The new subtree root
+
+**/
+STATIC
+MEMORY_MAP *
+MemoryMapIndexBalance (
+  IN OUT MEMORY_MAP  *Node
+  )
+{
+  MEMORY_MAP      *Pivot;
+  INTN            Balance;
+
+  MemoryMapIndexUpdate (Node);
+  Balance = (INTN)MemoryMapIndexHeight (Node->Left) - (INTN)MemoryMapIndexHeight (Node->Right);
+
+  if (Balance > 1) {
+    if (MemoryMapIndexHeight (Node->Left->Left) < MemoryMapIndexHeight (Node->Left->Right)) {
+      //
+      // Rotate left on the left child first
+      //
+      Pivot              = Node->Left->Right;
+      Node->Left->Right  = Pivot->Left;
+      Pivot->Left        = Node->Left;
+      MemoryMapIndexUpdate (Pivot->Left);
+      Node->Left         = Pivot;
+    }
+    //
+    // Rotate right
+    //
+    Pivot       = Node->Left;
+    Node->Left  = Pivot->Right;
+    Pivot->Right = Node;
+    MemoryMapIndexUpdate (Node);
+    MemoryMapIndexUpdate (Pivot);
+    return Pivot;
+  }
+
+  if (Balance < -1) {
+    if (MemoryMapIndexHeight (Node->Right->Right) < MemoryMapIndexHeight (Node->Right->Left)) {
+      //
+      // Rotate right on the right child first
+      //
+      Pivot              = Node->Right->Left;
+      Node->Right->Left  = Pivot->Right;
+      Pivot->Right       = Node->Right;
+      MemoryMapIndexUpdate (Pivot->Right);
+      Node->Right        = Pivot;
+    }
+    //
+    // Rotate left
+    //
+    Pivot       = Node->Right;
+    Node->Right = Pivot->Left;
+    Pivot->Left = Node;
+    MemoryMapIndexUpdate (Node);
+    MemoryMapIndexUpdate (Pivot);
+    return Pivot;
+  }
+
+  return Node;
+}
+
+/**
+  Internal function.  Insert a descriptor into a memory map index subtree.
+
+  @param  Node                   The subtree root, or NULL
+  @param  Entry                  The descriptor to insert
+
+  @return The new subtree root
+
+**/
+STATIC
+MEMORY_MAP *
+MemoryMapIndexInsertNode (
+  IN MEMORY_MAP      *Node,
+  IN MEMORY_MAP      *Entry
+  )
+{
+  if (Node == NULL) {
+    Entry->Left  = NULL;
+    Entry->Right = NULL;
+    MemoryMapIndexUpdate (Entry);
+    return Entry;
+  }
+
+  ASSERT (Entry->Start != Node->Start);
+  if (Entry->Start < Node->Start) {
+    Node->Left  = MemoryMapIndexInsertNode (Node->Left, Entry);
+  } else {
+    Node->Right = MemoryMapIndexInsertNode (Node->Right, Entry);
+  }
+
+  return MemoryMapIndexBalance (Node);
+}
+
+/**
+  Internal function.  Detach the lowest descriptor from a memory map index subtree.
+
+  @param  Node                   The subtree root
+  @param  Lowest                 Receives the detached descriptor
+
+  @return The new subtree root
+
+**/
+STATIC
+MEMORY_MAP *
+MemoryMapIndexRemoveLowest (
+  IN  MEMORY_MAP     *Node,
+  OUT MEMORY_MAP     **Lowest
+  )
+{
+  if (Node->Left == NULL) {
+    *Lowest = Node;
+    return Node->Right;
+  }
+
+  Node->Left = MemoryMapIndexRemoveLowest (Node->Left, Lowest);
+  return MemoryMapIndexBalance (Node);
+}
+
+/**
+  Internal function.  Remove a descriptor from a memory map index subtree.
+
+  @param  Node                   The subtree root
+  @param  Entry                  The descriptor to remove
+
+  @return The new subtree root
+
+**/
+STATIC
+MEMORY_MAP *
+MemoryMapIndexRemoveNode (
+  IN MEMORY_MAP      *Node,
+  IN MEMORY_MAP      *Entry
+  )
+{
+  MEMORY_MAP      *Successor;
+
+  if (Node == NULL) {
+    ASSERT (FALSE);
+    return NULL;
+  }
+
+  if (Entry->Start < Node->Start) {
+    Node->Left  = MemoryMapIndexRemoveNode (Node->Left, Entry);
+  } else if (Entry->Start > Node->Start) {
+    Node->Right = MemoryMapIndexRemoveNode (Node->Right, Entry);
+  } else {
+    ASSERT (Node == Entry);
+    if (Node->Right == NULL) {
+      return Node->Left;
+    }
+    Node->Right      = MemoryMapIndexRemoveLowest (Node->Right, &Successor);
+    Successor->Left  = Node->Left;
+    Successor->Right = Node->Right;
+    Node = Successor;
+  }
+
+  return MemoryMapIndexBalance (Node);
+}
+
+/**
+  Internal function.  Adds a descriptor to the memory map index.
+  The descriptor range must not overlap any indexed descriptor.
+
+  @param  Entry                  The descriptor to add
+
+**/
+STATIC
+VOID
+InsertMemoryMapIndex (
+  IN MEMORY_MAP      *Entry
+  )
+{
+  mMemoryMapRoot = MemoryMapIndexInsertNode (mMemoryMapRoot, Entry);
+}
+
+/**
+  Internal function.  Removes a descriptor from the memory map index.
+  The descriptor Start must not have been changed since it was indexed.
+
+  @param  Entry                  The descriptor to remove
+
+**/
+STATIC
+VOID
+RemoveMemoryMapIndex (
+  IN MEMORY_MAP      *Entry
+  )
+{
+  mMemoryMapRoot = MemoryMapIndexRemoveNode (mMemoryMapRoot, Entry);
+  Entry->Left    = NULL;
+  Entry->Right   = NULL;
+}
+
+/**
+  Internal function.  Finds the descriptor that covers an address.
+
+  @param  Address                The address to look up
+
+  @return The descriptor covering Address, or NULL if not found
+
+**/
+STATIC
+MEMORY_MAP *
+FindMemoryMapEntry (
+  IN UINT64          Address
+  )
+{
+  MEMORY_MAP      *Node;
+
+  Node = mMemoryMapRoot;
+  while (Node != NULL) {
+    if (Address < Node->Start) {
+      Node = Node->Left;
+    } else if (Address > Node->End) {
+      Node = Node->Right;
+    } else {
+      break;
+    }
+  }
+
+  return Node;
+}
+
 
 
 
 /**
   Internal function.  Removes a descriptor entry.
+  The caller must have removed it from the memory map index already.
 
   @param  Entry                  The entry to remove
 
@@ -155,7 +439,6 @@ CoreAddRange (
   IN UINT64                   Attribute
   )
 {
-  LIST_ENTRY        *Link;
   MEMORY_MAP        *Entry;
 
   ASSERT ((Start & EFI_PAGE_MASK) == 0);
@@ -191,29 +474,23 @@ CoreAddRange (
   // and the same Attribute
   //
 
-  Link = gMemoryMap.ForwardLink;
-  while (Link != &gMemoryMap) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    Link  = Link->ForwardLink;
-
-    if (Entry->Type != Type) {
-      continue;
-    }
-
-    if (Entry->Attribute != Attribute) {
-      continue;
-    }
-
-    if (Entry->End + 1 == Start) {
-
-      Start = Entry->Start;
-      RemoveMemoryMapEntry (Entry);
-
-    } else if (Entry->Start == End + 1) {
+  // Only the descriptors ending right below Start and starting right
+  // above End can be adjoining, look them up in the index.
+  //
+  Entry = (Start == 0) ? NULL : FindMemoryMapEntry (Start - 1);
+  if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
+    ASSERT (Entry->End + 1 == Start);
+    Start = Entry->Start;
+    RemoveMemoryMapIndex (Entry);
+    RemoveMemoryMapEntry (Entry);
+  }
 
-      End = Entry->End;
-      RemoveMemoryMapEntry (Entry);
-    }
+  Entry = FindMemoryMapEntry (End + 1);
+  if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute)) {
+    ASSERT (Entry->Start == End + 1);
+    End = Entry->End;
+    RemoveMemoryMapIndex (Entry);
+    RemoveMemoryMapEntry (Entry);
   }
 
   //
@@ -228,6 +505,7 @@ CoreAddRange (
   mMapStack[mMapDepth].VirtualStart  = 0;
   mMapStack[mMapDepth].Attribute     = Attribute;
   InsertTailList (&gMemoryMap, &mMapStack[mMapDepth].Link);
+  InsertMemoryMapIndex (&mMapStack[mMapDepth]);
 
   mMapDepth += 1;
   ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -296,8 +574,6 @@ CoreFreeMemoryMapStack (
   )
 {
   MEMORY_MAP      *Entry;
-  MEMORY_MAP      *Entry2;
-  LIST_ENTRY      *Link2;
 
   ASSERT_LOCKED (&gMemoryLock);
 
@@ -331,6 +607,7 @@ CoreFreeMemoryMapStack (
       //
       // Move this entry to general memory
       //
+      RemoveMemoryMapIndex (&mMapStack[mMapDepth]);
       RemoveEntryList (&mMapStack[mMapDepth].Link);
       mMapStack[mMapDepth].Link.ForwardLink = NULL;
 
@@ -338,16 +615,10 @@ CoreFreeMemoryMapStack (
       Entry->FromPages = TRUE;
 
       //
-      // Find insertion location
+      // The list order does not matter, address order is kept by the index
       //
-      for (Link2 = gMemoryMap.ForwardLink; Link2 != &gMemoryMap; Link2 = Link2->ForwardLink) {
-        Entry2 = CR (Link2, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-        if (Entry2->FromPages && Entry2->Start > Entry->Start) {
-          break;
-        }
-      }
-
-      InsertTailList (Link2, &Entry->Link);
+      InsertTailList (&gMemoryMap, &Entry->Link);
+      InsertMemoryMapIndex (Entry);
 
     } else {
       //
@@ -440,7 +711,6 @@ CoreConvertPagesEx (
   UINT64          RangeEnd;
   UINT64          Attribute;
   EFI_MEMORY_TYPE MemType;
-  LIST_ENTRY      *Link;
   MEMORY_MAP      *Entry;
 
   Entry = NULL;
@@ -466,15 +736,8 @@ CoreConvertPagesEx (
     //
     // Find the entry that the covers the range
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-      if (Entry->Start <= Start && Entry->End > Start) {
-        break;
-      }
-    }
-
-    if (Link == &gMemoryMap) {
+    Entry = FindMemoryMapEntry (Start);
+    if (Entry == NULL) {
       DEBUG ((DEBUG_ERROR | DEBUG_PAGE, "ConvertPages: failed to find range %lx - %lx\n", Start, End));
       return EFI_NOT_FOUND;
     }
@@ -528,8 +791,10 @@ CoreConvertPagesEx (
     }
 
     //
-    // Pull range out of descriptor
+    // Pull range out of descriptor. The descriptor leaves the index while
+    // its range is changed.
     //
+    RemoveMemoryMapIndex (Entry);
     if (Entry->Start == Start) {
 
       //
@@ -566,6 +831,7 @@ CoreConvertPagesEx (
 
       Entry->End = Start - 1;
       ASSERT (Entry->Start < Entry->End);
+      InsertMemoryMapIndex (Entry);
 
       Entry = &mMapStack[mMapDepth];
       InsertTailList (&gMemoryMap, &Entry->Link);
@@ -592,6 +858,8 @@ CoreConvertPagesEx (
     if (Entry->Start == Entry->End + 1) {
       RemoveMemoryMapEntry (Entry);
       Entry = NULL;
+    } else {
+      InsertMemoryMapIndex (Entry);
     }
 
     //
@@ -658,6 +926,90 @@ CoreConvertPages (
   return CoreConvertPagesEx (Start, NumberOfPages, TRUE, NewType, FALSE, 0);
 }
 
+/**
+  Internal function. Finds the highest free descriptor in a memory map index
+  subtree that can hold the requested range.
+
+  Descriptors do not overlap, so the first match found walking down from the
+  highest address is also the one with the highest usable end address.
+
+  @param  Node                   The subtree root, or NULL
+  @param  MaxAddress             The address that the range must be below
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+
+  @return The last address of the usable range, or 0 if the range was not found
+
+**/
+STATIC
+UINT64
+MemoryMapIndexFindFree (
+  IN MEMORY_MAP       *Node,
+  IN UINT64           MaxAddress,
+  IN UINT64           MinAddress,
+  IN UINT64           NumberOfBytes,
+  IN UINTN            Alignment
+  )
+{
+  UINT64          Target;
+  UINT64          DescStart;
+  UINT64          DescEnd;
+
+  //
+  // Skip the whole subtree if no free descriptor in it is large enough
+  //
+  if ((Node == NULL) || (Node->MaxFreeSize < NumberOfBytes)) {
+    return 0;
+  }
+
+  //
+  // Higher addresses first
+  //
+  if (Node->Start < MaxAddress) {
+    Target = MemoryMapIndexFindFree (Node->Right, MaxAddress, MinAddress, NumberOfBytes, Alignment);
+    if (Target != 0) {
+      return Target;
+    }
+  }
+
+  //
+  // If it's not a free entry, or desc is past max allowed address or below
+  // min allowed address, don't bother with it
+  //
+  DescStart = Node->Start;
+  DescEnd   = Node->End;
+  if ((Node->Type == EfiConventionalMemory) && (DescStart < MaxAddress) && (DescEnd >= MinAddress)) {
+    //
+    // If desc ends past max allowed address, clip the end
+    //
+    if (DescEnd >= MaxAddress) {
+      DescEnd = MaxAddress;
+    }
+
+    //
+    // Skip if nothing is left after alignment clipping
+    //
+    DescEnd = (DescEnd + 1) & (~ ((UINT64)Alignment - 1));
+    if (DescEnd > DescStart) {
+      DescEnd -= 1;
+      //
+      // Check the descriptor is large enough and the start of the allocated
+      // range is not below the min address allowed
+      //
+      if ((DescEnd - DescStart + 1 >= NumberOfBytes) && ((DescEnd - NumberOfBytes + 1) >= MinAddress)) {
+        return DescEnd;
+      }
+    }
+  }
+
+  if (Node->Start > MinAddress) {
+    return MemoryMapIndexFindFree (Node->Left, MaxAddress, MinAddress, NumberOfBytes, Alignment);
+  }
+
+  return 0;
+}
+
 /**
   Internal function. Finds a consecutive free page range below
   the requested address.
@@ -683,11 +1035,6 @@ CoreFindFreePagesI (
 {
   UINT64          NumberOfBytes;
   UINT64          Target;
-  UINT64          DescStart;
-  UINT64          DescEnd;
-  UINT64          DescNumberOfBytes;
-  LIST_ENTRY      *Link;
-  MEMORY_MAP      *Entry;
 
   if ((MaxAddress < EFI_PAGE_MASK) || (NumberOfPages == 0)) {
     return 0;
@@ -716,64 +1063,7 @@ CoreFindFreePagesI (
   }
 
   NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
-  Target = 0;
-
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-    //
-    // If it's not a free entry, don't bother with it
-    //
-    if (Entry->Type != EfiConventionalMemory) {
-      continue;
-    }
-
-    DescStart = Entry->Start;
-    DescEnd = Entry->End;
-
-    //
-    // If desc is past max allowed address or below min allowed address, skip it
-    //
-    if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
-      continue;
-    }
-
-    //
-    // If desc ends past max allowed address, clip the end
-    //
-    if (DescEnd >= MaxAddress) {
-      DescEnd = MaxAddress;
-    }
-
-    DescEnd = ((DescEnd + 1) & (~ (Alignment - 1))) - 1;
-
-    // Skip if DescEnd is less than DescStart after alignment clipping
-    if (DescEnd < DescStart) {
-      continue;
-    }
-
-    //
-    // Compute the number of bytes we can used from this
-    // descriptor, and see it's enough to satisfy the request
-    //
-    DescNumberOfBytes = DescEnd - DescStart + 1;
-
-    if (DescNumberOfBytes >= NumberOfBytes) {
-      //
-      // If the start of the allocated range is below the min address allowed, skip it
-      //
-      if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
-        continue;
-      }
-
-      //
-      // If this is the best match so far remember it
-      //
-      if (DescEnd > Target) {
-        Target = DescEnd;
-      }
-    }
-  }
+  Target = MemoryMapIndexFindFree (mMemoryMapRoot, MaxAddress, MinAddress, NumberOfBytes, Alignment);
 
   //
   // If this is a grow down, adjust target to be the allocation base
@@ -1023,7 +1313,6 @@ CoreInternalFreePages (
   )
 {
   EFI_STATUS      Status;
-  LIST_ENTRY      *Link;
   MEMORY_MAP      *Entry;
   UINTN           Alignment;
 
@@ -1035,14 +1324,8 @@ CoreInternalFreePages (
   //
   // Find the entry that the covers the range
   //
-  Entry = NULL;
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    if (Entry->Start <= Memory && Entry->End > Memory) {
-      break;
-    }
-  }
-  if (Link == &gMemoryMap) {
+  Entry = FindMemoryMapEntry (Memory);
+  if (Entry == NULL) {
     Status = EFI_NOT_FOUND;
     goto Done;
   }
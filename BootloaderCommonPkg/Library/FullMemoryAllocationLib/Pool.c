@@ -123,6 +123,8 @@ CoreInitializePool (
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
     }
   }
+
+  CoreInitializeSlab ();
 }
 
 
@@ -302,6 +304,14 @@ CoreAllocatePoolI (
 
   ASSERT_LOCKED (&gMemoryLock);
 
+  //
+  // Small requests are served from the size-class slabs (fast)
+  //
+  Buffer = CoreAllocateSlabI (PoolType, Size);
+  if (Buffer != NULL) {
+    return Buffer;
+  }
+
   if  (PoolType == EfiACPIReclaimMemory   ||
        PoolType == EfiACPIMemoryNVS       ||
        PoolType == EfiRuntimeServicesCode ||
@@ -525,8 +535,18 @@ CoreFreePoolI (
   UINTN       Offset;
   BOOLEAN     AllFree;
   UINTN       Granularity;
+  EFI_STATUS  Status;
 
   ASSERT (Buffer != NULL);
+
+  //
+  // Check if the entry belongs to a slab first
+  //
+  Status = CoreFreeSlabI (Buffer, PoolType);
+  if (Status != EFI_NOT_FOUND) {
+    return Status;
+  }
+
   //
   // Get the head & tail of the pool entry
   //
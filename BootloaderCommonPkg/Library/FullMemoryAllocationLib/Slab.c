@@ -0,0 +1,365 @@
+/** @file
+  Size-class slab allocator for small pool allocations.
+
+  Small EfiBootServicesData pool requests are served from fixed size slots
+  carved out of naturally aligned slabs. Each size class keeps a list of
+  slabs that still have free slots, so both allocation and free are O(1).
+  Larger requests and other memory types keep using the generic pool.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "Imem.h"
+
+#define SLAB_SIZE             SIZE_16KB
+#define SLAB_CACHE_LINE       64
+
+//
+// Slot header. It mirrors the pool header layout so that the signature is
+// found at the same offset in front of the caller data for both allocators.
+//
+#define SLAB_HEAD_SIGNATURE   SIGNATURE_32('s','h','d','0')
+#define SLAB_FREE_SIGNATURE   SIGNATURE_32('s','f','r','0')
+typedef struct _SLAB_HEAD SLAB_HEAD;
+struct _SLAB_HEAD {
+  UINT32          Signature;
+  UINT32          Index;
+  EFI_MEMORY_TYPE Type;
+  union {
+    UINTN         Size;
+    SLAB_HEAD    *Next;
+  } u;
+  CHAR8           Data[1];
+};
+
+#define SIZE_OF_SLAB_HEAD OFFSET_OF(SLAB_HEAD, Data)
+
+//
+// Slab descriptor placed at the start of every slab
+//
+#define SLAB_SIGNATURE        SIGNATURE_32('s','l','a','b')
+typedef struct {
+  UINT32          Signature;
+  UINT32          Index;
+  UINT32          InUse;
+  UINT32          Total;
+  LIST_ENTRY      Link;
+  SLAB_HEAD      *FreeList;
+} SLAB;
+
+#define SLAB_FIRST_SLOT       ALIGN_VALUE (sizeof (SLAB), SLAB_CACHE_LINE)
+
+#define HEAD_TO_SLAB(a)       ((SLAB *) ((UINTN) (a) & ~ (UINTN) (SLAB_SIZE - 1)))
+
+//
+// Slot sizes including the slot header. All of them are powers of two so
+// that slots of SLAB_CACHE_LINE bytes or more start on a cache line.
+//
+STATIC CONST UINT16 mSlabSizeTable[] = {
+  32, 64, 128, 256, 512, 1024, 2048
+};
+
+#define MAX_SLAB_CLASS        (ARRAY_SIZE (mSlabSizeTable))
+#define MAX_SLAB_ALLOC_SIZE   (mSlabSizeTable[MAX_SLAB_CLASS - 1] - SIZE_OF_SLAB_HEAD)
+
+typedef struct {
+  LIST_ENTRY      PartialList;
+  UINT32          Slabs;
+  UINT32          InUse;
+  UINT64          Hits;
+  UINT64          Misses;
+  UINT64          Requested;
+} SLAB_CLASS;
+
+STATIC SLAB_CLASS     mSlabClass[MAX_SLAB_CLASS];
+
+/**
+  Get slab size class index from the specified size.
+
+  @param  Size          The requested allocation size.
+
+  @return               The index of slab size table, or MAX_SLAB_CLASS if
+                        the size is not served by slabs.
+
+**/
+STATIC
+UINTN
+GetSlabIndexFromSize (
+  IN UINTN   Size
+  )
+{
+  UINTN   Index;
+
+  Size += SIZE_OF_SLAB_HEAD;
+  for (Index = 0; Index < MAX_SLAB_CLASS; Index++) {
+    if (mSlabSizeTable[Index] >= Size) {
+      return Index;
+    }
+  }
+  return MAX_SLAB_CLASS;
+}
+
+/**
+  Called to initialize the slab size classes.
+
+**/
+VOID
+CoreInitializeSlab (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  ZeroMem (mSlabClass, sizeof (mSlabClass));
+  for (Index = 0; Index < MAX_SLAB_CLASS; Index++) {
+    InitializeListHead (&mSlabClass[Index].PartialList);
+  }
+}
+
+/**
+  Allocate a new slab for a size class and carve it into free slots.
+
+  @param  Index                  The size class index.
+
+  @return The new slab, or NULL if no pages are available.
+
+**/
+STATIC
+SLAB *
+CoreRefillSlab (
+  IN UINTN            Index
+  )
+{
+  SLAB        *Slab;
+  SLAB_HEAD   *Slot;
+  UINTN       SlotSize;
+  UINTN       Offset;
+
+  Slab = CoreAllocatePoolPages (EfiBootServicesData, EFI_SIZE_TO_PAGES (SLAB_SIZE), SLAB_SIZE);
+  if (Slab == NULL) {
+    return NULL;
+  }
+
+  Slab->Signature = SLAB_SIGNATURE;
+  Slab->Index     = (UINT32)Index;
+  Slab->InUse     = 0;
+  Slab->Total     = 0;
+  Slab->FreeList  = NULL;
+
+  //
+  // Push slots from the end so that allocations walk the slab upwards
+  //
+  SlotSize = mSlabSizeTable[Index];
+  Offset   = SLAB_FIRST_SLOT + ((SLAB_SIZE - SLAB_FIRST_SLOT) / SlotSize - 1) * SlotSize;
+  while (Offset >= SLAB_FIRST_SLOT) {
+    Slot            = (SLAB_HEAD *) ((CHAR8 *)Slab + Offset);
+    Slot->Signature = SLAB_FREE_SIGNATURE;
+    Slot->Index     = (UINT32)Index;
+    Slot->u.Next    = Slab->FreeList;
+    Slab->FreeList  = Slot;
+    Slab->Total++;
+    if (Offset == SLAB_FIRST_SLOT) {
+      break;
+    }
+    Offset -= SlotSize;
+  }
+
+  InsertHeadList (&mSlabClass[Index].PartialList, &Slab->Link);
+  mSlabClass[Index].Slabs++;
+
+  return Slab;
+}
+
+/**
+  Internal function to allocate a small pool buffer from the slabs.
+  Caller must have the memory lock held
+
+  @param  PoolType               Type of pool to allocate
+  @param  Size                   The amount of pool to allocate
+
+  @return The allocated buffer, or NULL if the request is not served by slabs
+          or no memory is available.
+
+**/
+VOID *
+CoreAllocateSlabI (
+  IN EFI_MEMORY_TYPE  PoolType,
+  IN UINTN            Size
+  )
+{
+  SLAB_CLASS  *Class;
+  SLAB        *Slab;
+  SLAB_HEAD   *Head;
+  UINTN       Index;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  if (PoolType != EfiBootServicesData) {
+    return NULL;
+  }
+
+  Index = GetSlabIndexFromSize (Size);
+  if (Index >= MAX_SLAB_CLASS) {
+    return NULL;
+  }
+
+  Class = &mSlabClass[Index];
+  if (IsListEmpty (&Class->PartialList)) {
+    Class->Misses++;
+    Slab = CoreRefillSlab (Index);
+    if (Slab == NULL) {
+      return NULL;
+    }
+  } else {
+    Class->Hits++;
+    Slab = CR (Class->PartialList.ForwardLink, SLAB, Link, SLAB_SIGNATURE);
+  }
+
+  Head = Slab->FreeList;
+  ASSERT (Head != NULL);
+  ASSERT (Head->Signature == SLAB_FREE_SIGNATURE);
+  Slab->FreeList = Head->u.Next;
+  Slab->InUse++;
+  if (Slab->FreeList == NULL) {
+    //
+    // The slab is full, stop looking at it until one of its slots is freed
+    //
+    RemoveEntryList (&Slab->Link);
+  }
+
+  Head->Signature = SLAB_HEAD_SIGNATURE;
+  Head->Index     = (UINT32)Index;
+  Head->Type      = PoolType;
+  Head->u.Size    = Size;
+  DEBUG_CLEAR_MEMORY (Head->Data, mSlabSizeTable[Index] - SIZE_OF_SLAB_HEAD);
+
+  Class->InUse++;
+  Class->Requested += Size;
+
+  DEBUG ((DEBUG_POOL, "AllocateSlabI: Addr %p (len %lx) class %d\n", Head->Data, (UINT64)Size, (UINT32)Index));
+
+  return Head->Data;
+}
+
+/**
+  Internal function to free a slab buffer.
+  Caller must have the memory lock held
+
+  @param  Buffer                 The allocated pool entry to free
+  @param  PoolType               Pointer to pool type
+
+  @retval EFI_NOT_FOUND          Buffer was not allocated from a slab.
+  @retval EFI_INVALID_PARAMETER  Buffer not valid
+  @retval EFI_SUCCESS            Buffer successfully freed.
+
+**/
+EFI_STATUS
+CoreFreeSlabI (
+  IN VOID               *Buffer,
+  OUT EFI_MEMORY_TYPE   *PoolType OPTIONAL
+  )
+{
+  SLAB_CLASS  *Class;
+  SLAB        *Slab;
+  SLAB_HEAD   *Head;
+  UINTN       Index;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  Head = BASE_CR (Buffer, SLAB_HEAD, Data);
+  if (Head->Signature != SLAB_HEAD_SIGNATURE) {
+    return EFI_NOT_FOUND;
+  }
+
+  Index = Head->Index;
+  Slab  = HEAD_TO_SLAB (Head);
+  if ((Index >= MAX_SLAB_CLASS) || (Slab->Signature != SLAB_SIGNATURE) || (Slab->Index != Index)) {
+    ASSERT (FALSE);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (PoolType != NULL) {
+    *PoolType = Head->Type;
+  }
+
+  Class = &mSlabClass[Index];
+  Class->InUse--;
+  Class->Requested -= Head->u.Size;
+  DEBUG ((DEBUG_POOL, "FreeSlab: %p (len %lx) class %d\n", Buffer, (UINT64)Head->u.Size, (UINT32)Index));
+
+  DEBUG_CLEAR_MEMORY (Head->Data, mSlabSizeTable[Index] - SIZE_OF_SLAB_HEAD);
+  Head->Signature = SLAB_FREE_SIGNATURE;
+  Head->u.Next    = Slab->FreeList;
+
+  if (Slab->FreeList == NULL) {
+    //
+    // The slab was full, make it available again
+    //
+    InsertHeadList (&Class->PartialList, &Slab->Link);
+  }
+  Slab->FreeList = Head;
+  Slab->InUse--;
+
+  //
+  // Return an empty slab to the page allocator, but keep the last one cached
+  // so that alloc/free pairs do not bounce pages in and out of the memory map
+  //
+  if ((Slab->InUse == 0) &&
+      ((Class->PartialList.ForwardLink != &Slab->Link) || (Class->PartialList.BackLink != &Slab->Link))) {
+    RemoveEntryList (&Slab->Link);
+    Slab->Signature = 0;
+    Class->Slabs--;
+    CoreFreePoolPages ((EFI_PHYSICAL_ADDRESS) (UINTN)Slab, EFI_SIZE_TO_PAGES (SLAB_SIZE));
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Retrieve the small pool allocator statistics.
+
+  @param[out]  Stats         The pointer to receive the statistics.
+
+  @retval     EFI_INVALID_PARAMETER  Stats is NULL.
+              EFI_SUCCESS            Statistics are returned successfully.
+**/
+EFI_STATUS
+EFIAPI
+GetMemoryPoolStats (
+  OUT  MEMORY_POOL_STATS  *Stats
+  )
+{
+  SLAB_CLASS  *Class;
+  LIST_ENTRY  *Link;
+  SLAB        *Slab;
+  UINTN        Index;
+  UINT32       Free;
+
+  if (Stats == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  ZeroMem (Stats, sizeof (MEMORY_POOL_STATS));
+  Stats->SlabSize   = SLAB_SIZE;
+  Stats->ClassCount = (UINT32)MIN (MAX_SLAB_CLASS, MEMORY_POOL_CLASS_MAX);
+  for (Index = 0; Index < Stats->ClassCount; Index++) {
+    Class = &mSlabClass[Index];
+    Free  = 0;
+    for (Link = Class->PartialList.ForwardLink; Link != &Class->PartialList; Link = Link->ForwardLink) {
+      Slab  = CR (Link, SLAB, Link, SLAB_SIGNATURE);
+      Free += Slab->Total - Slab->InUse;
+    }
+    Stats->Class[Index].SlotSize  = mSlabSizeTable[Index];
+    Stats->Class[Index].MaxSize   = mSlabSizeTable[Index] - (UINT32)SIZE_OF_SLAB_HEAD;
+    Stats->Class[Index].Slabs     = Class->Slabs;
+    Stats->Class[Index].InUse     = Class->InUse;
+    Stats->Class[Index].Free      = Free;
+    Stats->Class[Index].Hits      = Class->Hits;
+    Stats->Class[Index].Misses    = Class->Misses;
+    Stats->Class[Index].Requested = Class->Requested;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -163,12 +163,14 @@ DisplayBmpToFrameBuffer (
   BMP_IMAGE_HEADER              *BmpHeader;
   BMP_COLOR_MAP                 *BmpColorMap;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltLineBuf;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Blt;
+  UINT32                        *Pixel;
   BOOLEAN                       IsAllocated;
   UINTN                         Index;
   UINTN                         Height;
   UINTN                         Width;
-  UINTN                         ImageIndex;
+  UINTN                         DataSizePerLine;
+  UINTN                         ColorMapNum;
+  UINT32                        Palette[256];
   UINTN                         PixelHeight;
   UINTN                         PixelWidth;
   UINT32                        OffX;
@@ -178,7 +180,6 @@ DisplayBmpToFrameBuffer (
   UINT32                        FrameBufferOffset;
   UINT32                        *FrameBufferPtr;
   UINT8                         *Image;
-  UINT8                         *ImageHeader;
   EFI_STATUS                    Status;
 
   Status = GetBmpDisplayPos (BmpImage, &OffX, &OffY, GfxInfoHob);
@@ -191,7 +192,31 @@ DisplayBmpToFrameBuffer (
   PixelWidth   = BmpHeader->PixelWidth;
   PixelHeight  = BmpHeader->PixelHeight;
   Image        = ((UINT8 *) BmpImage) + BmpHeader->ImageOffset;
-  ImageHeader  = Image;
+
+  //
+  // Build a 32-bit palette so that each indexed pixel is converted with a single store
+  //
+  switch (BmpHeader->BitPerPixel) {
+  case 1:
+  case 4:
+  case 8:
+    ColorMapNum = MIN ((UINTN)1 << BmpHeader->BitPerPixel,
+                       (BmpHeader->ImageOffset - sizeof (BMP_IMAGE_HEADER)) / sizeof (BMP_COLOR_MAP));
+    break;
+  case 24:
+    ColorMapNum = 0;
+    break;
+  default:
+    //
+    // Other bit format BMP is not supported.
+    //
+    return EFI_UNSUPPORTED;
+  }
+
+  ZeroMem (Palette, sizeof (Palette));
+  for (Index = 0; Index < ColorMapNum; Index++) {
+    Palette[Index] = BmpColorMap[Index].Blue | (BmpColorMap[Index].Green << 8) | (BmpColorMap[Index].Red << 16);
+  }
 
   //
   // Calculate the BltBuffer size needed for one line of splashing at a time.
@@ -225,78 +250,55 @@ DisplayBmpToFrameBuffer (
   // Convert image from BMP to Blt buffer format
   //
   Status = EFI_SUCCESS;
-  for (Height = 0; Height < BmpHeader->PixelHeight; Height++) {
-    Blt = BltLineBuf;
-    for (Width = 0; Width < BmpHeader->PixelWidth; Width++, Image++, Blt++) {
-      switch (BmpHeader->BitPerPixel) {
-      case 1:
-        //
-        // Convert 1-bit (2 colors) BMP to 24-bit color
-        //
-        for (Index = 0; Index < 8 && Width < BmpHeader->PixelWidth; Index++) {
-          Blt->Red    = BmpColorMap[ ((*Image) >> (7 - Index)) & 0x1].Red;
-          Blt->Green  = BmpColorMap[ ((*Image) >> (7 - Index)) & 0x1].Green;
-          Blt->Blue   = BmpColorMap[ ((*Image) >> (7 - Index)) & 0x1].Blue;
-          Blt++;
-          Width++;
-        }
-
-        Blt--;
-        Width--;
-        break;
-
-      case 4:
-        //
-        // Convert 4-bit (16 colors) BMP Palette to 24-bit color
-        //
-        Index       = (*Image) >> 4;
-        Blt->Red    = BmpColorMap[Index].Red;
-        Blt->Green  = BmpColorMap[Index].Green;
-        Blt->Blue   = BmpColorMap[Index].Blue;
-        if (Width < (BmpHeader->PixelWidth - 1)) {
-          Blt++;
-          Width++;
-          Index       = (*Image) & 0x0f;
-          Blt->Red    = BmpColorMap[Index].Red;
-          Blt->Green  = BmpColorMap[Index].Green;
-          Blt->Blue   = BmpColorMap[Index].Blue;
-        }
-        break;
-
-      case 8:
-        //
-        // Convert 8-bit (256 colors) BMP Palette to 24-bit color
-        //
-        Blt->Red    = BmpColorMap[*Image].Red;
-        Blt->Green  = BmpColorMap[*Image].Green;
-        Blt->Blue   = BmpColorMap[*Image].Blue;
-        break;
-
-      case 24:
-        //
-        // It is 24-bit BMP.
-        //
-        Blt->Blue   = *Image++;
-        Blt->Green  = *Image++;
-        Blt->Red    = *Image;
-        break;
-
-      default:
-        //
-        // Other bit format BMP is not supported.
-        //
-        Status = EFI_UNSUPPORTED;
-        goto End;
+  for (Height = 0; Height < PixelHeight; Height++) {
+    Pixel = (UINT32 *)BltLineBuf;
+    switch (BmpHeader->BitPerPixel) {
+    case 1:
+      //
+      // Convert 1-bit (2 colors) BMP to 24-bit color
+      //
+      for (Width = 0; Width < PixelWidth; Width++) {
+        Pixel[Width] = Palette[(Image[Width >> 3] >> (7 - (Width & 0x7))) & 0x1];
       }
-    }
+      DataSizePerLine = (PixelWidth + 7) >> 3;
+      break;
+
+    case 4:
+      //
+      // Convert 4-bit (16 colors) BMP Palette to 24-bit color
+      //
+      for (Width = 0; Width < PixelWidth; Width++) {
+        Pixel[Width] = Palette[(Image[Width >> 1] >> (((Width & 0x1) == 0) ? 4 : 0)) & 0x0F];
+      }
+      DataSizePerLine = (PixelWidth + 1) >> 1;
+      break;
 
-    ImageIndex = (UINTN) (Image - ImageHeader);
-    if ((ImageIndex % 4) != 0) {
+    case 8:
       //
-      // Bmp Image starts each row on a 32-bit boundary!
+      // Convert 8-bit (256 colors) BMP Palette to 24-bit color
       //
-      Image = Image + (4 - (ImageIndex % 4));
+      for (Width = 0; Width < PixelWidth; Width++) {
+        Pixel[Width] = Palette[Image[Width]];
+      }
+      DataSizePerLine = PixelWidth;
+      break;
+
+    default:
+      //
+      // It is 24-bit BMP.
+      //
+      for (Width = 0; Width < PixelWidth; Width++) {
+        Pixel[Width] = Image[Width * 3] | (Image[Width * 3 + 1] << 8) | (Image[Width * 3 + 2] << 16);
+      }
+      DataSizePerLine = PixelWidth * 3;
+      break;
     }
+
+    //
+    // Bmp Image starts each row on a 32-bit boundary!
+    //
+    Image += ALIGN_VALUE (DataSizePerLine, 4);
+
     if (GopBlt == NULL) {
       CopyMem (&FrameBufferPtr[FrameBufferOffset], BltLineBuf, Width * 4);
       FrameBufferOffset -= GfxInfoHob->GraphicsMode.HorizontalResolution;
@@ -305,7 +307,6 @@ DisplayBmpToFrameBuffer (
     }
   }
 
-End:
   if (IsAllocated) {
     FreePool (BltLineBuf);
   }
@@ -87,6 +87,89 @@ BltToFrameBuffer (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the glyph bitmap for an ASCII character.
+
+  @param[in] Glyph               ASCII character
+
+  @retval    Pointer to the glyph bitmap, one byte per glyph row.
+
+**/
+STATIC
+UINT8 *
+GetGlyphBitmap (
+  IN CHAR8                         Glyph
+  )
+{
+  UINTN                            Code;
+  UINTN                            Base;
+
+  // Glyph table maps to ASCII characters, index the table with the character
+  Code = (UINTN)(Glyph & 0xFF);
+  Base = 0xAF;
+  if ((Code >= Base) && (Code <= 0xF2)) {
+    Code = (0x80 - 0x20) + (Code - Base);
+  } else if ((Code >= 0x20) && (Code <= 0x7F)) {
+    Code = Code - 0x20;
+  } else {
+    Code = 0;
+  }
+
+  return gUsStdNarrowGlyphData[Code].GlyphCol1;
+}
+
+/**
+  Render a glyph into a 32-bit pixel surface.
+
+  If the colors match the console colors, each glyph row is expanded from the
+  pre-rendered row pattern table. Otherwise the pixels are expanded one by one.
+
+  @param[in] Glyph               ASCII character to render
+  @param[in] ForegroundColor     Foreground color to use
+  @param[in] BackgroundColor     Background color to use
+  @param[in] Dest                Top left pixel of the glyph in the surface
+  @param[in] Stride              Surface width in pixels
+
+**/
+STATIC
+VOID
+RenderGlyph (
+  IN CHAR8                         Glyph,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL ForegroundColor,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL BackgroundColor,
+  IN UINT32                        *Dest,
+  IN UINTN                         Stride
+  )
+{
+  UINT8                            *GlyphBitmap;
+  UINT32                           *Pattern;
+  UINT32                           Fg;
+  UINT32                           Bg;
+  UINTN                            Row;
+  UINTN                            Col;
+
+  GlyphBitmap = GetGlyphBitmap (Glyph);
+  Fg = *(UINT32 *)&ForegroundColor;
+  Bg = *(UINT32 *)&BackgroundColor;
+
+  if ((mFbConsole.GlyphPattern != NULL) && (Fg == mFbConsole.GlyphPatternFg) && (Bg == mFbConsole.GlyphPatternBg)) {
+    for (Row = 0; Row < GLYPH_HEIGHT; Row++) {
+      Pattern = &mFbConsole.GlyphPattern[GlyphBitmap[Row] * GLYPH_WIDTH];
+      for (Col = 0; Col < GLYPH_WIDTH; Col++) {
+        Dest[Col] = Pattern[Col];
+      }
+      Dest += Stride;
+    }
+  } else {
+    for (Row = 0; Row < GLYPH_HEIGHT; Row++) {
+      for (Col = 0; Col < GLYPH_WIDTH; Col++) {
+        Dest[Col] = ((GlyphBitmap[Row] & (1 << (GLYPH_WIDTH - Col - 1))) != 0) ? Fg : Bg;
+      }
+      Dest += Stride;
+    }
+  }
+}
+
 /**
   Draw a glyph into the frame buffer (ASCII only).
 
@@ -112,42 +195,25 @@ BltGlyphToFrameBuffer (
   IN UINTN                         OffY
   )
 {
-  UINT8                            *GlyphBitmap;
-  UINTN                            Width, Height;
-  UINTN                            Row;
-  UINTN                            Col;
-  UINTN                            Code;
-  UINTN                            Base;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    GopBlt[GLYPH_WIDTH * GLYPH_HEIGHT];
+  UINT32                           *FrameBufferPtr;
+  UINTN                            Stride;
 
   if (GfxInfoHob == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
-  Width = GLYPH_WIDTH;
-  Height = GLYPH_HEIGHT;
-
-  // Glyph table maps to ASCII characters, index the table with the character
-  Code = (UINTN)(Glyph & 0xFF);
-  Base = 0xAF;
-  if ((Code >= Base) && (Code <= 0xF2)) {
-    Code = (0x80 - 0x20) + (Code - Base);
-  } else if ((Code >= 0x20) && (Code <= 0x7F)) {
-    Code = Code - 0x20;
-  } else {
-    Code = 0;
+  // Check dimensions
+  if (((GLYPH_HEIGHT + OffY) > GfxInfoHob->GraphicsMode.VerticalResolution)
+      || ((GLYPH_WIDTH + OffX) > GfxInfoHob->GraphicsMode.HorizontalResolution)) {
+    return EFI_INVALID_PARAMETER;
   }
 
-  // Glyph table maps to ASCII characters, index the table with the character
-  GlyphBitmap = gUsStdNarrowGlyphData[Code].GlyphCol1;
-
-  for (Row = 0; Row < Height; Row++) {
-    for (Col = 0; Col < Width; Col++) {
-      GopBlt[Row * Width + Col] = ((GlyphBitmap[Row] & (1 << (Width - Col - 1))) != 0) ? ForegroundColor : BackgroundColor;
-    }
-  }
+  // Render directly into the frame buffer
+  Stride = GfxInfoHob->GraphicsMode.HorizontalResolution;
+  FrameBufferPtr = (UINT32 *) (UINTN) (GfxInfoHob->FrameBufferBase);
+  RenderGlyph (Glyph, ForegroundColor, BackgroundColor, &FrameBufferPtr[OffY * Stride + OffX], Stride);
 
-  return BltToFrameBuffer (GfxInfoHob, GopBlt, Width, Height, OffX, OffY);
+  return EFI_SUCCESS;
 }
 
 /**
@@ -176,6 +242,8 @@ InitFrameBufferConsole (
 {
   FRAME_BUFFER_CONSOLE  *Console;
   BOOLEAN                ClearScreen;
+  UINT32                 Bits;
+  UINT32                 Col;
 
   Console = &mFbConsole;
   if (Console->GfxInfoHob != NULL) {
@@ -214,6 +282,22 @@ InitFrameBufferConsole (
   Console->TextDrawBuf = AllocateZeroPool (Console->Rows * Console->Cols * 2);
   ASSERT (Console->TextDrawBuf != NULL);
 
+  // Scan line buffer for one text row, used to batch redraws
+  Console->LineBuf = AllocatePool (Console->Cols * GLYPH_WIDTH * GLYPH_HEIGHT * sizeof (UINT32));
+
+  // Pre-render every possible glyph row in the console colors
+  Console->GlyphPatternFg = *(UINT32 *)&Console->ForegroundColor;
+  Console->GlyphPatternBg = *(UINT32 *)&Console->BackgroundColor;
+  Console->GlyphPattern   = AllocatePool (256 * GLYPH_WIDTH * sizeof (UINT32));
+  if (Console->GlyphPattern != NULL) {
+    for (Bits = 0; Bits < 256; Bits++) {
+      for (Col = 0; Col < GLYPH_WIDTH; Col++) {
+        Console->GlyphPattern[Bits * GLYPH_WIDTH + Col] = ((Bits & (1 << (GLYPH_WIDTH - Col - 1))) != 0) ?
+                                                          Console->GlyphPatternFg : Console->GlyphPatternBg;
+      }
+    }
+  }
+
   if (ClearScreen) {
     // Clear screen using standard ANSI Escape Sequences 'ESC[2J'
     FrameBufferWrite (ANSI_ESCAPE_SEQ_CLEAR_SCREEN, 4);
@@ -242,6 +326,9 @@ FrameBufferConsoleScroll (
   UINTN                  BufPos;
   UINTN                  ScreenX;
   UINTN                  ScreenY;
+  UINTN                  SpanStart;
+  UINTN                  SpanEnd;
+  UINTN                  Stride;
 
   Console = &mFbConsole;
   if (Console->Height == 0) {
@@ -266,22 +353,44 @@ FrameBufferConsoleScroll (
   // Write text buffer to screen
   //
   // Note: At this point, TextDisplayBuf contains what is currently being
-  // displayed and TextSwapBuf contains what *should* be displayed. Step through
-  // every character of the buffer and update the framebuffer with any
-  // differences.
-  BufPos = 0;
+  // displayed and TextSwapBuf contains what *should* be displayed. For each
+  // text row, only the span between the first and the last changed character
+  // is rendered. If a scan line buffer is available, the span is rendered into
+  // it and copied to the frame buffer one scan line at a time, so that the
+  // frame buffer only sees long sequential writes and is never read back.
   ScreenY = Console->OffY;
   for (BufY = 0; BufY < Console->Rows; BufY++) {
-    ScreenX = Console->OffX;
-    for (BufX = 0; BufX < Console->Cols; BufX++) {
-      if (Console->TextSwapBuf[BufPos] != Console->TextDisplayBuf[BufPos]) {
-        Console->TextDisplayBuf[BufPos] = Console->TextSwapBuf[BufPos];
-        BltGlyphToFrameBuffer (Console->GfxInfoHob, Console->TextSwapBuf[BufPos],
-                               Console->ForegroundColor, Console->BackgroundColor,
-                               ScreenX, ScreenY);
+    BufPos = BufY * Console->Cols;
+    for (SpanStart = 0; SpanStart < Console->Cols; SpanStart++) {
+      if (Console->TextSwapBuf[BufPos + SpanStart] != Console->TextDisplayBuf[BufPos + SpanStart]) {
+        break;
+      }
+    }
+    if (SpanStart < Console->Cols) {
+      for (SpanEnd = Console->Cols; SpanEnd > SpanStart + 1; SpanEnd--) {
+        if (Console->TextSwapBuf[BufPos + SpanEnd - 1] != Console->TextDisplayBuf[BufPos + SpanEnd - 1]) {
+          break;
+        }
+      }
+      CopyMem (&Console->TextDisplayBuf[BufPos + SpanStart], &Console->TextSwapBuf[BufPos + SpanStart],
+               SpanEnd - SpanStart);
+
+      ScreenX = Console->OffX + SpanStart * GLYPH_WIDTH;
+      if (Console->LineBuf != NULL) {
+        Stride = (SpanEnd - SpanStart) * GLYPH_WIDTH;
+        for (BufX = SpanStart; BufX < SpanEnd; BufX++) {
+          RenderGlyph (Console->TextSwapBuf[BufPos + BufX], Console->ForegroundColor, Console->BackgroundColor,
+                       &Console->LineBuf[(BufX - SpanStart) * GLYPH_WIDTH], Stride);
+        }
+        BltToFrameBuffer (Console->GfxInfoHob, Console->LineBuf, Stride, GLYPH_HEIGHT, ScreenX, ScreenY);
+      } else {
+        for (BufX = SpanStart; BufX < SpanEnd; BufX++) {
+          BltGlyphToFrameBuffer (Console->GfxInfoHob, Console->TextSwapBuf[BufPos + BufX],
+                                 Console->ForegroundColor, Console->BackgroundColor,
+                                 ScreenX, ScreenY);
+          ScreenX += GLYPH_WIDTH;
+        }
       }
-      BufPos++;
-      ScreenX += GLYPH_WIDTH;
     }
     ScreenY += GLYPH_HEIGHT;
   }
@@ -13,6 +13,24 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/BootloaderCommonLib.h>
 
+//
+// Direct-mapped cache of GUID HOB lookups that start from the head of the HOB list.
+//
+// There is no HOB list before FSP-M has run, so the cache is never touched while
+// executing in place from flash. A HOB list is only ever appended to, so the first
+// instance of a GUID HOB never moves once found; a different list head (new stage,
+// relocated list) simply drops all the entries.
+//
+#define GUID_HOB_CACHE_SIZE   16
+
+typedef struct {
+  EFI_GUID      Guid;
+  VOID          *Hob;
+} GUID_HOB_CACHE_ENTRY;
+
+STATIC VOID                  *mGuidHobCacheList;
+STATIC GUID_HOB_CACHE_ENTRY  mGuidHobCache[GUID_HOB_CACHE_SIZE];
+
 /**
   Returns the pointer to the HOB list.
 
@@ -126,6 +144,19 @@ GetNextGuidHob (
   )
 {
   EFI_PEI_HOB_POINTERS  GuidHob;
+  GUID_HOB_CACHE_ENTRY  *Entry;
+
+  Entry = NULL;
+  if (HobStart == GetHobList ()) {
+    if (mGuidHobCacheList != HobStart) {
+      ZeroMem (mGuidHobCache, sizeof (mGuidHobCache));
+      mGuidHobCacheList = (VOID *) HobStart;
+    }
+    Entry = &mGuidHobCache[ReadUnaligned32 ((UINT32 *) Guid) % GUID_HOB_CACHE_SIZE];
+    if ((Entry->Hob != NULL) && CompareGuid (Guid, &Entry->Guid)) {
+      return Entry->Hob;
+    }
+  }
 
   GuidHob.Raw = (UINT8 *) HobStart;
   while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
@@ -134,6 +165,15 @@ GetNextGuidHob (
     }
     GuidHob.Raw = GET_NEXT_HOB (GuidHob);
   }
+
+  //
+  // Only hits are remembered, a GUID HOB that is missing now may be built later.
+  //
+  if ((Entry != NULL) && (GuidHob.Raw != NULL)) {
+    CopyGuid (&Entry->Guid, Guid);
+    Entry->Hob = GuidHob.Raw;
+  }
+
   return GuidHob.Raw;
 }
 
@@ -66,6 +66,14 @@ IsIasImageValid (
     return NULL;
   }
 
+  //
+  // Describe the signed region up front so a measured boot consumer can hash it
+  // itself when no verified digest is available.
+  //
+  IasImageInfo->CompBuf  = (UINT8 *)Hdr;
+  IasImageInfo->CompLen  = ((UINT32)IAS_PAYLOAD_END (Hdr)) - ((UINT32)(UINTN)Hdr);
+  IasImageInfo->HashAlg  = HASH_TYPE_NONE;
+
   if (!FeaturePcdGet (PcdVerifiedBootEnabled)) {
     DEBUG ((DEBUG_INFO, "IAS image verification is skipped!\n"));
     return Hdr;
@@ -103,7 +111,7 @@ IsIasImageValid (
     Key->PubExp[Index]  = ((UINT8 *) IAS_PUBLIC_KEY (Hdr))[KeyIdx];
   }
 
-  Status = DoRsaVerify ((CONST UINT8 *)Hdr, ((UINT32)IAS_PAYLOAD_END (Hdr)) - ((UINT32)(UINTN)Hdr),
+  Status = DoRsaVerify ((CONST UINT8 *)Hdr, IasImageInfo->CompLen,
                          HASH_USAGE_PUBKEY_OS, SignHdr, PubKeyHdr, PcdGet8(PcdCompSignHashAlg), NULL, IasImageInfo->HashData);
   if (EFI_ERROR (Status) != EFI_SUCCESS) {
     DEBUG ((DEBUG_ERROR, "IAS image verification failed!\n"));
@@ -111,10 +119,13 @@ IsIasImageValid (
   }
   DEBUG ((DEBUG_INFO, "IAS image is properly signed/verified\n"));
 
-  // populate IAS_IMAGE_INFO
-  IasImageInfo->CompBuf  = (UINT8 *)Hdr;
-  IasImageInfo->CompLen  = ((UINT32)IAS_PAYLOAD_END (Hdr)) - ((UINT32)(UINTN)Hdr);
-  IasImageInfo->HashAlg  = PcdGet8(PcdCompSignHashAlg);
+  //
+  // HashData now holds the digest computed over the image by the signature check.
+  // Report the algorithm that digest was actually taken with (the IAS signature
+  // scheme, not PcdCompSignHashAlg which only selects the public key hash), so the
+  // measured boot path can reuse it instead of hashing the whole image again.
+  //
+  IasImageInfo->HashAlg  = SignHdr->HashAlg;
 
   return Hdr;
 }
@@ -321,10 +321,186 @@ InitializeVariableStore (
   return EFI_SUCCESS;
 }
 
+/**
+
+  This function calculates the lookup index hash of a variable name.
+
+  @param    VariableName      Variable name
+
+  @retval   FNV-1a hash of the variable name.
+
+**/
+STATIC
+UINT32
+GetVariableNameHash (
+  IN CONST CHAR8           *VariableName
+  )
+{
+  UINT32                  Hash;
+
+  Hash = 0x811C9DC5;
+  while (*VariableName != 0) {
+    Hash = (Hash ^ (UINT8)*VariableName++) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+/**
+
+  This function finds the lookup index entry of a variable.
+
+  @param    VarInstance       Variable instance
+  @param    VarStoreHdrPtr    Active variable store header pointer
+  @param    VariableName      Variable name
+  @param    Hash              Hash of the variable name
+
+  @retval   Index entry pointer, or NULL if the variable is not indexed.
+
+**/
+STATIC
+VARIABLE_INDEX_ENTRY *
+FindVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr,
+  IN CONST CHAR8            *VariableName,
+  IN UINT32                  Hash
+  )
+{
+  UINT32                  Idx;
+  VARIABLE_HEADER        *VarHdrPtr;
+
+  for (Idx = 0; Idx < VarInstance->IndexCount; Idx++) {
+    if (VarInstance->Index[Idx].Hash == Hash) {
+      VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)VarStoreHdrPtr + VarInstance->Index[Idx].Offset);
+      if (AsciiStrCmp ((VOID *)&VarHdrPtr[1], VariableName) == 0) {
+        return &VarInstance->Index[Idx];
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/**
+
+  This function updates the lookup index entry of a variable.
+
+  @param    VarInstance       Variable instance
+  @param    VarStoreHdrPtr    Active variable store header pointer
+  @param    VariableName      Variable name
+  @param    VarHdrPtr         Current variable header, or NULL if the variable was deleted
+
+**/
+STATIC
+VOID
+UpdateVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr,
+  IN CONST CHAR8            *VariableName,
+  IN VARIABLE_HEADER        *VarHdrPtr  OPTIONAL
+  )
+{
+  VARIABLE_INDEX_ENTRY   *Entry;
+  UINT32                  Hash;
+
+  Hash  = GetVariableNameHash (VariableName);
+  Entry = FindVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, Hash);
+  if (VarHdrPtr == NULL) {
+    if (Entry != NULL) {
+      VarInstance->IndexCount--;
+      CopyMem (Entry, &VarInstance->Index[VarInstance->IndexCount], sizeof (VARIABLE_INDEX_ENTRY));
+    }
+  } else {
+    if ((Entry == NULL) && (VarInstance->IndexCount < VARIABLE_INDEX_ENTRIES)) {
+      Entry = &VarInstance->Index[VarInstance->IndexCount++];
+      Entry->Hash = Hash;
+    }
+    if (Entry != NULL) {
+      Entry->Offset = (UINT32)((UINT8 *)VarHdrPtr - (UINT8 *)VarStoreHdrPtr);
+    } else {
+      VarInstance->IndexFull = TRUE;
+    }
+  }
+
+  VarInstance->IndexBase = (UINT32)(UINTN)VarStoreHdrPtr;
+}
+
+/**
+
+  This function builds the lookup index of the active variable store in a single pass.
+
+  When a variable name appears more than once, the index follows the same rule as
+  the store scan: the first copy not in migration wins, otherwise the last copy.
+
+  @param    VarInstance       Variable instance
+  @param    VarStoreHdrPtr    Active variable store header pointer
+
+  @retval   EFI_SUCCESS           The index was built.
+  @retval   EFI_VOLUME_CORRUPTED  Variable store is corrupted.
+
+**/
+STATIC
+EFI_STATUS
+BuildVariableIndex (
+  IN VARIABLE_INSTANCE      *VarInstance,
+  IN VARIABLE_STORE_HEADER  *VarStoreHdrPtr
+  )
+{
+  VARIABLE_HEADER        *VarHdrPtr;
+  VARIABLE_HEADER        *IdxHdrPtr;
+  VARIABLE_INDEX_ENTRY   *Entry;
+  UINT8                  *VarEndPtr;
+  UINT8                   State;
+  UINT32                  Hash;
+
+  VarInstance->IndexBase  = 0;
+  VarInstance->IndexCount = 0;
+  VarInstance->IndexFull  = FALSE;
+
+  VarHdrPtr = (VARIABLE_HEADER *)&VarStoreHdrPtr[1];
+  VarEndPtr = (UINT8 *)VarStoreHdrPtr + VarStoreHdrPtr->Size;
+  while ((UINT8 *)VarHdrPtr < VarEndPtr) {
+    State = VarHdrPtr->State;
+    if (!IS_HEADER_VALID (State)) {
+      break;
+    }
+
+    if (VarHdrPtr->StartId != VARIABLE_DATA) {
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if (IS_DATA_VALID (State) && !IS_DELETED (State)) {
+      Hash  = GetVariableNameHash ((CONST CHAR8 *)&VarHdrPtr[1]);
+      Entry = FindVariableIndex (VarInstance, VarStoreHdrPtr, (CONST CHAR8 *)&VarHdrPtr[1], Hash);
+      if (Entry != NULL) {
+        IdxHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)VarStoreHdrPtr + Entry->Offset);
+        if (IS_IN_MIGRATION (IdxHdrPtr->State)) {
+          Entry->Offset = (UINT32)((UINT8 *)VarHdrPtr - (UINT8 *)VarStoreHdrPtr);
+        }
+      } else if (VarInstance->IndexCount < VARIABLE_INDEX_ENTRIES) {
+        Entry = &VarInstance->Index[VarInstance->IndexCount++];
+        Entry->Hash   = Hash;
+        Entry->Offset = (UINT32)((UINT8 *)VarHdrPtr - (UINT8 *)VarStoreHdrPtr);
+      } else {
+        VarInstance->IndexFull = TRUE;
+      }
+    }
+
+    VarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)&VarHdrPtr[1] + VarHdrPtr->DataSize);
+  }
+
+  VarInstance->IndexBase = (UINT32)(UINTN)VarStoreHdrPtr;
+  return EFI_SUCCESS;
+}
+
 /**
 
   This internal function finds variable in storage blocks.
 
+  The RAM lookup index is consulted first. The store is only scanned when the
+  index cannot give a definite answer.
+
   Caution: This function may receive untrusted input.
   This function will do basic validation, before parse the data.
 
@@ -363,6 +539,9 @@ InternalGetVariable (
   UINT32                  VariableNameLen;
   UINT32                  VariableDataLen;
   UINTN                   DataSizeIn;
+  VARIABLE_INSTANCE      *VarInstance;
+  VARIABLE_INDEX_ENTRY   *Entry;
+  BOOLEAN                 ScanStore;
 
   if ((DataSize == NULL) || (VariableName == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -378,7 +557,34 @@ InternalGetVariable (
   VarEndPtr = (UINT8 *)VarStoreHdrPtr + VarStoreHdrPtr->Size;
 
   FindVarHdrPtr = NULL;
-  while ((UINT8 *)VarHdrPtr < VarEndPtr) {
+  ScanStore     = TRUE;
+  VarInstance   = GetVariableInstance ();
+  if (VarInstance != NULL) {
+    if (VarInstance->IndexBase != (UINT32)(UINTN)VarStoreHdrPtr) {
+      if (EFI_ERROR (BuildVariableIndex (VarInstance, VarStoreHdrPtr))) {
+        return EFI_VOLUME_CORRUPTED;
+      }
+    }
+
+    Entry = FindVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, GetVariableNameHash (VariableName));
+    if (Entry != NULL) {
+      //
+      // Only trust an entry that still points to a live copy not in migration
+      //
+      FindVarHdrPtr = (VARIABLE_HEADER *) ((UINT8 *)VarStoreHdrPtr + Entry->Offset);
+      State = FindVarHdrPtr->State;
+      if (!IS_HEADER_VALID (State) || !IS_DATA_VALID (State) || IS_DELETED (State) || IS_IN_MIGRATION (State)) {
+        FindVarHdrPtr = NULL;
+        VarInstance->IndexBase = 0;
+      } else {
+        ScanStore = FALSE;
+      }
+    } else if (!VarInstance->IndexFull) {
+      return EFI_NOT_FOUND;
+    }
+  }
+
+  while (ScanStore && ((UINT8 *)VarHdrPtr < VarEndPtr)) {
     State = VarHdrPtr->State;
     if (!IS_HEADER_VALID (State)) {
       break;
@@ -735,6 +941,8 @@ SetVariable (
   BOOLEAN                 SkipVarWrite;
   BOOLEAN                 CheckVarDataValid;
   BOOLEAN                 NeedReclaim;
+  BOOLEAN                 IndexValid;
+  VARIABLE_INSTANCE      *VarInstance;
 
   if (VariableName == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -766,6 +974,17 @@ SetVariable (
     return EFI_INVALID_PARAMETER;
   }
 
+  //
+  // Keep the lookup index invalid while the store is being modified so that
+  // a failed write leaves it to be rebuilt from flash on the next lookup.
+  //
+  IndexValid  = FALSE;
+  VarInstance = GetVariableInstance ();
+  if (VarInstance != NULL) {
+    IndexValid = (BOOLEAN)(VarInstance->IndexBase == (UINT32)(UINTN)VarStoreHdrPtr);
+    VarInstance->IndexBase = 0;
+  }
+
   NeedReclaim   = FALSE;
   SkipVarWrite  = FALSE;
   FoundSpace    = FALSE;
@@ -881,6 +1100,9 @@ SetVariable (
   }
 
   if (SkipVarWrite) {
+    if (IndexValid) {
+      UpdateVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, FindVarHdrPtr);
+    }
     return EFI_SUCCESS;
   }
 
@@ -967,10 +1189,14 @@ SetVariable (
     if (EFI_ERROR (Status)) {
       return Status;
     }
-  } else {
-    if (DataSize == 0) {
-      return EFI_NOT_FOUND;
-    }
+  }
+
+  if (IndexValid) {
+    UpdateVariableIndex (VarInstance, VarStoreHdrPtr, VariableName, (DataSize > 0) ? VarHdrPtr : NULL);
+  }
+
+  if ((FindVarHdrPtr == NULL) && (DataSize == 0)) {
+    return EFI_NOT_FOUND;
   }
 
   return EFI_SUCCESS;
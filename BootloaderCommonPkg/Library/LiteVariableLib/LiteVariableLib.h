@@ -26,10 +26,27 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 ///
 #define VARIABLE_INSTANCE_SIGNATURE  SIGNATURE_32 ('V', 'A', 'R', 'I')
 
+///
+/// Number of variables tracked by the RAM lookup index
+///
+#define VARIABLE_INDEX_ENTRIES       64
+
+typedef struct {
+  UINT32                Hash;
+  UINT32                Offset;
+} VARIABLE_INDEX_ENTRY;
+
 typedef struct {
   UINT32                Signature;
   UINT32                StoreSize;
   UINT32                StoreBase;
+  ///
+  /// Active store header the index was built for, 0 if the index is invalid
+  ///
+  UINT32                IndexBase;
+  UINT32                IndexCount;
+  BOOLEAN               IndexFull;
+  VARIABLE_INDEX_ENTRY  Index[VARIABLE_INDEX_ENTRIES];
 } VARIABLE_INSTANCE;
 
 #endif
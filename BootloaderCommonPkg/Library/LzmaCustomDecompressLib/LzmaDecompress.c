@@ -10,6 +10,7 @@
 #include "Sdk/C/Types.h"
 #include "Sdk/C/7zVersion.h"
 #include "Sdk/C/LzmaDec.h"
+#include "Sdk/C/Bra.h"
 
 #define SCRATCH_BUFFER_REQUEST_SIZE SIZE_64KB
 
@@ -212,3 +213,46 @@ LzmaUefiDecompress (
   }
 }
 
+/**
+  Decompresses a Lzma compressed source buffer whose data went through the
+  x86 BCJ filter before compression, and reverses the filter.
+
+  @param  Source      The source buffer containing the compressed data.
+  @param  SourceSize  The size of source buffer.
+  @param  Destination The destination buffer to store the decompressed data
+  @param  Scratch     A temporary scratch buffer that is used to perform the decompression.
+                      This is an optional parameter that may be NULL if the
+                      required scratch buffer size is 0.
+
+  @retval  RETURN_SUCCESS Decompression completed successfully, and
+                          the uncompressed buffer is returned in Destination.
+  @retval  RETURN_INVALID_PARAMETER
+                          The source buffer specified by Source is corrupted
+                          (not in a valid compressed format).
+**/
+RETURN_STATUS
+EFIAPI
+LzmaF86UefiDecompress (
+  IN CONST VOID  *Source,
+  IN UINTN       SourceSize,
+  IN OUT VOID    *Destination,
+  IN OUT VOID    *Scratch
+  )
+{
+  RETURN_STATUS     Status;
+  UInt32            X86State;
+
+  Status = LzmaUefiDecompress (Source, SourceSize, Destination, Scratch);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The host tool filters the whole image at IP 0 before compression
+  //
+  x86_Convert_Init (X86State);
+  x86_Convert ((Byte *)Destination, (SizeT)GetDecodedSizeOfBuf ((UINT8 *)Source), 0, &X86State, 0);
+
+  return RETURN_SUCCESS;
+}
+
@@ -8,6 +8,8 @@
 
 #include <Library/MediaAccessLib.h>
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
 #include <Library/PcdLib.h>
 #include <Library/UfsBlockIoLib.h>
@@ -19,9 +21,380 @@
 #include <Library/MemoryDeviceBlockIoLib.h>
 #include <Library/MmcTuningLib.h>
 
+//
+// Small reads are served from cache lines of this size. Reads of at least
+// one full line go straight to the device.
+//
+#define MEDIA_CACHE_LINE_SIZE         SIZE_16KB
+
+//
+// Maximum number of lines fetched by one device read on sequential access
+//
+#define MEDIA_CACHE_MAX_READ_AHEAD    8
+
+typedef struct {
+  UINTN                 DeviceIndex;
+  EFI_LBA               Lba;
+  UINT32                Blocks;
+  BOOLEAN               Valid;
+  UINT64                LastUse;
+  UINT8                *Buffer;
+} MEDIA_CACHE_LINE;
+
+typedef struct {
+  DEVICE_BLOCK_INFO     BlockInfo;
+  BOOLEAN               BlockInfoValid;
+  BOOLEAN               Uncached;
+  EFI_LBA               NextLba;
+  UINT32                ReadAhead;
+  MEDIA_CACHE_STATS     Stats;
+} MEDIA_CACHE_DEVICE;
+
 OS_BOOT_MEDIUM_TYPE   mCurrentMediaType = OsBootDeviceMax;
 DEVICE_BLOCK_FUNC     mDeviceBlockFuncs[OsBootDeviceMax];
 
+STATIC MEDIA_CACHE_LINE    *mCacheLines;
+STATIC UINT32               mCacheLineCount;
+STATIC UINT8               *mCacheReadAheadBuffer;
+STATIC UINT64               mCacheTick;
+STATIC MEDIA_CACHE_DEVICE   mCacheDevices[MEDIA_CACHE_MAX_DEVICES];
+
+/**
+  Allocate the media block cache on first use.
+
+  @retval TRUE     The block cache is available.
+  @retval FALSE    The block cache is disabled or could not be allocated.
+
+**/
+STATIC
+BOOLEAN
+MediaCacheInit (
+  VOID
+  )
+{
+  UINT8      *Buffer;
+  UINT32      LineCount;
+  UINT32      Index;
+
+  if (mCacheLines != NULL) {
+    return TRUE;
+  }
+
+  LineCount = FixedPcdGet32 (PcdMediaBlockCacheSize) / MEDIA_CACHE_LINE_SIZE;
+  if (LineCount < MEDIA_CACHE_MAX_READ_AHEAD) {
+    return FALSE;
+  }
+
+  Buffer = (UINT8 *)AllocatePages (EFI_SIZE_TO_PAGES ((LineCount + MEDIA_CACHE_MAX_READ_AHEAD) * MEDIA_CACHE_LINE_SIZE));
+  mCacheLines = (MEDIA_CACHE_LINE *)AllocateZeroPool (LineCount * sizeof (MEDIA_CACHE_LINE));
+  if ((Buffer == NULL) || (mCacheLines == NULL)) {
+    if (Buffer != NULL) {
+      FreePages (Buffer, EFI_SIZE_TO_PAGES ((LineCount + MEDIA_CACHE_MAX_READ_AHEAD) * MEDIA_CACHE_LINE_SIZE));
+    }
+    if (mCacheLines != NULL) {
+      FreePool (mCacheLines);
+      mCacheLines = NULL;
+    }
+    return FALSE;
+  }
+
+  for (Index = 0; Index < LineCount; Index++) {
+    mCacheLines[Index].Buffer = Buffer + Index * MEDIA_CACHE_LINE_SIZE;
+  }
+  mCacheReadAheadBuffer = Buffer + LineCount * MEDIA_CACHE_LINE_SIZE;
+  mCacheLineCount       = LineCount;
+
+  return TRUE;
+}
+
+/**
+  Invalidate cached blocks.
+
+  @param[in]  DeviceIndex   Device whose lines are dropped, or MAX_UINTN for all devices.
+  @param[in]  StartLBA      First block of the range to drop.
+  @param[in]  NumBlocks     Number of blocks in the range, or MAX_UINT64 up to the end.
+
+**/
+STATIC
+VOID
+MediaCacheInvalidate (
+  IN  UINTN                DeviceIndex,
+  IN  EFI_LBA              StartLBA,
+  IN  UINT64               NumBlocks
+  )
+{
+  MEDIA_CACHE_LINE  *Line;
+  UINT32             Index;
+
+  for (Index = 0; Index < mCacheLineCount; Index++) {
+    Line = &mCacheLines[Index];
+    if (!Line->Valid) {
+      continue;
+    }
+    if ((DeviceIndex != MAX_UINTN) && (Line->DeviceIndex != DeviceIndex)) {
+      continue;
+    }
+    if ((Line->Lba + Line->Blocks <= StartLBA) ||
+        ((NumBlocks != MAX_UINT64) && (Line->Lba >= StartLBA + NumBlocks))) {
+      continue;
+    }
+    Line->Valid = FALSE;
+  }
+
+  if (DeviceIndex == MAX_UINTN) {
+    for (Index = 0; Index < MEDIA_CACHE_MAX_DEVICES; Index++) {
+      mCacheDevices[Index].BlockInfoValid = FALSE;
+      mCacheDevices[Index].NextLba        = 0;
+      mCacheDevices[Index].ReadAhead      = 1;
+    }
+  }
+}
+
+/**
+  Find the cache line holding a block range, or the least recently used line.
+
+  @param[in]  DeviceIndex   Device the line belongs to.
+  @param[in]  LineLba       First block of the line.
+  @param[out] Line          Pointer to receive the matching or victim line.
+
+  @retval TRUE     The returned line holds the requested range.
+  @retval FALSE    The returned line is the eviction victim.
+
+**/
+STATIC
+BOOLEAN
+MediaCacheLookup (
+  IN  UINTN                DeviceIndex,
+  IN  EFI_LBA              LineLba,
+  OUT MEDIA_CACHE_LINE   **Line
+  )
+{
+  MEDIA_CACHE_LINE  *Victim;
+  UINT32             Index;
+
+  Victim = &mCacheLines[0];
+  for (Index = 0; Index < mCacheLineCount; Index++) {
+    if (mCacheLines[Index].Valid) {
+      if ((mCacheLines[Index].DeviceIndex == DeviceIndex) && (mCacheLines[Index].Lba == LineLba)) {
+        *Line = &mCacheLines[Index];
+        return TRUE;
+      }
+      if (Victim->Valid && (mCacheLines[Index].LastUse < Victim->LastUse)) {
+        Victim = &mCacheLines[Index];
+      }
+    } else if (Victim->Valid) {
+      Victim = &mCacheLines[Index];
+    }
+  }
+
+  *Line = Victim;
+  return FALSE;
+}
+
+/**
+  Read one or more cache lines from the device in a single command.
+
+  On sequential access the read-ahead window lets a miss pull in the following
+  lines too, stopping at the device end or at the first line already cached.
+
+  @param[in]  DeviceIndex   Device to read from.
+  @param[in]  CacheDev      Cache state of the device.
+  @param[in]  LineLba       First block of the missing line.
+  @param[out] Line          Pointer to receive the line holding LineLba.
+
+  @retval EFI_SUCCESS       The line was filled.
+  @retval Others            The device read failed.
+
+**/
+STATIC
+EFI_STATUS
+MediaCacheFill (
+  IN  UINTN                DeviceIndex,
+  IN  MEDIA_CACHE_DEVICE  *CacheDev,
+  IN  EFI_LBA              LineLba,
+  OUT MEDIA_CACHE_LINE   **Line
+  )
+{
+  MEDIA_CACHE_LINE  *Victim;
+  EFI_STATUS         Status;
+  EFI_LBA            Lba;
+  UINT8             *Buffer;
+  UINT32             BlocksPerLine;
+  UINT32             LineBlocks;
+  UINT32             Count;
+  UINT32             Index;
+  UINT64             TotalBlocks;
+
+  BlocksPerLine = MEDIA_CACHE_LINE_SIZE / CacheDev->BlockInfo.BlockSize;
+  TotalBlocks   = 0;
+  for (Count = 0; Count < CacheDev->ReadAhead; Count++) {
+    Lba = LineLba + TotalBlocks;
+    if (Lba >= CacheDev->BlockInfo.BlockNum) {
+      break;
+    }
+    if ((Count > 0) && MediaCacheLookup (DeviceIndex, Lba, &Victim)) {
+      break;
+    }
+    TotalBlocks += MIN (BlocksPerLine, CacheDev->BlockInfo.BlockNum - Lba);
+  }
+
+  Buffer = (Count > 1) ? mCacheReadAheadBuffer : NULL;
+  if (Buffer == NULL) {
+    MediaCacheLookup (DeviceIndex, LineLba, &Victim);
+    Victim->Valid = FALSE;
+    Buffer = Victim->Buffer;
+  }
+
+  CacheDev->Stats.DeviceReads++;
+  CacheDev->Stats.DeviceBytes += MultU64x32 (TotalBlocks, CacheDev->BlockInfo.BlockSize);
+  Status = mDeviceBlockFuncs[mCurrentMediaType].ReadBlocks (DeviceIndex, LineLba,
+             (UINTN)MultU64x32 (TotalBlocks, CacheDev->BlockInfo.BlockSize), Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Lba = LineLba;
+  for (Index = 0; Index < Count; Index++) {
+    LineBlocks = (UINT32)MIN (BlocksPerLine, LineLba + TotalBlocks - Lba);
+    if (Count > 1) {
+      MediaCacheLookup (DeviceIndex, Lba, &Victim);
+      CopyMem (Victim->Buffer, Buffer + Index * MEDIA_CACHE_LINE_SIZE, LineBlocks * CacheDev->BlockInfo.BlockSize);
+    }
+    Victim->DeviceIndex = DeviceIndex;
+    Victim->Lba         = Lba;
+    Victim->Blocks      = LineBlocks;
+    Victim->Valid       = TRUE;
+    Victim->LastUse     = ++mCacheTick;
+    if (Index == 0) {
+      *Line = Victim;
+    }
+    Lba += LineBlocks;
+  }
+
+  //
+  // Keep the requested line most recent so read-ahead lines are evicted first
+  //
+  (*Line)->LastUse = ++mCacheTick;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads blocks through the media block cache.
+
+  @param[in]  DeviceIndex   Specifies the block device to read from.
+  @param[in]  StartLBA      The starting logical block address to read from.
+  @param[in]  BufferSize    The size of the Buffer in bytes.
+  @param[out] Buffer        A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS       The data was read correctly.
+  @retval EFI_UNSUPPORTED   The request cannot be cached, read it from the device.
+  @retval Others            The device read failed.
+
+**/
+STATIC
+EFI_STATUS
+MediaCacheReadBlocks (
+  IN  UINTN                DeviceIndex,
+  IN  EFI_LBA              StartLBA,
+  IN  UINTN                BufferSize,
+  OUT VOID                *Buffer
+  )
+{
+  MEDIA_CACHE_DEVICE  *CacheDev;
+  MEDIA_CACHE_LINE    *Line;
+  EFI_STATUS           Status;
+  EFI_LBA              Lba;
+  EFI_LBA              LineLba;
+  UINT64               NumBlocks;
+  UINT32               BlockSize;
+  UINT32               BlocksPerLine;
+  UINTN                Offset;
+  UINTN                Length;
+  BOOLEAN              Hit;
+
+  if ((mCurrentMediaType == OsBootDeviceMemory) || (DeviceIndex >= MEDIA_CACHE_MAX_DEVICES) || !MediaCacheInit ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  CacheDev = &mCacheDevices[DeviceIndex];
+  if (CacheDev->Uncached) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (!CacheDev->BlockInfoValid) {
+    if ((mDeviceBlockFuncs[mCurrentMediaType].GetInfo == NULL) ||
+        EFI_ERROR (mDeviceBlockFuncs[mCurrentMediaType].GetInfo (DeviceIndex, &CacheDev->BlockInfo))) {
+      return EFI_UNSUPPORTED;
+    }
+    CacheDev->BlockInfoValid = TRUE;
+    CacheDev->ReadAhead      = 1;
+  }
+
+  BlockSize = CacheDev->BlockInfo.BlockSize;
+  if ((BlockSize == 0) || (BlockSize > MEDIA_CACHE_LINE_SIZE) || ((MEDIA_CACHE_LINE_SIZE % BlockSize) != 0) ||
+      ((BufferSize % BlockSize) != 0) || (BufferSize == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  NumBlocks = BufferSize / BlockSize;
+  if ((StartLBA >= CacheDev->BlockInfo.BlockNum) || (NumBlocks > CacheDev->BlockInfo.BlockNum - StartLBA)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  CacheDev->Stats.Requests++;
+  CacheDev->Stats.RequestBytes += BufferSize;
+
+  //
+  // Grow the read-ahead window while the access pattern stays sequential
+  //
+  if (StartLBA == CacheDev->NextLba) {
+    CacheDev->ReadAhead = MIN (CacheDev->ReadAhead * 2, MEDIA_CACHE_MAX_READ_AHEAD);
+  } else {
+    CacheDev->ReadAhead = 1;
+  }
+  CacheDev->NextLba = StartLBA + NumBlocks;
+
+  if (BufferSize >= MEDIA_CACHE_LINE_SIZE) {
+    CacheDev->Stats.Bypassed++;
+    CacheDev->Stats.DeviceReads++;
+    CacheDev->Stats.DeviceBytes += BufferSize;
+    return mDeviceBlockFuncs[mCurrentMediaType].ReadBlocks (DeviceIndex, StartLBA, BufferSize, Buffer);
+  }
+
+  BlocksPerLine = MEDIA_CACHE_LINE_SIZE / BlockSize;
+  Hit = TRUE;
+  Lba = StartLBA;
+  while (BufferSize > 0) {
+    LineLba = Lba - ModU64x32 (Lba, BlocksPerLine);
+    if (!MediaCacheLookup (DeviceIndex, LineLba, &Line)) {
+      Hit    = FALSE;
+      Status = MediaCacheFill (DeviceIndex, CacheDev, LineLba, &Line);
+      if (EFI_ERROR (Status)) {
+        CacheDev->ReadAhead = 1;
+        return Status;
+      }
+    } else {
+      Line->LastUse = ++mCacheTick;
+    }
+
+    Offset = (UINTN)(Lba - LineLba) * BlockSize;
+    Length = MIN (BufferSize, (UINTN)Line->Blocks * BlockSize - Offset);
+    CopyMem (Buffer, Line->Buffer + Offset, Length);
+    Buffer      = (UINT8 *)Buffer + Length;
+    BufferSize -= Length;
+    Lba        += Length / BlockSize;
+  }
+
+  if (Hit) {
+    CacheDev->Stats.Hits++;
+  } else {
+    CacheDev->Stats.Misses++;
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Get current media interface type.
 
@@ -138,6 +511,11 @@ MediaSetInterfaceType (
     return EFI_UNSUPPORTED;
   }
 
+  if (mCurrentMediaType != MediaType) {
+    MediaCacheInvalidate (MAX_UINTN, 0, MAX_UINT64);
+    ZeroMem (mCacheDevices, sizeof (mCacheDevices));
+  }
+
   mCurrentMediaType = MediaType;
   return EFI_SUCCESS;
 }
@@ -149,6 +527,8 @@ MediaSetInterfaceType (
   blocks are read, or an error is returned. If there is no media in the device,
   the function returns EFI_NO_MEDIA.
 
+  Reads smaller than a cache line are served from the media block cache.
+
   @param[in]  DeviceIndex   Specifies the block device to which the function wants
                             to talk.
   @param[in]  StartLBA      The starting logical block address (LBA) to read from
@@ -180,6 +560,8 @@ MediaReadBlocks (
   OUT VOID                          *Buffer
   )
 {
+  EFI_STATUS    Status;
+
   if (mCurrentMediaType >= OsBootDeviceMax) {
     return EFI_NOT_READY;
   }
@@ -188,6 +570,11 @@ MediaReadBlocks (
     return EFI_UNSUPPORTED;
   }
 
+  Status = MediaCacheReadBlocks (DeviceIndex, StartLBA, BufferSize, Buffer);
+  if (Status != EFI_UNSUPPORTED) {
+    return Status;
+  }
+
   return mDeviceBlockFuncs[mCurrentMediaType].ReadBlocks (DeviceIndex, StartLBA, BufferSize, Buffer);
 }
 
@@ -227,6 +614,13 @@ MediaWriteBlocks (
     return EFI_UNSUPPORTED;
   }
 
+  if ((DeviceIndex < MEDIA_CACHE_MAX_DEVICES) && mCacheDevices[DeviceIndex].BlockInfoValid &&
+      (mCacheDevices[DeviceIndex].BlockInfo.BlockSize != 0)) {
+    MediaCacheInvalidate (DeviceIndex, StartLBA, BufferSize / mCacheDevices[DeviceIndex].BlockInfo.BlockSize + 1);
+  } else {
+    MediaCacheInvalidate (DeviceIndex, 0, MAX_UINT64);
+  }
+
   return mDeviceBlockFuncs[mCurrentMediaType].WriteBlocks (DeviceIndex, StartLBA, BufferSize, Buffer);
 }
 
@@ -300,6 +694,8 @@ MediaInitialize (
     return EFI_UNSUPPORTED;
   }
 
+  MediaCacheInvalidate (MAX_UINTN, 0, MAX_UINT64);
+
   return mDeviceBlockFuncs[mCurrentMediaType].DevInit (MediaHcPciBase, DevInitPhase);
 }
 
@@ -342,6 +738,15 @@ MediaWriteBlocksExt (
     return EFI_UNSUPPORTED;
   }
 
+  //
+  // Extended writes drive request/response protocols such as RPMB, so
+  // reads from this device must always reach the media from now on.
+  //
+  MediaCacheInvalidate (DeviceIndex, 0, MAX_UINT64);
+  if (DeviceIndex < MEDIA_CACHE_MAX_DEVICES) {
+    mCacheDevices[DeviceIndex].Uncached = TRUE;
+  }
+
   return mDeviceBlockFuncs[mCurrentMediaType].WriteBlocksExt (DeviceIndex, StartLBA, BufferSize, Buffer, IsReliableWrite);
 }
 
@@ -370,6 +775,43 @@ MediaTuning (
     return EFI_UNSUPPORTED;
   }
 
+  MediaCacheInvalidate (MAX_UINTN, 0, MAX_UINT64);
+
   return mDeviceBlockFuncs[mCurrentMediaType].DevTuning (MediaHcPciBase);
 }
 
+/**
+  Get the block cache statistics of a device on the current media interface.
+
+  @param[in]  DeviceIndex    Specifies the block device to query.
+  @param[out] Stats          Pointer to receive the cache statistics.
+
+  @retval EFI_SUCCESS            The statistics were returned successfully.
+  @retval EFI_INVALID_PARAMETER  DeviceIndex is out of range or Stats is NULL.
+  @retval EFI_UNSUPPORTED        The block cache is disabled.
+  @retval EFI_NOT_READY          The MediaSetInterfaceType() has not been called yet.
+
+**/
+EFI_STATUS
+EFIAPI
+MediaGetCacheStats (
+  IN  UINTN                     DeviceIndex,
+  OUT MEDIA_CACHE_STATS        *Stats
+  )
+{
+  if ((DeviceIndex >= MEDIA_CACHE_MAX_DEVICES) || (Stats == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mCurrentMediaType >= OsBootDeviceMax) {
+    return EFI_NOT_READY;
+  }
+
+  if (FixedPcdGet32 (PcdMediaBlockCacheSize) / MEDIA_CACHE_LINE_SIZE < MEDIA_CACHE_MAX_READ_AHEAD) {
+    return EFI_UNSUPPORTED;
+  }
+
+  CopyMem (Stats, &mCacheDevices[DeviceIndex].Stats, sizeof (MEDIA_CACHE_STATS));
+  return EFI_SUCCESS;
+}
+
@@ -391,9 +391,12 @@ SdMmcInitialize (
   DumpCapabilityReg (&Private->Capability);
   DEBUG_CODE_END ();
 
-  if (Private->Capability.Adma2 && Private->Capability.Sdma) {
-    DEBUG ((DEBUG_INFO, "Use SDMA instead of ADMA2\n"));
-    Private->Capability.Adma2 = 0;
+  //
+  // Prefer ADMA2 over SDMA. ADMA2 transfers the whole request from a descriptor
+  // table without stopping at every SDMA buffer boundary.
+  //
+  if (Private->Capability.Adma2) {
+    DEBUG ((DEBUG_INFO, "Use ADMA2 for data transfer\n"));
   }
 
   /* Only support eMMC and SD for now */
@@ -1031,7 +1031,7 @@ BuildAdmaDescTable (
   Data    = (EFI_PHYSICAL_ADDRESS) (UINTN)Trb->DataPhy;
   DataLen = Trb->DataLen;
 
-  DEBUG ((DEBUG_INFO, "BuildAdmaDescTable Data=0x%08X DataLen=0x%08X\n", (UINT32) (UINTN)Data, (UINT32)DataLen));
+  DEBUG ((DEBUG_VERBOSE, "BuildAdmaDescTable Data=0x%08X DataLen=0x%08X\n", (UINT32) (UINTN)Data, (UINT32)DataLen));
   //
   // Only support 32bit ADMA Descriptor Table
   //
@@ -1044,6 +1044,7 @@ BuildAdmaDescTable (
   //
   if ((Data & (BIT0 | BIT1)) != 0) {
     DEBUG ((DEBUG_INFO, "The buffer [0x%x] to construct ADMA desc is not aligned to 4 bytes boundary!\n", Data));
+    return EFI_INVALID_PARAMETER;
   }
 
   Entries   = DivU64x32 ((DataLen + ADMA_MAX_DATA_PER_LINE - 1), ADMA_MAX_DATA_PER_LINE);
@@ -1181,7 +1182,7 @@ SdMmcCreateTrb (
   } else {
     if (Trb->DataLen == 0) {
       Trb->Mode = SdMmcNoData;
-    } else if (Private->Capability.Adma2 != 0) {
+    } else if ((Private->Capability.Adma2 != 0) && (((UINTN)Trb->Data & (BIT0 | BIT1)) == 0)) {
       Trb->Mode = SdMmcAdmaMode;
       Status = SdMmcSetupMemoryForDmaTransfer (Trb);
       if (EFI_ERROR (Status)) {
@@ -1390,6 +1391,12 @@ SdMmcExecTrb (
     if (EFI_ERROR (Status)) {
       return Status;
     }
+  } else if (Trb->Mode == SdMmcSdmaMode) {
+    HostCtrl1 = (UINT8)~(BIT3 | BIT4);
+    Status = SdMmcHcAndMmio (Address, SD_MMC_HC_HOST_CTRL1, sizeof (HostCtrl1), (VOID *) (UINTN)&HostCtrl1);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
   SdMmcHcLedOnOff (Address, TRUE);
@@ -16,6 +16,7 @@
 #define PD_SET_ADDR   (Address & ~(0xFFFF))
 #define PD_UNSET_ADDR (Address & ~(0xFFF))
 #define MIN_ADDR_BITS 32
+#define PAGE_ENTRY_ADDR_MASK  0x000FFFFFFFFFF000ULL
 
 /**
   The function will check if 5-level paging is needed
@@ -255,7 +256,9 @@ Create4GbPageTables (
     return EFI_INVALID_PARAMETER;
   }
 
-  PageLen = GetPageTablesMemorySize (IsX64Mode);
+  // PDE pages are fully populated below and the PTE page is populated
+  // by MapMemoryRange () before use, so only PML4 and PDP need clearing.
+  PageLen = IsX64Mode ? EFI_PAGE_SIZE * 2 : 0;
   ZeroMem (PageBuffer, PageLen);
 
   Address   = 0;
@@ -426,3 +429,90 @@ CreateIdentityMappingPageTables (
 
   return EFI_SUCCESS;
 }
+
+/**
+  Extend the current long mode page tables to identity map a memory range.
+
+  Only the 1GB regions covering the requested range are populated, using 1GB
+  pages if supported or a single 2MB page directory per 1GB region otherwise.
+  Regions that are already mapped are left untouched.
+
+  @param[in] Base          Base address of the range to map.
+  @param[in] Length        Length of the range to map.
+
+  @retval    EFI_SUCCESS            The range is identity mapped.
+  @retval    EFI_UNSUPPORTED        Long mode is not enabled.
+  @retval    EFI_INVALID_PARAMETER  The range is beyond 4-level paging limit.
+  @retval    EFI_OUT_OF_RESOURCES   Failed to allocate page buffer.
+
+**/
+EFI_STATUS
+EFIAPI
+IdentityMapMemoryRange (
+  IN  UINT64        Base,
+  IN  UINT64        Length
+  )
+{
+  UINT64           *Pml4;
+  UINT64           *Pdp;
+  UINT64           *Pd;
+  UINT64            Address;
+  UINT64            Limit;
+  UINTN             Pml4Idx;
+  UINTN             PdpIdx;
+  UINTN             Idx;
+  UINT32            Attribute;
+  BOOLEAN           Page1GSupport;
+
+  if (Length == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (!IsLongModeEnabled ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Limit = Base + Length - 1;
+  if ((Limit < Base) || (RShiftU64 (Limit, 48) != 0)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Page1GSupport = IsPage1GSupport ();
+  Attribute     = IA32_PG_P | IA32_PG_RW;
+  Pml4          = (UINT64 *)(UINTN)(AsmReadCr3 () & PAGE_ENTRY_ADDR_MASK);
+
+  for (Address = Base & ~((UINT64)SIZE_1GB - 1); Address <= Limit; Address += SIZE_1GB) {
+    Pml4Idx = (UINTN)RShiftU64 (Address, 39) & 0x1FF;
+    if ((Pml4[Pml4Idx] & IA32_PG_P) == 0) {
+      Pdp = (UINT64 *)AllocatePages (1);
+      if (Pdp == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+      ZeroMem (Pdp, SIZE_4KB);
+      Pml4[Pml4Idx] = (UINTN)Pdp + Attribute;
+    }
+
+    Pdp    = (UINT64 *)(UINTN)(Pml4[Pml4Idx] & PAGE_ENTRY_ADDR_MASK);
+    PdpIdx = (UINTN)RShiftU64 (Address, 30) & 0x1FF;
+    if ((Pdp[PdpIdx] & IA32_PG_P) != 0) {
+      continue;
+    }
+
+    if (Page1GSupport) {
+      Pdp[PdpIdx] = Address + (Attribute | IA32_PG_PD);
+    } else {
+      Pd = (UINT64 *)AllocatePages (1);
+      if (Pd == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+      for (Idx = 0; Idx < 512; Idx++) {
+        Pd[Idx] = Address + LShiftU64 (Idx, 21) + (Attribute | IA32_PG_PD);
+      }
+      Pdp[PdpIdx] = (UINTN)Pd + Attribute;
+    }
+  }
+
+  AsmWriteCr3 (AsmReadCr3 ());
+
+  return EFI_SUCCESS;
+}
@@ -29,6 +29,25 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define UNPACK_UINT32(a) \
   (UINT32) ((((UINT8 *) a)[0] << 0) | (((UINT8 *) a)[1] << 8) | (((UINT8 *) a)[2] << 16) | (((UINT8 *) a)[3] << 24))
 
+//
+// Number of devices whose parsed partition table is remembered
+//
+#define PART_CACHE_ENTRIES        4
+
+//
+// A parsed partition table, keyed by the device identity and the CRC of the
+// block anchoring the table (GPT header block, or the MBR when there is no GPT).
+//
+typedef struct {
+  BOOLEAN                       Valid;
+  OS_BOOT_MEDIUM_TYPE           MediaType;
+  UINT32                        HwDevice;
+  DEVICE_BLOCK_INFO             BlockInfo;
+  UINT32                        KeyCrc;
+  UINT32                        PartitionType;
+  UINT32                        BlockDeviceCount;
+  LOGICAL_BLOCK_DEVICE          BlockDevice[PART_MAX_BLOCK_DEVICE];
+} PART_CACHE_ENTRY;
 
 CHAR8 *mPartTypeName[] = {
   "UNKNOWN",
@@ -36,6 +55,9 @@ CHAR8 *mPartTypeName[] = {
   "GPT"
 };
 
+STATIC PART_CACHE_ENTRY  mPartCache[PART_CACHE_ENTRIES];
+STATIC UINT32            mPartCacheNext;
+
 extern
 EFI_STATUS
 FindSpiPartitions (
@@ -142,12 +164,12 @@ PartitionValidMbr (
   This function finds Mbr partitions. Main algorithm
   is ported from DXE partition driver.
 
-  @param[in]  PartBlockDev   Parition block device pointer
+  @param[in]  PartBlockDev   Parition block device pointer, with the MBR
+                             already read into its BlockData buffer
 
   @retval EFI_SUCCESS        New partitions are detected and logical block devices
                              are  added to block device array
   @retval EFI_NOT_FOUND      No New partitions are added
-  @retval EFI_DEVICE_ERROR   Error occured for device access
 
 **/
 EFI_STATUS
@@ -159,21 +181,10 @@ FindMbrPartitions (
   MASTER_BOOT_RECORD     *Mbr;
   UINTN                  Index;
   LOGICAL_BLOCK_DEVICE  *BlockDev;
-  UINTN                  ParentBlockDevNo;
   DEVICE_BLOCK_INFO     *DevBlockInfo;
 
   DevBlockInfo = &PartBlockDev->BlockInfo;
-  ParentBlockDevNo = PartBlockDev->HarewareDevice;
   Mbr    = (MASTER_BOOT_RECORD *) PartBlockDev->BlockData;
-  Status = MediaReadBlocks (
-             ParentBlockDevNo,
-             0,
-             DevBlockInfo->BlockSize,
-             Mbr
-             );
-  if (EFI_ERROR (Status)) {
-    return EFI_DEVICE_ERROR;
-  }
 
   Status = EFI_NOT_FOUND;
   if (!PartitionValidMbr (Mbr, DevBlockInfo->BlockNum - 1)) {
@@ -494,10 +505,99 @@ GetLogicalPartitionInfo (
   return EFI_SUCCESS;
 }
 
+/**
+  Look up a previously parsed partition table for a device.
+
+  @param[in]      MediaType     Current boot medium type.
+  @param[in]      KeyCrc        CRC of the block anchoring the partition table.
+  @param[in,out]  PartBlockDev  Partition block device with HarewareDevice and
+                                BlockInfo filled; receives the cached table on a hit.
+
+  @retval TRUE                  The cached table was copied into PartBlockDev.
+  @retval FALSE                 No matching table is cached.
+
+**/
+STATIC
+BOOLEAN
+LookupPartitionCache (
+  IN      OS_BOOT_MEDIUM_TYPE   MediaType,
+  IN      UINT32                KeyCrc,
+  IN OUT  PART_BLOCK_DEVICE    *PartBlockDev
+  )
+{
+  PART_CACHE_ENTRY  *Entry;
+  UINT32             Index;
+
+  for (Index = 0; Index < PART_CACHE_ENTRIES; Index++) {
+    Entry = &mPartCache[Index];
+    if (Entry->Valid && (Entry->MediaType == MediaType) && (Entry->KeyCrc == KeyCrc) &&
+        (Entry->HwDevice == PartBlockDev->HarewareDevice) &&
+        (Entry->BlockInfo.BlockNum == PartBlockDev->BlockInfo.BlockNum) &&
+        (Entry->BlockInfo.BlockSize == PartBlockDev->BlockInfo.BlockSize)) {
+      PartBlockDev->PartitionType    = Entry->PartitionType;
+      PartBlockDev->BlockDeviceCount = Entry->BlockDeviceCount;
+      PartBlockDev->PartitionChecked = TRUE;
+      CopyMem (PartBlockDev->BlockDevice, Entry->BlockDevice, sizeof (PartBlockDev->BlockDevice));
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Remember a parsed partition table so that later lookups on the same
+  device can skip parsing it again.
+
+  @param[in]  MediaType     Current boot medium type.
+  @param[in]  KeyCrc        CRC of the block anchoring the partition table.
+  @param[in]  PartBlockDev  Partition block device holding the parsed table.
+
+**/
+STATIC
+VOID
+UpdatePartitionCache (
+  IN  OS_BOOT_MEDIUM_TYPE   MediaType,
+  IN  UINT32                KeyCrc,
+  IN  PART_BLOCK_DEVICE    *PartBlockDev
+  )
+{
+  PART_CACHE_ENTRY  *Entry;
+  UINT32             Index;
+
+  //
+  // Replace the stale entry of the same device if there is one, otherwise
+  // recycle the slots in round-robin order.
+  //
+  Entry = NULL;
+  for (Index = 0; Index < PART_CACHE_ENTRIES; Index++) {
+    if (mPartCache[Index].Valid && (mPartCache[Index].MediaType == MediaType) &&
+        (mPartCache[Index].HwDevice == PartBlockDev->HarewareDevice)) {
+      Entry = &mPartCache[Index];
+      break;
+    }
+  }
+  if (Entry == NULL) {
+    Entry = &mPartCache[mPartCacheNext];
+    mPartCacheNext = (mPartCacheNext + 1) % PART_CACHE_ENTRIES;
+  }
+
+  Entry->Valid            = TRUE;
+  Entry->MediaType        = MediaType;
+  Entry->HwDevice         = PartBlockDev->HarewareDevice;
+  Entry->KeyCrc           = KeyCrc;
+  Entry->PartitionType    = PartBlockDev->PartitionType;
+  Entry->BlockDeviceCount = PartBlockDev->BlockDeviceCount;
+  CopyMem (&Entry->BlockInfo, &PartBlockDev->BlockInfo, sizeof (DEVICE_BLOCK_INFO));
+  CopyMem (Entry->BlockDevice, PartBlockDev->BlockDevice, sizeof (Entry->BlockDevice));
+}
+
 /**
 Find partitions from OS boot medium
 
 This function will check hardware partition for MBR, GPT or NONE parition.
+A table parsed earlier for the same device is reused as long as the block
+anchoring it (the GPT header, or the MBR) is unchanged.
 
   @param[in]   HwDevice      The hardware device index.
   @param[out]  PartHandle    The pointer to return parition handle
@@ -523,6 +623,10 @@ FindPartitions (
   EFI_PARTITION_TABLE_HEADER  *Gpt;
   PART_BLOCK_DEVICE           *PartBlockDev;
   OS_BOOT_MEDIUM_TYPE          CurrentMediaType;
+  BOOLEAN                      IsGpt;
+  BOOLEAN                      KeyValid;
+  BOOLEAN                      Cached;
+  UINT32                       KeyCrc;
 
   if (PartHandle == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -560,13 +664,42 @@ FindPartitions (
   Status = MediaReadBlocks (HwDevice, 1, DevBlockInfo.BlockSize, Buffer);
   if (!EFI_ERROR (Status)) {
     // Check GPT partition
-    Gpt = (EFI_PARTITION_TABLE_HEADER *)Buffer;
-    if ((UINT32)Gpt->Header.Signature == 0x20494645) {
+    Gpt   = (EFI_PARTITION_TABLE_HEADER *)Buffer;
+    IsGpt = (BOOLEAN)((UINT32)Gpt->Header.Signature == 0x20494645);
+
+    //
+    // Key the partition cache on the GPT header block, or on the MBR for
+    // disks without a GPT. Any change to the table changes this block.
+    // The MBR read here stays in Buffer for FindMbrPartitions ().
+    //
+    KeyValid = FALSE;
+    if (!IsGpt) {
+      Status = MediaReadBlocks (HwDevice, 0, DevBlockInfo.BlockSize, Buffer);
+    }
+    if (!EFI_ERROR (Status)) {
+      KeyValid = (BOOLEAN)!EFI_ERROR (CalculateCrc32WithType (Buffer, DevBlockInfo.BlockSize, Crc32TypeDefault, &KeyCrc));
+    }
+
+    Cached = KeyValid && LookupPartitionCache (CurrentMediaType, KeyCrc, PartBlockDev);
+    if (Cached) {
+      Status = EFI_SUCCESS;
+      DEBUG ((DEBUG_INFO, "Partition table cached for device %d\n", HwDevice));
+    } else if (EFI_ERROR (Status)) {
+      Status = EFI_DEVICE_ERROR;
+    } else if (IsGpt) {
       Status = FindGptPartitions (PartBlockDev);
     } else {
       Status = FindMbrPartitions (PartBlockDev);
     }
 
+    //
+    // Only a table that was parsed successfully is cached. The fallback
+    // below may come from a transient read error and must not stick.
+    //
+    if (KeyValid && !Cached && !EFI_ERROR (Status)) {
+      UpdatePartitionCache (CurrentMediaType, KeyCrc, PartBlockDev);
+    }
+
     // Check result
     if (EFI_ERROR (Status)) {
       // Could not find any partition, so assume no partitions
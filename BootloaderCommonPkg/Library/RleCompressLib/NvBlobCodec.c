@@ -0,0 +1,455 @@
+/** @file
+  Compression of small non-volatile data blobs, such as memory training
+  data, into the LZ4 block format with an optional byte delta filter.
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/RleCompressLib.h>
+
+//
+// LZ4 block format limits: a match is at least 4 bytes long, the last
+// 5 bytes are always literals and the last match starts at least 12
+// bytes before the end of the block.
+//
+#define LZ4_MIN_MATCH           4
+#define LZ4_LAST_LITERALS       5
+#define LZ4_MF_LIMIT            12
+#define LZ4_MAX_OFFSET          0xFFFF
+#define LZ4_RUN_MASK            0x0F
+
+//
+// The hash table holds the low 16 bits of the last position of each hash,
+// 4KB on the stack.
+//
+#define NV_BLOB_HASH_BITS       11
+
+/**
+  Get a byte of the data after the delta filter.
+
+  @param  Data             Source data buffer pointer.
+  @param  Index            Byte index.
+  @param  Stride           Delta stride, 0 for no filter.
+
+  @retval Filtered byte.
+
+**/
+STATIC
+UINT8
+GetFilteredByte (
+  IN  CONST UINT8       *Data,
+  IN  UINTN              Index,
+  IN  UINT8              Stride
+  )
+{
+  if ((Stride == 0) || (Index < Stride)) {
+    return Data[Index];
+  }
+  return (UINT8)(Data[Index] - Data[Index - Stride]);
+}
+
+/**
+  Get 4 bytes of the data after the delta filter.
+
+  @param  Data             Source data buffer pointer.
+  @param  Index            Index of the first byte.
+  @param  Stride           Delta stride, 0 for no filter.
+
+  @retval Filtered bytes, first byte in the lowest bits.
+
+**/
+STATIC
+UINT32
+GetFilteredUint32 (
+  IN  CONST UINT8       *Data,
+  IN  UINTN              Index,
+  IN  UINT8              Stride
+  )
+{
+  return GetFilteredByte (Data, Index, Stride)
+         | ((UINT32)GetFilteredByte (Data, Index + 1, Stride) << 8)
+         | ((UINT32)GetFilteredByte (Data, Index + 2, Stride) << 16)
+         | ((UINT32)GetFilteredByte (Data, Index + 3, Stride) << 24);
+}
+
+/**
+  Write an LZ4 length extension: bytes of 255 followed by the remainder.
+
+  @param  Buffer           Destination data buffer, or NULL.
+  @param  Index            Index to write at.
+  @param  Length           Length minus the 15 held in the token.
+
+  @retval Index after the extension.
+
+**/
+STATIC
+UINTN
+PutLength (
+  IN  OUT UINT8         *Buffer,
+  IN      UINTN          Index,
+  IN      UINTN          Length
+  )
+{
+  while (Length >= 0xFF) {
+    if (Buffer != NULL) {
+      Buffer[Index] = 0xFF;
+    }
+    Index++;
+    Length -= 0xFF;
+  }
+  if (Buffer != NULL) {
+    Buffer[Index] = (UINT8)Length;
+  }
+  return Index + 1;
+}
+
+/**
+  Write an LZ4 sequence: literals followed by an optional match.
+
+  @param  Data             Source data buffer pointer.
+  @param  Stride           Delta stride, 0 for no filter.
+  @param  Anchor           Index of the first literal.
+  @param  LiteralLength    Number of literals.
+  @param  Offset           Match offset, ignored if MatchLength is 0.
+  @param  MatchLength      Match length, 0 for the last sequence.
+  @param  Buffer           Destination data buffer, or NULL.
+  @param  Index            Index to write at.
+
+  @retval Index after the sequence.
+
+**/
+STATIC
+UINTN
+PutSequence (
+  IN      CONST UINT8   *Data,
+  IN      UINT8          Stride,
+  IN      UINTN          Anchor,
+  IN      UINTN          LiteralLength,
+  IN      UINTN          Offset,
+  IN      UINTN          MatchLength,
+  IN  OUT UINT8         *Buffer,
+  IN      UINTN          Index
+  )
+{
+  UINTN                 TokenIndex;
+  UINT8                 Token;
+  UINTN                 Loop;
+
+  TokenIndex = Index++;
+  Token      = (UINT8)(MIN (LiteralLength, LZ4_RUN_MASK) << 4);
+  if (LiteralLength >= LZ4_RUN_MASK) {
+    Index = PutLength (Buffer, Index, LiteralLength - LZ4_RUN_MASK);
+  }
+
+  if (Buffer != NULL) {
+    for (Loop = 0; Loop < LiteralLength; Loop++) {
+      Buffer[Index + Loop] = GetFilteredByte (Data, Anchor + Loop, Stride);
+    }
+  }
+  Index += LiteralLength;
+
+  if (MatchLength != 0) {
+    if (Buffer != NULL) {
+      Buffer[Index]     = (UINT8)Offset;
+      Buffer[Index + 1] = (UINT8)(Offset >> 8);
+    }
+    Index += 2;
+
+    MatchLength -= LZ4_MIN_MATCH;
+    Token |= (UINT8)MIN (MatchLength, LZ4_RUN_MASK);
+    if (MatchLength >= LZ4_RUN_MASK) {
+      Index = PutLength (Buffer, Index, MatchLength - LZ4_RUN_MASK);
+    }
+  }
+
+  if (Buffer != NULL) {
+    Buffer[TokenIndex] = Token;
+  }
+  return Index;
+}
+
+/**
+  LZ4 compress the data after the delta filter, with a greedy parse.
+
+  @param  Data             Source data buffer pointer.
+  @param  Length           Source data size.
+  @param  Stride           Delta stride, 0 for no filter.
+  @param  Buffer           Destination data buffer.
+                           If NULL, no data will be written.
+
+  @retval Compressed data length.
+
+**/
+STATIC
+UINTN
+Lz4CompressFiltered (
+  IN      CONST UINT8       *Data,
+  IN      UINTN              Length,
+  IN      UINT8              Stride,
+  IN  OUT UINT8             *Buffer
+  )
+{
+  UINT16                HashTable[1 << NV_BLOB_HASH_BITS];
+  UINTN                 Index;
+  UINTN                 Anchor;
+  UINTN                 Pos;
+  UINTN                 Candidate;
+  UINTN                 MatchLength;
+  UINT32                Sequence;
+  UINT32                Hash;
+
+  ZeroMem (HashTable, sizeof (HashTable));
+  Index  = 0;
+  Anchor = 0;
+  Pos    = 0;
+
+  while ((Length >= LZ4_MF_LIMIT) && (Pos + LZ4_MF_LIMIT <= Length)) {
+    Sequence = GetFilteredUint32 (Data, Pos, Stride);
+    Hash     = (Sequence * 2654435761U) >> (32 - NV_BLOB_HASH_BITS);
+
+    // Rebuild the full position from its low 16 bits
+    Candidate = (Pos & ~(UINTN)0xFFFF) | HashTable[Hash];
+    if (Candidate >= Pos) {
+      Candidate -= 0x10000;
+    }
+    HashTable[Hash] = (UINT16)Pos;
+
+    if ((Candidate >= Pos) || (Pos - Candidate > LZ4_MAX_OFFSET) ||
+        (GetFilteredUint32 (Data, Candidate, Stride) != Sequence)) {
+      Pos++;
+      continue;
+    }
+
+    MatchLength = LZ4_MIN_MATCH;
+    while ((Pos + MatchLength < Length - LZ4_LAST_LITERALS) &&
+           (GetFilteredByte (Data, Pos + MatchLength, Stride) == GetFilteredByte (Data, Candidate + MatchLength, Stride))) {
+      MatchLength++;
+    }
+
+    Index  = PutSequence (Data, Stride, Anchor, Pos - Anchor, Pos - Candidate, MatchLength, Buffer, Index);
+    Pos   += MatchLength;
+    Anchor = Pos;
+  }
+
+  return PutSequence (Data, Stride, Anchor, Length - Anchor, 0, 0, Buffer, Index);
+}
+
+/**
+  Compress a small non-volatile data blob, such as memory training data.
+
+  The data is LZ4 compressed, either directly or after a byte delta
+  against the previous 1, 2 or 4 bytes, whichever is the smallest. If the
+  data does not compress it is stored as is.
+
+  @param  Data             Source data buffer pointer.
+  @param  Length           Source data size.
+  @param  Buffer           Destination data buffer.
+                           If NULL, no data will be written.
+                           The caller needs to ensure the buffer holds at
+                           least NV_BLOB_MAX_SIZE (Length) bytes.
+
+  @retval Compressed data length, including the NV_BLOB_HEADER.
+
+**/
+UINTN
+NvBlobCompress (
+  IN      CONST UINT8       *Data,
+  IN      UINTN              Length,
+  IN  OUT UINT8             *Buffer
+  )
+{
+  STATIC CONST UINT8    Strides[] = {1, 2, 4};
+  NV_BLOB_HEADER        *Header;
+  UINTN                 Index;
+  UINTN                 Size;
+  UINTN                 BestSize;
+  UINT8                 BestStride;
+
+  BestStride = 0;
+  BestSize   = Lz4CompressFiltered (Data, Length, 0, NULL);
+  for (Index = 0; Index < ARRAY_SIZE (Strides); Index++) {
+    Size = Lz4CompressFiltered (Data, Length, Strides[Index], NULL);
+    if (Size < BestSize) {
+      BestSize   = Size;
+      BestStride = Strides[Index];
+    }
+  }
+
+  if (BestSize >= Length) {
+    BestSize = Length;
+  }
+
+  if (Buffer != NULL) {
+    Header              = (NV_BLOB_HEADER *)Buffer;
+    Header->Signature   = NV_BLOB_SIGNATURE;
+    Header->Length      = (UINT32)Length;
+    Header->Reserved    = 0;
+    if (BestSize == Length) {
+      Header->Method      = NV_BLOB_METHOD_STORE;
+      Header->DeltaStride = 0;
+      CopyMem (Buffer + sizeof (NV_BLOB_HEADER), Data, Length);
+    } else {
+      Header->Method      = NV_BLOB_METHOD_LZ4;
+      Header->DeltaStride = BestStride;
+      Lz4CompressFiltered (Data, Length, BestStride, Buffer + sizeof (NV_BLOB_HEADER));
+    }
+  }
+
+  return sizeof (NV_BLOB_HEADER) + BestSize;
+}
+
+/**
+  Read an LZ4 length extension.
+
+  @param  Data             Source data buffer pointer.
+  @param  Length           Source data size.
+  @param  Index            Index to read at, updated past the extension.
+  @param  Value            Length to add the extension to.
+
+  @retval TRUE             The extension was read.
+  @retval FALSE            The extension runs past the source data.
+
+**/
+STATIC
+BOOLEAN
+GetLength (
+  IN      CONST UINT8       *Data,
+  IN      UINTN              Length,
+  IN  OUT UINTN             *Index,
+  IN  OUT UINTN             *Value
+  )
+{
+  UINT8                 Byte;
+
+  do {
+    if (*Index >= Length) {
+      return FALSE;
+    }
+    Byte    = Data[(*Index)++];
+    *Value += Byte;
+  } while (Byte == 0xFF);
+
+  return TRUE;
+}
+
+/**
+  Decompress a data blob created by NvBlobCompress ().
+
+  @param  Data             Source data buffer pointer.
+  @param  Length           Source data size.
+  @param  Buffer           Destination data buffer.
+                           If NULL, only the decompressed length is returned.
+  @param  BufferSize       Destination data buffer size.
+
+  @retval Decompressed data length, or 0 if the blob is not valid or does
+          not fit in the buffer.
+
+**/
+UINTN
+NvBlobDecompress (
+  IN      CONST UINT8       *Data,
+  IN      UINTN              Length,
+  IN  OUT UINT8             *Buffer,
+  IN      UINTN              BufferSize
+  )
+{
+  NV_BLOB_HEADER        *Header;
+  UINTN                 In;
+  UINTN                 Out;
+  UINTN                 LiteralLength;
+  UINTN                 MatchLength;
+  UINTN                 Offset;
+  UINT8                 Token;
+
+  if (Length < sizeof (NV_BLOB_HEADER)) {
+    return 0;
+  }
+
+  Header = (NV_BLOB_HEADER *)Data;
+  if ((Header->Signature != NV_BLOB_SIGNATURE) || (Header->Length > BufferSize)) {
+    return 0;
+  }
+
+  if (Buffer == NULL) {
+    return Header->Length;
+  }
+
+  Data   += sizeof (NV_BLOB_HEADER);
+  Length -= sizeof (NV_BLOB_HEADER);
+
+  if (Header->Method == NV_BLOB_METHOD_STORE) {
+    if (Length != Header->Length) {
+      return 0;
+    }
+    CopyMem (Buffer, Data, Length);
+    return Length;
+  }
+
+  if (Header->Method != NV_BLOB_METHOD_LZ4) {
+    return 0;
+  }
+
+  In  = 0;
+  Out = 0;
+  while (In < Length) {
+    Token = Data[In++];
+
+    LiteralLength = Token >> 4;
+    if ((LiteralLength == LZ4_RUN_MASK) && !GetLength (Data, Length, &In, &LiteralLength)) {
+      return 0;
+    }
+    if ((LiteralLength > Length - In) || (LiteralLength > Header->Length - Out)) {
+      return 0;
+    }
+    CopyMem (Buffer + Out, Data + In, LiteralLength);
+    In  += LiteralLength;
+    Out += LiteralLength;
+
+    // The last sequence has no match
+    if (In == Length) {
+      break;
+    }
+
+    if (Length - In < 2) {
+      return 0;
+    }
+    Offset = Data[In] | (Data[In + 1] << 8);
+    In    += 2;
+    if ((Offset == 0) || (Offset > Out)) {
+      return 0;
+    }
+
+    MatchLength = Token & LZ4_RUN_MASK;
+    if ((MatchLength == LZ4_RUN_MASK) && !GetLength (Data, Length, &In, &MatchLength)) {
+      return 0;
+    }
+    MatchLength += LZ4_MIN_MATCH;
+    if (MatchLength > Header->Length - Out) {
+      return 0;
+    }
+
+    // Matches may overlap the bytes they produce, copy forward
+    while (MatchLength-- > 0) {
+      Buffer[Out] = Buffer[Out - Offset];
+      Out++;
+    }
+  }
+
+  if (Out != Header->Length) {
+    return 0;
+  }
+
+  if (Header->DeltaStride != 0) {
+    for (Out = Header->DeltaStride; Out < Header->Length; Out++) {
+      Buffer[Out] = (UINT8)(Buffer[Out] + Buffer[Out - Header->DeltaStride]);
+    }
+  }
+
+  return Header->Length;
+}
@@ -0,0 +1,901 @@
+/** @file
+  Shell command `bench` to run simple throughput benchmarks.
+
+  Each benchmark prints a table, followed by one machine-readable line per
+  result in the form "BENCH,<benchmark>,<name>,<value>,<unit>".
+
+  Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/ShellLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/TimerLib.h>
+#include <Library/PrintLib.h>
+#include <Library/Crc32Lib.h>
+#include <Library/CryptoLib.h>
+#include <Library/DecompressLib.h>
+#include <Library/Lz4DecompressLib.h>
+#include <Library/LzmaDecompressLib.h>
+#include <Library/MediaAccessLib.h>
+#include <Library/BootOptionLib.h>
+#include <Library/BootloaderCommonLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/CpuTaskPoolLib.h>
+#include <Guid/FlashMapInfoGuid.h>
+
+#define BENCH_CHUNK_SIZE              SIZE_64KB
+#define BENCH_DEFAULT_SIZE_MB         32
+// Largest size whose byte count fits in UINTN and chunk count in UINT32
+#define BENCH_MAX_SIZE_MB             MIN (MAX_UINTN / SIZE_1MB, MAX_UINT32 / (SIZE_1MB / BENCH_CHUNK_SIZE))
+#define BENCH_MAX_RESULTS             32
+#define BENCH_NAME_LENGTH             24
+#define BENCH_MEM_BUFFER_SIZE         SIZE_64MB
+#define BENCH_MEM_TOTAL_SIZE          SIZE_256MB
+#define BENCH_RSA_ITERATIONS          32
+#define BENCH_DECOMPRESS_ITERATIONS   4
+#define BENCH_BLK_REQUEST_SIZE        SIZE_1MB
+#define BENCH_BLK_RANDOM_READS        512
+
+typedef struct {
+  UINT8     *Buffer;
+  UINT32    *Crc;
+} BENCH_MP_CONTEXT;
+
+typedef struct {
+  CHAR16           Name[BENCH_NAME_LENGTH];
+  UINT64           Value;
+  CONST CHAR16    *Unit;
+} BENCH_RESULT;
+
+typedef
+UINT8 *
+(EFIAPI *BENCH_HASH_FUNC) (
+  IN  CONST UINT8          *Data,
+  IN        UINT32          Length,
+  OUT       UINT8          *Digest
+  );
+
+typedef struct {
+  CONST CHAR16     *Name;
+  BENCH_HASH_FUNC   Func;
+} BENCH_HASH;
+
+STATIC BENCH_RESULT   mBenchResult[BENCH_MAX_RESULTS];
+STATIC UINT32         mBenchResultCount;
+
+/**
+  Run simple throughput benchmarks.
+
+  @param[in]  Shell        shell instance
+  @param[in]  Argc         number of command line arguments
+  @param[in]  Argv         command line arguments
+
+  @retval EFI_SUCCESS
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+ShellCommandBenchFunc (
+  IN SHELL  *Shell,
+  IN UINTN   Argc,
+  IN CHAR16 *Argv[]
+  );
+
+CONST SHELL_COMMAND ShellCommandBench = {
+  L"bench",
+  L"Run throughput benchmarks",
+  &ShellCommandBenchFunc
+};
+
+/**
+  Get the time elapsed since a performance counter value.
+
+  @param[in]  Start        performance counter value at the start
+
+  @retval     Elapsed time in microseconds, at least 1.
+
+**/
+STATIC
+UINT64
+BenchElapsedUs (
+  IN  UINT64   Start
+  )
+{
+  UINT64   Time;
+
+  Time = DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - Start), 1000);
+  return MAX (Time, 1);
+}
+
+/**
+  Record a result to print as a machine-readable line once the table is done.
+
+  @param[in]  Name         result name
+  @param[in]  Value        result value
+  @param[in]  Unit         result unit
+
+**/
+STATIC
+VOID
+BenchRecord (
+  IN  CONST CHAR16   *Name,
+  IN  UINT64          Value,
+  IN  CONST CHAR16   *Unit
+  )
+{
+  if (mBenchResultCount < BENCH_MAX_RESULTS) {
+    StrCpyS (mBenchResult[mBenchResultCount].Name, ARRAY_SIZE (mBenchResult[0].Name), Name);
+    mBenchResult[mBenchResultCount].Value = Value;
+    mBenchResult[mBenchResultCount].Unit  = Unit;
+    mBenchResultCount++;
+  }
+}
+
+/**
+  Print the recorded results as "BENCH,<group>,<name>,<value>,<unit>" lines
+  so that they can be collected from the console log by CI.
+
+  @param[in]  Group        benchmark name
+
+**/
+STATIC
+VOID
+BenchPrintResults (
+  IN  CONST CHAR16   *Group
+  )
+{
+  UINT32   Index;
+
+  ShellPrint (L"\n");
+  for (Index = 0; Index < mBenchResultCount; Index++) {
+    ShellPrint (L"BENCH,%s,%s,%ld,%s\n", Group, mBenchResult[Index].Name,
+                mBenchResult[Index].Value, mBenchResult[Index].Unit);
+  }
+  mBenchResultCount = 0;
+}
+
+/**
+  Fill and checksum a range of buffer chunks.
+
+  @param[in]  Context      BENCH_MP_CONTEXT
+  @param[in]  Start        first chunk
+  @param[in]  End          one past the last chunk
+
+**/
+STATIC
+VOID
+EFIAPI
+BenchMpChunk (
+  IN  VOID    *Context,
+  IN  UINT32   Start,
+  IN  UINT32   End
+  )
+{
+  BENCH_MP_CONTEXT  *Bench;
+  UINT8             *Chunk;
+  UINT32             Index;
+
+  Bench = (BENCH_MP_CONTEXT *)Context;
+  for (Index = Start; Index < End; Index++) {
+    Chunk = Bench->Buffer + (UINTN)Index * BENCH_CHUNK_SIZE;
+    SetMem (Chunk, BENCH_CHUNK_SIZE, (UINT8)Index);
+    CalculateCrc32WithType (Chunk, BENCH_CHUNK_SIZE, Crc32TypeDefault, &Bench->Crc[Index]);
+  }
+}
+
+/**
+  Scrub a dirty buffer on all CPUs of the task pool and verify it.
+
+  @param[in]  SizeMb       buffer size in MB
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES  Buffer allocation failed
+  @retval EFI_COMPROMISED_DATA  The buffer was not cleared
+
+**/
+STATIC
+EFI_STATUS
+BenchScrub (
+  IN  UINT32   SizeMb
+  )
+{
+  EFI_STATUS   Status;
+  VOID        *Buffer;
+  UINTN        Pages;
+  UINT64       Start;
+  UINT64       Time;
+
+  Pages  = EFI_SIZE_TO_PAGES ((UINTN)SizeMb * SIZE_1MB);
+  Buffer = AllocatePages (Pages);
+  if (Buffer == NULL) {
+    ShellPrint (L"Failed to allocate %d MB buffer!\n", SizeMb);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem (Buffer, EFI_PAGES_TO_SIZE (Pages), 0xA5);
+
+  Start  = GetPerformanceCounter ();
+  CpuTaskPoolScrubMemory ((UINTN)Buffer, EFI_PAGES_TO_SIZE (Pages), 0);
+  Time   = BenchElapsedUs (Start);
+  Status = CpuTaskPoolVerifyMemory ((UINTN)Buffer, EFI_PAGES_TO_SIZE (Pages), 0);
+
+  ShellPrint (L"Scrubbed %d MB with %d CPUs in %ld us, %ld MB/s, verify %r\n",
+              SizeMb, CpuTaskPoolGetWorkerCount (), Time,
+              DivU64x64Remainder (MultU64x32 (SizeMb, 1000000), Time, NULL), Status);
+  BenchRecord (L"scrub", DivU64x64Remainder (MultU64x32 (SizeMb, 1000000), Time, NULL), L"MB/s");
+
+  FreePages (Buffer, Pages);
+
+  BenchPrintResults (L"scrub");
+  return Status;
+}
+
+/**
+  Measure the scaling of the CPU task pool with a fill and CRC32 workload.
+
+  @param[in]  SizeMb       buffer size in MB
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES  Buffer allocation failed
+
+**/
+STATIC
+EFI_STATUS
+BenchMp (
+  IN  UINT32   SizeMb
+  )
+{
+  BENCH_MP_CONTEXT     Bench;
+  CPU_TASK_GROUP      *Group;
+  CHAR16               Name[BENCH_NAME_LENGTH];
+  UINT32               ChunkCount;
+  UINT32               MaxWorkers;
+  UINT32               Workers;
+  UINT32               Index;
+  UINT32               Steals;
+  UINT32               CrcSum;
+  UINT32               RefSum;
+  UINT64               Start;
+  UINT64               Time;
+  UINT64               RefTime;
+
+  ChunkCount   = SizeMb * (SIZE_1MB / BENCH_CHUNK_SIZE);
+  Bench.Buffer = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN)ChunkCount * BENCH_CHUNK_SIZE));
+  Bench.Crc    = AllocatePool (ChunkCount * sizeof (UINT32));
+  Group        = AllocatePool (sizeof (CPU_TASK_GROUP));
+  if ((Bench.Buffer == NULL) || (Bench.Crc == NULL) || (Group == NULL)) {
+    ShellPrint (L"Failed to allocate %d MB buffer!\n", SizeMb);
+    if (Bench.Buffer != NULL) {
+      FreePages (Bench.Buffer, EFI_SIZE_TO_PAGES ((UINTN)ChunkCount * BENCH_CHUNK_SIZE));
+    }
+    if (Bench.Crc != NULL) {
+      FreePool (Bench.Crc);
+    }
+    if (Group != NULL) {
+      FreePool (Group);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  MaxWorkers = CpuTaskPoolGetWorkerCount ();
+  ShellPrint (L"Fill + CRC32 of %d MB in %d KB chunks, %d CPUs available\n\n",
+              SizeMb, BENCH_CHUNK_SIZE / SIZE_1KB, MaxWorkers);
+  ShellPrint (L" CPUs |  Time (us) |   MB/s   | Speedup | Steals\n");
+  ShellPrint (L"------+------------+----------+---------+--------\n");
+
+  RefTime = 0;
+  RefSum  = 0;
+  for (Workers = 1; ; Workers = MIN (Workers * 2, MaxWorkers)) {
+    Start = GetPerformanceCounter ();
+    CpuTaskGroupStart (Group, ChunkCount, 1, Workers, BenchMpChunk, &Bench);
+    CpuTaskGroupWait (Group);
+    Time  = BenchElapsedUs (Start);
+
+    Steals = 0;
+    CrcSum = 0;
+    for (Index = 0; Index < Group->WorkerCount; Index++) {
+      Steals += Group->Queue[Index].Steals;
+    }
+    for (Index = 0; Index < ChunkCount; Index++) {
+      CrcSum ^= Bench.Crc[Index];
+    }
+    if (RefTime == 0) {
+      RefTime = Time;
+      RefSum  = CrcSum;
+    }
+
+    ShellPrint (L" %4d | %10ld | %8ld | %3d.%02dx | %6d%s\n",
+                Group->WorkerCount, Time, DivU64x64Remainder (MultU64x32 (SizeMb, 1000000), Time, NULL),
+                (UINT32)DivU64x64Remainder (RefTime, Time, NULL),
+                (UINT32)DivU64x64Remainder (MultU64x32 (RefTime, 100), Time, NULL) % 100,
+                Steals, (CrcSum == RefSum) ? L"" : L"  CRC MISMATCH!");
+    UnicodeSPrint (Name, sizeof (Name), L"cpus-%d", Group->WorkerCount);
+    BenchRecord (Name, DivU64x64Remainder (MultU64x32 (SizeMb, 1000000), Time, NULL), L"MB/s");
+
+    if (Workers >= MaxWorkers) {
+      break;
+    }
+  }
+
+  FreePool (Group);
+  FreePool (Bench.Crc);
+  FreePages (Bench.Buffer, EFI_SIZE_TO_PAGES ((UINTN)ChunkCount * BENCH_CHUNK_SIZE));
+
+  BenchPrintResults (L"mp");
+  return EFI_SUCCESS;
+}
+
+/**
+  Time CopyMem () or SetMem () on blocks of one size.
+
+  With Cold set, each call moves to the next block of the buffer so the
+  data is never in the caches. Otherwise the same block is used by every
+  call, after one call to warm the caches up.
+
+  @param[in]  Dst          destination buffer, BENCH_MEM_BUFFER_SIZE bytes
+  @param[in]  Src          source buffer, BENCH_MEM_BUFFER_SIZE bytes
+  @param[in]  Size         block size
+  @param[in]  Cold         TRUE to walk through the buffers
+  @param[in]  Copy         TRUE for CopyMem (), FALSE for SetMem ()
+
+  @retval     Throughput in MB/s.
+
+**/
+STATIC
+UINT64
+BenchMemCase (
+  IN  UINT8    *Dst,
+  IN  UINT8    *Src,
+  IN  UINT32    Size,
+  IN  BOOLEAN   Cold,
+  IN  BOOLEAN   Copy
+  )
+{
+  UINT32   Iterations;
+  UINT32   Index;
+  UINT32   Offset;
+  UINT64   Start;
+
+  Iterations = BENCH_MEM_TOTAL_SIZE / Size;
+  Offset     = 0;
+  if (!Cold) {
+    CopyMem (Dst, Src, Size);
+  }
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < Iterations; Index++) {
+    if (Copy) {
+      CopyMem (Dst + Offset, Src + Offset, Size);
+    } else {
+      SetMem (Dst + Offset, Size, (UINT8)Index);
+    }
+    if (Cold) {
+      Offset += Size;
+      if (Offset + Size > BENCH_MEM_BUFFER_SIZE) {
+        Offset = 0;
+      }
+    }
+  }
+
+  return DivU64x64Remainder (MultU64x32 (Iterations, Size), BenchElapsedUs (Start), NULL);
+}
+
+/**
+  Measure CopyMem () and SetMem () of the linked BaseMemoryLib instance.
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES  Buffer allocation failed
+
+**/
+STATIC
+EFI_STATUS
+BenchMem (
+  VOID
+  )
+{
+  STATIC CONST UINT32  BlockSize[] = { SIZE_4KB, SIZE_256KB, SIZE_4MB };
+  STATIC CONST CHAR16  *CaseName[] = { L"copy-hot", L"copy-cold", L"set-hot", L"set-cold" };
+  UINT8               *Dst;
+  UINT8               *Src;
+  UINT64               Rate[ARRAY_SIZE (CaseName)];
+  CHAR16               Name[BENCH_NAME_LENGTH];
+  UINT32               Index;
+  UINT32               Case;
+
+  Dst = AllocatePages (EFI_SIZE_TO_PAGES (BENCH_MEM_BUFFER_SIZE));
+  Src = AllocatePages (EFI_SIZE_TO_PAGES (BENCH_MEM_BUFFER_SIZE));
+  if ((Dst == NULL) || (Src == NULL)) {
+    ShellPrint (L"Failed to allocate %d MB buffers!\n", 2 * BENCH_MEM_BUFFER_SIZE / SIZE_1MB);
+    if (Dst != NULL) {
+      FreePages (Dst, EFI_SIZE_TO_PAGES (BENCH_MEM_BUFFER_SIZE));
+    }
+    if (Src != NULL) {
+      FreePages (Src, EFI_SIZE_TO_PAGES (BENCH_MEM_BUFFER_SIZE));
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+  SetMem (Src, BENCH_MEM_BUFFER_SIZE, 0x5A);
+  SetMem (Dst, BENCH_MEM_BUFFER_SIZE, 0xA5);
+
+  ShellPrint (L"CopyMem/SetMem in MB/s, hot: same block, cold: walking a %d MB buffer\n\n",
+              BENCH_MEM_BUFFER_SIZE / SIZE_1MB);
+  ShellPrint (L"  Block  | Copy hot | Copy cold |  Set hot | Set cold\n");
+  ShellPrint (L"---------+----------+-----------+----------+----------\n");
+
+  for (Index = 0; Index < ARRAY_SIZE (BlockSize); Index++) {
+    Rate[0] = BenchMemCase (Dst, Src, BlockSize[Index], FALSE, TRUE);
+    Rate[1] = BenchMemCase (Dst, Src, BlockSize[Index], TRUE,  TRUE);
+    Rate[2] = BenchMemCase (Dst, Src, BlockSize[Index], FALSE, FALSE);
+    Rate[3] = BenchMemCase (Dst, Src, BlockSize[Index], TRUE,  FALSE);
+    ShellPrint (L" %5d KB | %8ld | %9ld | %8ld | %8ld\n", BlockSize[Index] / SIZE_1KB,
+                Rate[0], Rate[1], Rate[2], Rate[3]);
+
+    for (Case = 0; Case < ARRAY_SIZE (CaseName); Case++) {
+      UnicodeSPrint (Name, sizeof (Name), L"%s-%dKB", CaseName[Case], BlockSize[Index] / SIZE_1KB);
+      BenchRecord (Name, Rate[Case], L"MB/s");
+    }
+  }
+
+  FreePages (Src, EFI_SIZE_TO_PAGES (BENCH_MEM_BUFFER_SIZE));
+  FreePages (Dst, EFI_SIZE_TO_PAGES (BENCH_MEM_BUFFER_SIZE));
+
+  BenchPrintResults (L"mem");
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure the hash algorithms of the linked crypto library.
+
+  @param[in]  SizeMb       size of data to hash in MB
+
+  @retval EFI_SUCCESS
+  @retval EFI_INVALID_PARAMETER SizeMb is 0 or too large for a single hash call
+  @retval EFI_OUT_OF_RESOURCES  Buffer allocation failed
+
+**/
+STATIC
+EFI_STATUS
+BenchHash (
+  IN  UINT32   SizeMb
+  )
+{
+  STATIC CONST BENCH_HASH  Hash[] = {
+    { L"sha256", Sha256 },
+    { L"sha384", Sha384 },
+    { L"sm3",    Sm3    }
+  };
+  UINT8       *Buffer;
+  UINT8        Digest[HASH_DIGEST_MAX];
+  UINT32       Index;
+  UINT32       Length;
+  UINT64       Start;
+  UINT64       Time;
+  UINT64       Rate;
+
+  // The hash functions take a UINT32 length
+  if ((SizeMb == 0) || (SizeMb > MAX_UINT32 / SIZE_1MB)) {
+    ShellPrint (L"Hash size must be 1 to %d MB!\n", MAX_UINT32 / SIZE_1MB);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Length = SizeMb * SIZE_1MB;
+  Buffer = AllocatePages (EFI_SIZE_TO_PAGES (Length));
+  if (Buffer == NULL) {
+    ShellPrint (L"Failed to allocate %d MB buffer!\n", SizeMb);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  SetMem (Buffer, Length, 0x5A);
+
+  ShellPrint (L"Hash of %d MB, SHA optimization mask 0x%x\n\n", SizeMb, FixedPcdGet32 (PcdCryptoShaOptMask));
+  ShellPrint (L" Algorithm |  Time (us) |   MB/s\n");
+  ShellPrint (L"-----------+------------+----------\n");
+
+  for (Index = 0; Index < ARRAY_SIZE (Hash); Index++) {
+    Start = GetPerformanceCounter ();
+    if (Hash[Index].Func (Buffer, Length, Digest) == NULL) {
+      ShellPrint (L" %9s |        n/a |      n/a\n", Hash[Index].Name);
+      continue;
+    }
+    Time = BenchElapsedUs (Start);
+    Rate = DivU64x64Remainder (MultU64x32 (Length, 1000000), MultU64x32 (Time, SIZE_1MB), NULL);
+    ShellPrint (L" %9s | %10ld | %8ld\n", Hash[Index].Name, Time, Rate);
+    BenchRecord (Hash[Index].Name, Rate, L"MB/s");
+  }
+
+  FreePages (Buffer, EFI_SIZE_TO_PAGES (Length));
+
+  BenchPrintResults (L"hash");
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure RSA PKCS#1 v1.5 signature verification.
+
+  A synthetic key and signature are used, so every verification goes
+  through the full public key operation and then fails the padding check,
+  which costs the same as a successful verification.
+
+  @retval EFI_SUCCESS
+  @retval EFI_OUT_OF_RESOURCES  Buffer allocation failed
+
+**/
+STATIC
+EFI_STATUS
+BenchRsa (
+  VOID
+  )
+{
+  STATIC CONST UINT8   PubExp[RSA_E_SIZE] = { 0x00, 0x01, 0x00, 0x01 };
+  STATIC CONST UINT32  KeyModSize[]       = { RSA2048_MOD_SIZE, RSA3072_MOD_SIZE };
+  PUB_KEY_HDR         *PubKey;
+  SIGNATURE_HDR       *Signature;
+  UINT8                Digest[HASH_DIGEST_MAX];
+  CHAR16               Name[BENCH_NAME_LENGTH];
+  RETURN_STATUS        Status;
+  UINT32               ModSize;
+  UINT32               Key;
+  UINT32               Index;
+  UINT64               Start;
+  UINT64               Time;
+
+  PubKey    = AllocatePool (sizeof (PUB_KEY_HDR) + RSA3072_MOD_SIZE + RSA_E_SIZE);
+  Signature = AllocatePool (sizeof (SIGNATURE_HDR) + RSA3072_MOD_SIZE);
+  if ((PubKey == NULL) || (Signature == NULL)) {
+    ShellPrint (L"Failed to allocate RSA buffers!\n");
+    if (PubKey != NULL) {
+      FreePool (PubKey);
+    }
+    if (Signature != NULL) {
+      FreePool (Signature);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+  SetMem (Digest, sizeof (Digest), 0x5A);
+
+  ShellPrint (L"RSA PKCS#1 v1.5 verify, %d operations per key size\n\n", BENCH_RSA_ITERATIONS);
+  ShellPrint (L"   Key    | Op time (us) |  Ops/s  | Result\n");
+  ShellPrint (L"----------+--------------+---------+--------\n");
+
+  for (Key = 0; Key < ARRAY_SIZE (KeyModSize); Key++) {
+    ModSize = KeyModSize[Key];
+    PubKey->Identifier = PUBKEY_IDENTIFIER;
+    PubKey->KeySize    = (UINT16)(ModSize + RSA_E_SIZE);
+    PubKey->KeyType    = KEY_TYPE_RSA;
+    PubKey->Rsvd       = 0;
+    SetMem (PubKey->KeyData, ModSize, 0xFF);
+    CopyMem (PubKey->KeyData + ModSize, PubExp, RSA_E_SIZE);
+
+    Signature->Identifier = SIGNATURE_IDENTIFIER;
+    Signature->SigSize    = (UINT16)ModSize;
+    Signature->SigType    = SIGNING_TYPE_RSA_PKCS_1_5;
+    Signature->HashAlg    = (ModSize == RSA2048_MOD_SIZE) ? HASH_TYPE_SHA256 : HASH_TYPE_SHA384;
+    SetMem (Signature->Signature, ModSize, 0x5A);
+
+    Status = RETURN_SUCCESS;
+    Start  = GetPerformanceCounter ();
+    for (Index = 0; Index < BENCH_RSA_ITERATIONS; Index++) {
+      Status = RsaVerify_Pkcs_1_5 (PubKey, Signature, Digest);
+      if ((Status != RETURN_SUCCESS) && (Status != RETURN_SECURITY_VIOLATION)) {
+        break;
+      }
+    }
+    Time = BenchElapsedUs (Start);
+
+    if ((Status != RETURN_SUCCESS) && (Status != RETURN_SECURITY_VIOLATION)) {
+      ShellPrint (L" RSA%d  |          n/a |     n/a | %r\n", ModSize * 8, Status);
+      continue;
+    }
+
+    ShellPrint (L" RSA%d  | %12ld | %7ld | %r\n", ModSize * 8,
+                DivU64x32 (Time, BENCH_RSA_ITERATIONS),
+                DivU64x64Remainder (MultU64x32 (1000000, BENCH_RSA_ITERATIONS), Time, NULL), Status);
+    UnicodeSPrint (Name, sizeof (Name), L"rsa%d-verify", ModSize * 8);
+    BenchRecord (Name, DivU64x64Remainder (MultU64x32 (1000000, BENCH_RSA_ITERATIONS), Time, NULL), L"ops/s");
+  }
+
+  FreePool (Signature);
+  FreePool (PubKey);
+
+  BenchPrintResults (L"rsa");
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure decompression of the flash components compressed with one
+  algorithm. The compressed data is copied to memory first so that the
+  flash read speed is not part of the result.
+
+  @param[in]  Signature    LZ4_SIGNATURE, LZMA_SIGNATURE or LZMF_SIGNATURE
+  @param[in]  Group        benchmark name
+
+  @retval EFI_SUCCESS
+  @retval EFI_NOT_FOUND         No component is compressed with the algorithm
+
+**/
+STATIC
+EFI_STATUS
+BenchDecompress (
+  IN  UINT32          Signature,
+  IN  CONST CHAR16   *Group
+  )
+{
+  FLASH_MAP                 *FlashMap;
+  FLASH_MAP_ENTRY_DESC      *Entry;
+  LOADER_COMPRESSED_HEADER  *CompHdr;
+  UINT8                     *Src;
+  UINT8                     *Dst;
+  UINT8                     *Scratch;
+  CHAR16                     Name[BENCH_NAME_LENGTH];
+  CHAR8                      CompName[sizeof (UINT32) + 1];
+  RETURN_STATUS              Status;
+  UINT32                     EntryCount;
+  UINT32                     Index;
+  UINT32                     Iteration;
+  UINT32                     RomBase;
+  UINT32                     DstSize;
+  UINT32                     ScratchSize;
+  UINT32                     Found;
+  UINT64                     Start;
+  UINT64                     Time;
+
+  FlashMap = (FLASH_MAP *)GetFlashMapPtr ();
+  if (FlashMap == NULL) {
+    ShellPrint (L"Flash map is not available!\n");
+    return EFI_NOT_FOUND;
+  }
+
+  RomBase    = (UINT32)(0x100000000ULL - FlashMap->RomSize);
+  EntryCount = (FlashMap->Length - sizeof (FLASH_MAP)) / sizeof (FLASH_MAP_ENTRY_DESC);
+  Found      = 0;
+
+  ShellPrint (L"%s decompression of flash components, %d runs each\n\n", Group, BENCH_DECOMPRESS_ITERATIONS);
+  ShellPrint (L" Component | Packed (KB) |  Size (KB) |  Time (us) |   MB/s\n");
+  ShellPrint (L"-----------+-------------+------------+------------+----------\n");
+
+  for (Index = 0; Index < EntryCount; Index++) {
+    Entry   = &FlashMap->EntryDesc[Index];
+    CompHdr = (LOADER_COMPRESSED_HEADER *)(UINTN)(RomBase + Entry->Offset);
+    if ((Entry->Size < sizeof (LOADER_COMPRESSED_HEADER)) || (CompHdr->Signature != Signature) ||
+        (CompHdr->CompressedSize > Entry->Size - sizeof (LOADER_COMPRESSED_HEADER))) {
+      continue;
+    }
+
+    ZeroMem (CompName, sizeof (CompName));
+    CopyMem (CompName, &Entry->Signature, sizeof (Entry->Signature));
+    Status = DecompressGetInfo (Signature, CompHdr->Data, CompHdr->CompressedSize, &DstSize, &ScratchSize);
+    if (RETURN_ERROR (Status)) {
+      continue;
+    }
+
+    Src     = AllocatePages (EFI_SIZE_TO_PAGES (CompHdr->CompressedSize));
+    Dst     = AllocatePages (EFI_SIZE_TO_PAGES (DstSize));
+    Scratch = AllocatePages (EFI_SIZE_TO_PAGES (MAX (ScratchSize, 1)));
+    if ((Src != NULL) && (Dst != NULL) && (Scratch != NULL)) {
+      CopyMem (Src, CompHdr->Data, CompHdr->CompressedSize);
+      Start = GetPerformanceCounter ();
+      for (Iteration = 0; Iteration < BENCH_DECOMPRESS_ITERATIONS; Iteration++) {
+        Status = Decompress (Signature, Src, CompHdr->CompressedSize, Dst, Scratch);
+        if (RETURN_ERROR (Status)) {
+          break;
+        }
+      }
+      Time = DivU64x32 (BenchElapsedUs (Start), BENCH_DECOMPRESS_ITERATIONS);
+      Time = MAX (Time, 1);
+
+      if (RETURN_ERROR (Status)) {
+        ShellPrint (L"   %a    | %11d | %10d | %r\n", CompName,
+                    CompHdr->CompressedSize / SIZE_1KB, DstSize / SIZE_1KB, Status);
+      } else {
+        ShellPrint (L"   %a    | %11d | %10d | %10ld | %8ld\n", CompName,
+                    CompHdr->CompressedSize / SIZE_1KB, DstSize / SIZE_1KB, Time,
+                    DivU64x64Remainder (DstSize, Time, NULL));
+        UnicodeSPrint (Name, sizeof (Name), L"%a", CompName);
+        BenchRecord (Name, DivU64x64Remainder (DstSize, Time, NULL), L"MB/s");
+      }
+      Found++;
+    } else {
+      ShellPrint (L"   %a    | %11d | %10d | Out of memory\n", CompName,
+                  CompHdr->CompressedSize / SIZE_1KB, DstSize / SIZE_1KB);
+    }
+
+    if (Src != NULL) {
+      FreePages (Src, EFI_SIZE_TO_PAGES (CompHdr->CompressedSize));
+    }
+    if (Dst != NULL) {
+      FreePages (Dst, EFI_SIZE_TO_PAGES (DstSize));
+    }
+    if (Scratch != NULL) {
+      FreePages (Scratch, EFI_SIZE_TO_PAGES (MAX (ScratchSize, 1)));
+    }
+  }
+
+  if (Found == 0) {
+    ShellPrint (L"No component in flash is compressed with %s\n", Group);
+    return EFI_NOT_FOUND;
+  }
+
+  BenchPrintResults (Group);
+  return EFI_SUCCESS;
+}
+
+/**
+  Measure sequential and random reads on the block device initialized
+  by the `fs init` command.
+
+  @param[in]  SizeMb       size of the sequential read in MB
+  @param[in]  HwPart       hardware partition (device index) to read
+
+  @retval EFI_SUCCESS
+  @retval EFI_NOT_READY         No block device is initialized
+  @retval EFI_OUT_OF_RESOURCES  Buffer allocation failed
+
+**/
+STATIC
+EFI_STATUS
+BenchBlk (
+  IN  UINT32   SizeMb,
+  IN  UINT32   HwPart
+  )
+{
+  DEVICE_BLOCK_INFO    BlockInfo;
+  EFI_STATUS           Status;
+  UINT8               *Buffer;
+  UINT64               Blocks;
+  UINT64               Lba;
+  UINT64               Seed;
+  UINT64               Bytes;
+  UINT64               Start;
+  UINT64               Time;
+  UINT32               Index;
+  UINT32               RandomSize;
+
+  Status = MediaGetMediaInfo (HwPart, &BlockInfo);
+  if (EFI_ERROR (Status) || (BlockInfo.BlockSize == 0) || (BlockInfo.BlockNum == 0)) {
+    ShellPrint (L"No block device, run 'fs init' first (%r)\n", Status);
+    return EFI_NOT_READY;
+  }
+
+  Buffer = AllocatePages (EFI_SIZE_TO_PAGES (BENCH_BLK_REQUEST_SIZE));
+  if (Buffer == NULL) {
+    ShellPrint (L"Failed to allocate read buffer!\n");
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ShellPrint (L"%a hwpart %d: %ld blocks of %d bytes\n\n", GetBootDeviceNameString (MediaGetInterfaceType ()),
+              HwPart, BlockInfo.BlockNum, BlockInfo.BlockSize);
+  ShellPrint (L"   Test     |    Bytes    |  Time (us) |   Rate\n");
+  ShellPrint (L"------------+-------------+------------+-----------\n");
+
+  //
+  // Sequential reads of BENCH_BLK_REQUEST_SIZE from LBA 0
+  //
+  Blocks = BENCH_BLK_REQUEST_SIZE / BlockInfo.BlockSize;
+  Bytes  = 0;
+  Lba    = 0;
+  Start  = GetPerformanceCounter ();
+  while ((Bytes < MultU64x32 (SizeMb, SIZE_1MB)) && (Lba + Blocks <= BlockInfo.BlockNum)) {
+    Status = MediaReadBlocks (HwPart, Lba, BENCH_BLK_REQUEST_SIZE, Buffer);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+    Bytes += BENCH_BLK_REQUEST_SIZE;
+    Lba   += Blocks;
+  }
+  Time = BenchElapsedUs (Start);
+  ShellPrint (L" seq %4d KB | %11ld | %10ld | %5ld MB/s\n", BENCH_BLK_REQUEST_SIZE / SIZE_1KB,
+              Bytes, Time, DivU64x64Remainder (Bytes, Time, NULL));
+  BenchRecord (L"seq-read", DivU64x64Remainder (Bytes, Time, NULL), L"MB/s");
+
+  //
+  // Random reads of 4 KB, or one block if larger, spread over the device
+  //
+  RandomSize = MAX (SIZE_4KB, BlockInfo.BlockSize);
+  Blocks     = RandomSize / BlockInfo.BlockSize;
+  if (!EFI_ERROR (Status) && (BlockInfo.BlockNum >= Blocks)) {
+    Seed       = GetPerformanceCounter ();
+    Start      = GetPerformanceCounter ();
+    for (Index = 0; Index < BENCH_BLK_RANDOM_READS; Index++) {
+      Seed   = MultU64x32 (Seed, 1103515245) + 12345;
+      DivU64x64Remainder (RShiftU64 (Seed, 16), DivU64x64Remainder (BlockInfo.BlockNum, Blocks, NULL), &Lba);
+      Lba    = MultU64x32 (Lba, (UINT32)Blocks);
+      Status = MediaReadBlocks (HwPart, Lba, RandomSize, Buffer);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+    Time = BenchElapsedUs (Start);
+    ShellPrint (L" rand %3d KB | %11ld | %10ld | %5ld IOPS\n", RandomSize / SIZE_1KB,
+                MultU64x32 (Index, RandomSize), Time,
+                DivU64x64Remainder (MultU64x32 (1000000, Index), Time, NULL));
+    BenchRecord (L"rand-read", DivU64x64Remainder (MultU64x32 (1000000, Index), Time, NULL), L"IOPS");
+  }
+
+  if (EFI_ERROR (Status)) {
+    ShellPrint (L"Read failed: %r\n", Status);
+  }
+
+  FreePages (Buffer, EFI_SIZE_TO_PAGES (BENCH_BLK_REQUEST_SIZE));
+
+  BenchPrintResults (L"blk");
+  return Status;
+}
+
+/**
+  Run simple throughput benchmarks.
+
+  @param[in]  Shell        shell instance
+  @param[in]  Argc         number of command line arguments
+  @param[in]  Argv         command line arguments
+
+  @retval EFI_SUCCESS
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+ShellCommandBenchFunc (
+  IN SHELL  *Shell,
+  IN UINTN   Argc,
+  IN CHAR16 *Argv[]
+  )
+{
+  CHAR16   *SubCmd;
+  UINTN     Size;
+  UINT32    SizeMb;
+  UINT32    HwPart;
+
+  if (Argc < 2) {
+    goto Usage;
+  }
+
+  SubCmd = Argv[1];
+  Size   = (Argc < 3) ? BENCH_DEFAULT_SIZE_MB : StrDecimalToUintn (Argv[2]);
+  HwPart = (Argc < 4) ? 0 : (UINT32)StrDecimalToUintn (Argv[3]);
+  if ((Size == 0) || (Size > BENCH_MAX_SIZE_MB)) {
+    ShellPrint (L"Size must be 1 to %d MB!\n", (UINT32)BENCH_MAX_SIZE_MB);
+    goto Usage;
+  }
+  SizeMb = (UINT32)Size;
+
+  if (StrCmp (SubCmd, L"mp") == 0) {
+    return BenchMp (SizeMb);
+  } else if (StrCmp (SubCmd, L"scrub") == 0) {
+    return BenchScrub (SizeMb);
+  } else if (StrCmp (SubCmd, L"mem") == 0) {
+    return BenchMem ();
+  } else if (StrCmp (SubCmd, L"hash") == 0) {
+    return BenchHash (SizeMb);
+  } else if (StrCmp (SubCmd, L"rsa") == 0) {
+    return BenchRsa ();
+  } else if (StrCmp (SubCmd, L"lz4") == 0) {
+    return BenchDecompress (LZ4_SIGNATURE, L"lz4");
+  } else if (StrCmp (SubCmd, L"lzma") == 0) {
+    return BenchDecompress (LZMA_SIGNATURE, L"lzma");
+  } else if (StrCmp (SubCmd, L"lzmf") == 0) {
+    return BenchDecompress (LZMF_SIGNATURE, L"lzmf");
+  } else if (StrCmp (SubCmd, L"blk") == 0) {
+    return BenchBlk (SizeMb, HwPart);
+  }
+
+Usage:
+  ShellPrint (L"Usage: %s mp [SizeMB]\n", Argv[0]);
+  ShellPrint (L"       %s scrub [SizeMB]\n", Argv[0]);
+  ShellPrint (L"       %s mem|rsa|lz4|lzma|lzmf\n", Argv[0]);
+  ShellPrint (L"       %s hash [SizeMB]\n", Argv[0]);
+  ShellPrint (L"       %s blk [SizeMB] [HwPart]\n", Argv[0]);
+  ShellPrint (L"\nmp    - Fill and CRC32 a buffer with 1, 2, 4 ... CPUs of the task pool\n");
+  ShellPrint (L"scrub - Zero a dirty buffer on all CPUs with non-temporal stores and verify it\n");
+  ShellPrint (L"mem   - CopyMem/SetMem throughput with hot and cold caches\n");
+  ShellPrint (L"hash  - SHA-256, SHA-384 and SM3 throughput\n");
+  ShellPrint (L"rsa   - RSA 2048/3072 signature verifications per second\n");
+  ShellPrint (L"lz4   - Decompression speed of the LZ4 components in flash\n");
+  ShellPrint (L"lzma  - Decompression speed of the LZMA components in flash\n");
+  ShellPrint (L"lzmf  - Decompression speed of the LZMA+BCJ components in flash\n");
+  ShellPrint (L"blk   - Sequential and random reads on the device set up by 'fs init'\n");
+
+  return EFI_ABORTED;
+}
@@ -282,6 +282,44 @@ CmdFsInfo (
   return EFI_SUCCESS;
 }
 
+/**
+  Display media block cache statistics of the current device
+
+  @retval EFI_SUCCESS
+  @retval Others      Cache statistics are not available
+
+**/
+STATIC
+EFI_STATUS
+CmdFsCache (
+  IN  VOID
+  )
+{
+  EFI_STATUS            Status;
+  MEDIA_CACHE_STATS     Stats;
+  UINTN                 Index;
+
+  ShellPrint (L" Part | Requests |   Hits   |  Misses  | Bypass | Hit%% | Dev Reads | Req Bytes  | Dev Bytes\n");
+  ShellPrint (L"------+----------+----------+----------+--------+------+-----------+------------+-----------\n");
+  for (Index = 0; Index < MEDIA_CACHE_MAX_DEVICES; Index++) {
+    Status = MediaGetCacheStats (Index, &Stats);
+    if (EFI_ERROR (Status)) {
+      ShellPrint (L"Media cache statistics are not available (%r)\n", Status);
+      return Status;
+    }
+    if (Stats.Requests == 0) {
+      continue;
+    }
+    ShellPrint (L" %4d | %8ld | %8ld | %8ld | %6ld | %3d%% | %9ld | 0x%08lx | 0x%08lx\n",
+                Index, Stats.Requests, Stats.Hits, Stats.Misses, Stats.Bypassed,
+                (Stats.Hits + Stats.Misses == 0) ? 0 :
+                (UINT32)DivU64x64Remainder (MultU64x32 (Stats.Hits, 100), Stats.Hits + Stats.Misses, NULL),
+                Stats.DeviceReads, Stats.RequestBytes, Stats.DeviceBytes);
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Basic file system test commands
 
@@ -345,6 +383,8 @@ ShellCommandFsFunc (
     Status = CmdFsFsListDir ((Argc < 3) ? L"/" : Argv[2]);
   } else if (StrCmp (SubCmd, L"info") == 0) {
     Status = CmdFsInfo ();
+  } else if (StrCmp (SubCmd, L"cache") == 0) {
+    Status = CmdFsCache ();
   } else {
     goto Usage;
   }
@@ -354,6 +394,7 @@ Usage:
   ShellPrint (L"Usage: %s init [DevType[:DevInstance]] [HwPart] [SwPart]\n", Argv[0]);
   ShellPrint (L"       %s close\n", Argv[0]);
   ShellPrint (L"       %s info\n", Argv[0]);
+  ShellPrint (L"       %s cache\n", Argv[0]);
   ShellPrint (L"       %s ls [dir or file path]\n", Argv[0]);
 
   ShellPrint (L"\nDevType:DevInstance - Media type and instance number in the same media type\n");
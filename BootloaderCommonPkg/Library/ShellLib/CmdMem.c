@@ -0,0 +1,105 @@
+/** @file
+  Shell command `mem` to display pool allocator statistics.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/ShellLib.h>
+#include <Library/BlMemoryAllocationLib.h>
+#include <Library/DebugLib.h>
+
+/**
+  Display pool allocator statistics.
+
+  @param[in]  Shell        shell instance
+  @param[in]  Argc         number of command line arguments
+  @param[in]  Argv         command line arguments
+
+  @retval EFI_SUCCESS
+  @retval EFI_UNSUPPORTED  The memory allocator does not provide statistics
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+ShellCommandMemFunc (
+  IN SHELL  *Shell,
+  IN UINTN   Argc,
+  IN CHAR16 *Argv[]
+  );
+
+CONST SHELL_COMMAND ShellCommandMem = {
+  L"mem",
+  L"Display pool allocator statistics",
+  &ShellCommandMemFunc
+};
+
+/**
+  Display pool allocator statistics.
+
+  @param[in]  Shell        shell instance
+  @param[in]  Argc         number of command line arguments
+  @param[in]  Argv         command line arguments
+
+  @retval EFI_SUCCESS
+  @retval EFI_UNSUPPORTED  The memory allocator does not provide statistics
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+ShellCommandMemFunc (
+  IN SHELL  *Shell,
+  IN UINTN   Argc,
+  IN CHAR16 *Argv[]
+  )
+{
+  EFI_STATUS               Status;
+  MEMORY_POOL_STATS        Stats;
+  MEMORY_POOL_CLASS_STATS  *Class;
+  UINT32                   Index;
+  UINT64                   Used;
+  UINT64                   Total;
+  UINT64                   Requested;
+  UINT64                   Hits;
+  UINT64                   Misses;
+
+  Status = GetMemoryPoolStats (&Stats);
+  if (EFI_ERROR (Status)) {
+    ShellPrint (L"Pool statistics are not available!\n");
+    return Status;
+  }
+
+  Used      = 0;
+  Total     = 0;
+  Requested = 0;
+  Hits      = 0;
+  Misses    = 0;
+
+  ShellPrint (L" Slot | Slabs | In Use |  Free  |    Hits    |  Misses  | Waste\n");
+  ShellPrint (L"------+-------+--------+--------+------------+----------+------\n");
+  for (Index = 0; Index < Stats.ClassCount; Index++) {
+    Class = &Stats.Class[Index];
+    ShellPrint (L" %4d | %5d | %6d | %6d | %10ld | %8ld | %3d%%\n",
+                Class->SlotSize, Class->Slabs, Class->InUse, Class->Free, Class->Hits, Class->Misses,
+                (Class->InUse == 0) ? 0 :
+                (UINT32)DivU64x64Remainder (MultU64x32 ((UINT64)Class->InUse * Class->MaxSize - Class->Requested, 100),
+                                            (UINT64)Class->InUse * Class->MaxSize, NULL));
+    Used      += MultU64x32 (Class->InUse, Class->SlotSize);
+    Total     += MultU64x32 (Class->Slabs, Stats.SlabSize);
+    Requested += Class->Requested;
+    Hits      += Class->Hits;
+    Misses    += Class->Misses;
+  }
+
+  ShellPrint (L"\nSlab memory : 0x%lx bytes in use by slots, 0x%lx bytes reserved\n", Used, Total);
+  ShellPrint (L"Requested   : 0x%lx bytes\n", Requested);
+  ShellPrint (L"Hit rate    : %d%%\n",
+              (Hits + Misses == 0) ? 0 : (UINT32)DivU64x64Remainder (MultU64x32 (Hits, 100), Hits + Misses, NULL));
+  ShellPrint (L"Fragmented  : %d%%\n",
+              (Total == 0) ? 0 : (UINT32)DivU64x64Remainder (MultU64x32 (Total - Requested, 100), Total, NULL));
+
+  return EFI_SUCCESS;
+}
@@ -41,6 +41,7 @@ LoadShellCommands (
     ShellCommandRegister (Shell, &ShellCommandPci);
     ShellCommandRegister (Shell, &ShellCommandHob);
     ShellCommandRegister (Shell, &ShellCommandMmap);
+    ShellCommandRegister (Shell, &ShellCommandMem);
     ShellCommandRegister (Shell, &ShellCommandPerf);
     ShellCommandRegister (Shell, &ShellCommandBoot);
     ShellCommandRegister (Shell, &ShellCommandMmcDll);
@@ -48,6 +49,7 @@ LoadShellCommands (
     ShellCommandRegister (Shell, &ShellCommandDmesg);
     ShellCommandRegister (Shell, &ShellCommandReset);
     ShellCommandRegister (Shell, &ShellCommandFs);
+    ShellCommandRegister (Shell, &ShellCommandBench);
 
     // Load Platform specific shell commands
     ShellExtensionCmds = GetShellExtensionCmds ();
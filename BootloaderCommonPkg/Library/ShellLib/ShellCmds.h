@@ -15,6 +15,7 @@ extern CONST SHELL_COMMAND ShellCommandHelp;
 extern CONST SHELL_COMMAND ShellCommandHob;
 extern CONST SHELL_COMMAND ShellCommandMm;
 extern CONST SHELL_COMMAND ShellCommandMmap;
+extern CONST SHELL_COMMAND ShellCommandMem;
 extern CONST SHELL_COMMAND ShellCommandPerf;
 extern CONST SHELL_COMMAND ShellCommandBoot;
 extern CONST SHELL_COMMAND ShellCommandMmcDll;
@@ -28,6 +29,7 @@ extern CONST SHELL_COMMAND ShellCommandReset;
 extern CONST SHELL_COMMAND ShellCommandUcode;
 extern CONST SHELL_COMMAND ShellCommandCls;
 extern CONST SHELL_COMMAND ShellCommandFs;
+extern CONST SHELL_COMMAND ShellCommandBench;
 
 /**
   Load shell commands.
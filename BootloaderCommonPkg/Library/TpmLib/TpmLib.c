@@ -536,6 +536,8 @@ MeasureSeparatorEvent (
     return RETURN_DEVICE_ERROR;
   }
 
+  TpmFlushPendingExtends ();
+
   PcrHandle = 0;
   Data = WithError;
   Digests = &PcrEventHdr.Digests;
@@ -627,6 +629,8 @@ IN  CONST  UINT8                     *Event
     return RETURN_DEVICE_ERROR;
   }
 
+  TpmFlushPendingExtends ();
+
   Digests = &PcrEventHdr.Digests;
   Digests->count = 0;
 
@@ -673,9 +677,78 @@ IN  CONST  UINT8                     *Event
 }
 
 
+/**
+  Send all queued PCR extends to the TPM and log their events.
+
+  TpmExtendPcrAndLogEvent() may queue the PCR extend together with its
+  event. The event is logged only once its extend succeeded, so the TCG
+  event log always matches the PCR values. This function must be called
+  before PCR values are consumed, e.g. before handing off to a payload
+  that is not aware of the queue.
+
+  @retval RETURN_SUCCESS      All queued extends completed, or none were queued.
+  @retval Others              At least one queued extend failed.
+**/
+RETURN_STATUS
+TpmFlushPendingExtends (
+  VOID
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_STATUS                 ExtendStatus;
+  TPM_LIB_PRIVATE_DATA      *PrivateData;
+  TPM_PENDING_EXTEND        *Pending;
+  TCG_PCR_EVENT2_HDR         PcrEventHdr;
+  UINT32                     Index;
+
+  PrivateData = TpmLibGetPrivateData ();
+  if ((PrivateData == NULL) || (PrivateData->PendingCount == 0)) {
+    return RETURN_SUCCESS;
+  }
+
+  Status = EFI_SUCCESS;
+  if (PrivateData->TpmReady) {
+    //
+    // Extends are sent in the order they were queued so the final PCR values
+    // match a replay of the event log.
+    //
+    for (Index = 0; Index < PrivateData->PendingCount; Index++) {
+      Pending = &PrivateData->Pending[Index];
+      PcrEventHdr.Digests.count = 1;
+      PcrEventHdr.Digests.digests[0].hashAlg = Pending->HashAlg;
+      CopyMem (&PcrEventHdr.Digests.digests[0].digest, Pending->Digest, GetHashSizeFromAlgo (Pending->HashAlg));
+
+      ExtendStatus = Tpm2PcrExtend (Pending->PcrHandle, &PcrEventHdr.Digests);
+      if (EFI_ERROR (ExtendStatus)) {
+        DEBUG ((DEBUG_ERROR, "PCR (%u) deferred extend FAIL with error (0x%8x) .\n",
+          Pending->PcrHandle, ExtendStatus));
+        Status = ExtendStatus;
+        continue;
+      }
+
+      PcrEventHdr.PCRIndex  = Pending->PcrHandle;
+      PcrEventHdr.EventType = Pending->EventType;
+      PcrEventHdr.EventSize = Pending->EventSize;
+      TpmLogEvent (&PcrEventHdr, Pending->Event);
+    }
+  } else {
+    DEBUG ((DEBUG_ERROR, "TPM not ready, %u deferred PCR extends dropped.\n", PrivateData->PendingCount));
+    Status = EFI_NOT_READY;
+  }
+
+  PrivateData->PendingCount = 0;
+  return Status;
+}
+
+
 /**
   Extend a PCR and log it into TCG event log.
 
+  The PCR extend and its event are queued, and TpmFlushPendingExtends(),
+  which runs before any other TPM measurement and before handing off to
+  the payload or OS, sends the extend and then logs the event. Events too
+  large for the queue are extended and logged right away.
+
   @param[in] PcrHandle    PCR index to extend.
   @param[in] HashAlg      Hash algorithm for Hash data.
   @param[in] Hash         Hash data to be extended.
@@ -699,6 +772,9 @@ TpmExtendPcrAndLogEvent (
   EFI_STATUS                 Status;
   TCG_PCR_EVENT2_HDR         PcrEventHdr;
   TPML_DIGEST_VALUES        *Digests;
+  TPM_LIB_PRIVATE_DATA      *PrivateData;
+  TPM_PENDING_EXTEND        *Pending;
+  UINT16                     DigestSize;
 
   if (Hash == NULL || Event == NULL) {
     return RETURN_INVALID_PARAMETER;
@@ -708,11 +784,41 @@ TpmExtendPcrAndLogEvent (
     return RETURN_DEVICE_ERROR;
   }
 
+  DigestSize = GetHashSizeFromAlgo (HashAlg);
+  if ((DigestSize == 0) || (DigestSize > SHA512_DIGEST_SIZE)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
   Digests = &PcrEventHdr.Digests;
   Digests->count = 1;
   Digests->digests[0].hashAlg = HashAlg;
 
-  CopyMem (& (Digests->digests[0].digest), Hash, GetHashSizeFromAlgo (HashAlg));
+  CopyMem (& (Digests->digests[0].digest), Hash, DigestSize);
+
+  PrivateData = TpmLibGetPrivateData ();
+  if (PrivateData == NULL) {
+    return RETURN_DEVICE_ERROR;
+  }
+
+  if (EventSize <= TPM_PENDING_EVENT_MAX) {
+    if (PrivateData->PendingCount >= TPM_PENDING_EXTEND_MAX) {
+      TpmFlushPendingExtends ();
+    }
+
+    Pending = &PrivateData->Pending[PrivateData->PendingCount++];
+    Pending->PcrHandle = PcrHandle;
+    Pending->HashAlg   = HashAlg;
+    Pending->EventType = EventType;
+    Pending->EventSize = EventSize;
+    CopyMem (Pending->Digest, Hash, DigestSize);
+    CopyMem (Pending->Event, Event, EventSize);
+    DEBUG ((DEBUG_INFO, "PCR (%u) extend queued with (%u) event type.\n",
+            PcrHandle, EventType));
+    return RETURN_SUCCESS;
+  }
+
+  // Keep the log in extend order
+  TpmFlushPendingExtends ();
 
   Status = Tpm2PcrExtend (PcrHandle, Digests);
   if (Status == EFI_SUCCESS) {
@@ -854,6 +960,10 @@ TpmIndicateReadyToBoot (
 
   Status = EFI_SUCCESS;
 
+  if (TpmFlushPendingExtends () != EFI_SUCCESS) {
+    DEBUG ((DEBUG_ERROR, "FAILED to flush deferred PCR extends.\n"));
+    Status =  EFI_DEVICE_ERROR;
+  }
   if (MeasureLaunchOfFirmwareDebugger (FwDebugEnabled) != EFI_SUCCESS) {
     DEBUG ((DEBUG_ERROR, "FAILED to measure firmware debugger.\n"));
     Status =  EFI_DEVICE_ERROR;
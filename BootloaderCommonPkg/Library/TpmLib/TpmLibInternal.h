@@ -8,12 +8,36 @@
 #ifndef _TPM_LIB_INTERNAL_H_
 #define _TPM_LIB_INTERNAL_H_
 
+#include <IndustryStandard/Tpm20.h>
+
+//
+// Number of PCR extends that can be queued before they are sent to the TPM
+//
+#define TPM_PENDING_EXTEND_MAX   8
+
+//
+// Largest event data kept with a queued extend, larger events are
+// extended and logged right away
+//
+#define TPM_PENDING_EVENT_MAX    32
+
+typedef struct {
+  UINT32 PcrHandle;
+  UINT16 HashAlg;
+  UINT8  Digest[SHA512_DIGEST_SIZE];
+  UINT32 EventType;
+  UINT32 EventSize;
+  UINT8  Event[TPM_PENDING_EVENT_MAX];
+} TPM_PENDING_EXTEND;
+
 typedef struct {
   UINT8  TpmReady;
   UINT32 ActivePcrBanks;
   UINT64 LogAreaStartAddress;
   UINT32 LogAreaMinLength;
 
+  UINT32             PendingCount;
+  TPM_PENDING_EXTEND Pending[TPM_PENDING_EXTEND_MAX];
 } TPM_LIB_PRIVATE_DATA;
 
 
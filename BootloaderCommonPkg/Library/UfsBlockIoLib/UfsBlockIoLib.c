@@ -11,6 +11,24 @@
 
 #define MSG_UFS_DP                0x19
 
+//
+// Data length of a single READ command queued by UfsReadBlocks ()
+//
+#define UFS_READ_TRANSFER_SIZE    SIZE_64KB
+
+//
+// Per slot packets of a queued read, see UfsReadQueued ()
+//
+typedef struct {
+  UFS_SCSI_REQUEST_PACKET         Packet[UFS_MAX_TRL_SLOTS];
+  UINT8                           Cdb[UFS_MAX_TRL_SLOTS][UFS_SCSI_OP_LENGTH_SIXTEEN];
+  EFI_LBA                         StartLba;
+  UINT8                           *Buffer;
+  UINTN                           BufferSize;
+  UINT32                          BlockSize;
+  BOOLEAN                         Read16;
+} UFS_READ_QUEUE;
+
 //
 // Template for UFS HC Peim Private Data.
 //
@@ -90,6 +108,7 @@ UFS_PEIM_HC_PRIVATE_DATA   gUfsHcTemplate = {
   0,                              // TaskTag
   0,                              // UtpTrlBase
   0,                              // Nutrs
+  0,                              // SlotBitmap
   NULL,                           // TrlMapping
   0,                              // UtpTmrlBase
   0,                              // Nutmrs
@@ -389,68 +408,6 @@ UfsReadCapacity16 (
   return Status;
 }
 
-/**
-  Execute READ (10) SCSI command on a specific UFS device.
-
-  @param[in]  Private              A pointer to UFS_PEIM_HC_PRIVATE_DATA data structure.
-  @param[in]  Lun                  The lun on which the SCSI cmd executed.
-  @param[in]  StartLba             The start LBA.
-  @param[in]  SectorNum            The sector number to be read.
-  @param[out] DataBuffer           A pointer to data buffer.
-  @param[out] DataLength           The length of output data.
-  @param[out] SenseData            A pointer to output sense data.
-  @param[out] SenseDataLength      The length of output sense data.
-
-  @retval EFI_SUCCESS              The command executed successfully.
-  @retval EFI_DEVICE_ERROR         A device error occurred while attempting to send SCSI Request Packet.
-  @retval EFI_TIMEOUT              A timeout occurred while waiting for the SCSI Request Packet to execute.
-
-**/
-EFI_STATUS
-UfsRead10 (
-  IN     UFS_PEIM_HC_PRIVATE_DATA     *Private,
-  IN     UINTN                        Lun,
-  IN     UINTN                        StartLba,
-  IN     UINT32                       SectorNum,
-  OUT VOID                         *DataBuffer,
-  OUT UINT32                       *DataLength,
-  OUT VOID                         *SenseData,  OPTIONAL
-  OUT UINT8                        *SenseDataLength
-  )
-{
-  UFS_SCSI_REQUEST_PACKET             Packet;
-  UINT8                               Cdb[UFS_SCSI_OP_LENGTH_TEN];
-  EFI_STATUS                          Status;
-
-  ZeroMem (&Packet, sizeof (UFS_SCSI_REQUEST_PACKET));
-  ZeroMem (Cdb, sizeof (Cdb));
-
-  Cdb[0] = EFI_SCSI_OP_READ10;
-  WriteUnaligned32 ((UINT32 *)&Cdb[2], SwapBytes32 ((UINT32) StartLba));
-  WriteUnaligned16 ((UINT16 *)&Cdb[7], SwapBytes16 ((UINT16) SectorNum));
-
-  Packet.Timeout          = UFS_TIMEOUT;
-  Packet.Cdb              = Cdb;
-  Packet.CdbLength        = sizeof (Cdb);
-  Packet.InDataBuffer     = DataBuffer;
-  Packet.InTransferLength = *DataLength;
-  Packet.DataDirection    = UfsDataIn;
-  Packet.SenseData        = SenseData;
-  Packet.SenseDataLength  = *SenseDataLength;
-
-  Status = UfsExecScsiCmds (Private, (UINT8)Lun, &Packet);
-
-  if (*SenseDataLength != 0) {
-    *SenseDataLength = Packet.SenseDataLength;
-  }
-
-  if (!EFI_ERROR (Status)) {
-    *DataLength = Packet.InTransferLength;
-  }
-
-  return Status;
-}
-
 /**
   Execute WRITE (10) SCSI command on a specific UFS device.
 
@@ -513,68 +470,6 @@ UfsWrite10 (
   return Status;
 }
 
-/**
-  Execute READ (16) SCSI command on a specific UFS device.
-
-  @param[in]  Private              A pointer to UFS_PEIM_HC_PRIVATE_DATA data structure.
-  @param[in]  Lun                  The lun on which the SCSI cmd executed.
-  @param[in]  StartLba             The start LBA.
-  @param[in]  SectorNum            The sector number to be read.
-  @param[out] DataBuffer           A pointer to data buffer.
-  @param[out] DataLength           The length of output data.
-  @param[out] SenseData            A pointer to output sense data.
-  @param[out] SenseDataLength      The length of output sense data.
-
-  @retval EFI_SUCCESS              The command executed successfully.
-  @retval EFI_DEVICE_ERROR         A device error occurred while attempting to send SCSI Request Packet.
-  @retval EFI_TIMEOUT              A timeout occurred while waiting for the SCSI Request Packet to execute.
-
-**/
-EFI_STATUS
-UfsRead16 (
-  IN     UFS_PEIM_HC_PRIVATE_DATA     *Private,
-  IN     UINTN                        Lun,
-  IN     UINTN                        StartLba,
-  IN     UINT32                       SectorNum,
-  OUT VOID                         *DataBuffer,
-  OUT UINT32                       *DataLength,
-  OUT VOID                         *SenseData,  OPTIONAL
-  OUT UINT8                        *SenseDataLength
-  )
-{
-  UFS_SCSI_REQUEST_PACKET             Packet;
-  UINT8                               Cdb[UFS_SCSI_OP_LENGTH_SIXTEEN];
-  EFI_STATUS                          Status;
-
-  ZeroMem (&Packet, sizeof (UFS_SCSI_REQUEST_PACKET));
-  ZeroMem (Cdb, sizeof (Cdb));
-
-  Cdb[0] = EFI_SCSI_OP_READ16;
-  WriteUnaligned64 ((UINT64 *)&Cdb[2], SwapBytes64 (StartLba));
-  WriteUnaligned32 ((UINT32 *)&Cdb[10], SwapBytes32 (SectorNum));
-
-  Packet.Timeout          = UFS_TIMEOUT;
-  Packet.Cdb              = Cdb;
-  Packet.CdbLength        = sizeof (Cdb);
-  Packet.InDataBuffer     = DataBuffer;
-  Packet.InTransferLength = *DataLength;
-  Packet.DataDirection    = UfsDataIn;
-  Packet.SenseData        = SenseData;
-  Packet.SenseDataLength  = *SenseDataLength;
-
-  Status = UfsExecScsiCmds (Private, (UINT8)Lun, &Packet);
-
-  if (*SenseDataLength != 0) {
-    *SenseDataLength = Packet.SenseDataLength;
-  }
-
-  if (!EFI_ERROR (Status)) {
-    *DataLength = Packet.InTransferLength;
-  }
-
-  return Status;
-}
-
 /**
   Execute WRITE (16) SCSI command on a specific UFS device.
 
@@ -886,6 +781,101 @@ Done:
   return Status;
 }
 
+/**
+  Build the READ (10) or READ (16) command of one queued read request.
+
+  @param[in]  Context              A pointer to the UFS_READ_QUEUE of the read.
+  @param[in]  Index                The index of the request.
+  @param[in]  Slot                 The transfer request slot the request is placed in.
+
+  @retval                          A pointer to the SCSI Request Packet of the request.
+
+**/
+STATIC
+UFS_SCSI_REQUEST_PACKET *
+UfsGetReadPacket (
+  IN  VOID                         *Context,
+  IN  UINTN                        Index,
+  IN  UINT8                        Slot
+  )
+{
+  UFS_READ_QUEUE                   *Queue;
+  UFS_SCSI_REQUEST_PACKET          *Packet;
+  UINT8                            *Cdb;
+  EFI_LBA                          Lba;
+  UINTN                            Offset;
+  UINT32                           Length;
+
+  Queue  = (UFS_READ_QUEUE *)Context;
+  Packet = &Queue->Packet[Slot];
+  Cdb    = Queue->Cdb[Slot];
+  Offset = Index * UFS_READ_TRANSFER_SIZE;
+  Length = (UINT32)MIN (Queue->BufferSize - Offset, UFS_READ_TRANSFER_SIZE);
+  Lba    = Queue->StartLba + Offset / Queue->BlockSize;
+
+  ZeroMem (Packet, sizeof (UFS_SCSI_REQUEST_PACKET));
+  ZeroMem (Cdb, UFS_SCSI_OP_LENGTH_SIXTEEN);
+  if (!Queue->Read16) {
+    Cdb[0] = EFI_SCSI_OP_READ10;
+    WriteUnaligned32 ((UINT32 *)&Cdb[2], SwapBytes32 ((UINT32) Lba));
+    WriteUnaligned16 ((UINT16 *)&Cdb[7], SwapBytes16 ((UINT16) (Length / Queue->BlockSize)));
+    Packet->CdbLength = UFS_SCSI_OP_LENGTH_TEN;
+  } else {
+    Cdb[0] = EFI_SCSI_OP_READ16;
+    WriteUnaligned64 ((UINT64 *)&Cdb[2], SwapBytes64 (Lba));
+    WriteUnaligned32 ((UINT32 *)&Cdb[10], SwapBytes32 (Length / Queue->BlockSize));
+    Packet->CdbLength = UFS_SCSI_OP_LENGTH_SIXTEEN;
+  }
+
+  Packet->Timeout          = UFS_TIMEOUT;
+  Packet->Cdb              = Cdb;
+  Packet->InDataBuffer     = Queue->Buffer + Offset;
+  Packet->InTransferLength = Length;
+  Packet->DataDirection    = UfsDataIn;
+
+  return Packet;
+}
+
+/**
+  Read blocks from a specific UFS device using the UTP transfer request list as a queue.
+
+  The request is split into READ (10) or READ (16) commands of UFS_READ_TRANSFER_SIZE
+  bytes. Every transfer request slot that completes is refilled with the next command
+  right away, so the device always has as many commands to work on as there are slots.
+
+  @param[in]  Private              A pointer to UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]  Lun                  The lun on which the SCSI cmds are executed.
+  @param[in]  StartLba             The start LBA.
+  @param[in]  BufferSize           The size of the Buffer in bytes.
+  @param[out] Buffer               A pointer to data buffer.
+
+  @retval EFI_SUCCESS              The commands executed successfully.
+  @retval EFI_DEVICE_ERROR         A device error occurred while attempting to send SCSI Request Packet.
+  @retval EFI_TIMEOUT              A timeout occurred while waiting for the SCSI Request Packet to execute.
+
+**/
+STATIC
+EFI_STATUS
+UfsReadQueued (
+  IN  UFS_PEIM_HC_PRIVATE_DATA     *Private,
+  IN  UINTN                        Lun,
+  IN  EFI_LBA                      StartLba,
+  IN  UINTN                        BufferSize,
+  OUT VOID                         *Buffer
+  )
+{
+  UFS_READ_QUEUE                      Queue;
+
+  Queue.StartLba   = StartLba;
+  Queue.Buffer     = (UINT8 *)Buffer;
+  Queue.BufferSize = BufferSize;
+  Queue.BlockSize  = Private->Media[Lun].BlockSize;
+  Queue.Read16     = (BOOLEAN)(Private->Media[Lun].LastBlock >= 0xfffffffful);
+
+  return UfsExecScsiCmdQueue (Private, (UINT8)Lun, UfsGetReadPacket, &Queue,
+                              (BufferSize + UFS_READ_TRANSFER_SIZE - 1) / UFS_READ_TRANSFER_SIZE);
+}
+
 /**
   Reads the requested number of blocks from the specified block device.
 
@@ -927,7 +917,6 @@ UfsReadBlocksInternal (
 {
   EFI_STATUS                         Status;
   UINTN                              BlockSize;
-  UINTN                              NumberOfBlocks;
   UFS_PEIM_HC_PRIVATE_DATA           *Private;
   EFI_SCSI_SENSE_DATA                SenseData;
   UINT8                              SenseDataLength;
@@ -973,8 +962,6 @@ UfsReadBlocksInternal (
     Status = EFI_INVALID_PARAMETER;
   }
 
-  NumberOfBlocks = BufferSize / BlockSize;
-
   do {
     Status = UfsTestUnitReady (
                Private,
@@ -997,31 +984,7 @@ UfsReadBlocksInternal (
 
   } while (NeedRetry);
 
-  SenseDataLength = 0;
-  if (Private->Media[DeviceIndex].LastBlock < 0xfffffffful) {
-    Status = UfsRead10 (
-               Private,
-               DeviceIndex,
-               (UINT32)StartLBA,
-               (UINT32)NumberOfBlocks,
-               Buffer,
-               (UINT32 *)&BufferSize,
-               NULL,
-               &SenseDataLength
-               );
-  } else {
-    Status = UfsRead16 (
-               Private,
-               DeviceIndex,
-               (UINT32)StartLBA,
-               (UINT32)NumberOfBlocks,
-               Buffer,
-               (UINT32 *)&BufferSize,
-               NULL,
-               &SenseDataLength
-               );
-  }
-  return Status;
+  return UfsReadQueued (Private, DeviceIndex, StartLBA, BufferSize, Buffer);
 }
 
 
@@ -1066,27 +1029,10 @@ UfsReadBlocks (
   )
 {
   EFI_STATUS                         Status;
-  UINT32                             ReadSize;
-  UINT32                             ReadBlockSize;
-  EFI_LBA                            LbaAddress;
-
-  Status     = EFI_SUCCESS;
-  ReadSize   = 0;
-  LbaAddress = StartLba;
-  while (ReadSize < BufferSize) {
-    if (ReadSize + SIZE_64KB > BufferSize) {
-      ReadBlockSize = (UINT32)BufferSize - ReadSize;
-    } else {
-      ReadBlockSize = SIZE_64KB;
-    }
 
-    Status = UfsReadBlocksInternal (DeviceIndex, LbaAddress, ReadBlockSize, (UINT8 *)Buffer + ReadSize);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_INFO, "    UfsReadBlocks_internal: Status = %r\n", Status));
-      break;
-    }
-    ReadSize   += ReadBlockSize;
-    LbaAddress += ReadBlockSize / SIZE_4KB;
+  Status = UfsReadBlocksInternal (DeviceIndex, StartLba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "    UfsReadBlocks_internal: Status = %r\n", Status));
   }
 
   return Status;
@@ -478,6 +478,10 @@ UfsCreateScsiCommandDesc (
   TotalLen    = ROUNDUP8 (sizeof (UTP_COMMAND_UPIU)) + ROUNDUP8 (sizeof (UTP_RESPONSE_UPIU)) + PrdtNumber * sizeof (UTP_TR_PRD);
   CommandDesc = UfsAllocateMem (Private->Pool, TotalLen);
   if (CommandDesc == NULL) {
+    if (*BufferMap != NULL) {
+      IoMmuUnmap (*BufferMap);
+      *BufferMap = NULL;
+    }
     return EFI_OUT_OF_RESOURCES;
   }
 
@@ -665,10 +669,15 @@ UfsCreateNopCommandDesc (
 /**
   Find out available slot in transfer list of a UFS device.
 
+  The lowest slot that is neither owned by a pending request nor still set in
+  the doorbell register is claimed. It must be given back with
+  UfsReleaseSlotInTrl () once the request has completed.
+
   @param[in]  Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
   @param[out] Slot          The available slot.
 
   @retval EFI_SUCCESS       The available slot was found successfully.
+  @retval EFI_NOT_READY     All slots of the transfer request list are in use.
 
 **/
 EFI_STATUS
@@ -677,30 +686,50 @@ UfsFindAvailableSlotInTrl (
   OUT UINT8                        *Slot
   )
 {
+  UINT32        Busy;
+  UINT8         Index;
+
   ASSERT ((Private != NULL) && (Slot != NULL));
 
-  //
-  // The simplest algo to always use slot 0.
-  // TODO: enhance it to support async transfer with multiple slot.
-  //
-  *Slot = 0;
+  Busy = Private->SlotBitmap | MmioRead32 (Private->UfsHcBase + UFS_HC_UTRLDBR_OFFSET);
+  for (Index = 0; Index < Private->Nutrs; Index++) {
+    if ((Busy & UFS_TRL_SLOT_BIT (Index)) == 0) {
+      Private->SlotBitmap |= UFS_TRL_SLOT_BIT (Index);
+      *Slot = Index;
+      return EFI_SUCCESS;
+    }
+  }
 
-  return EFI_SUCCESS;
+  return EFI_NOT_READY;
 }
 
+/**
+  Release a slot claimed by UfsFindAvailableSlotInTrl ().
 
+  @param[in]  Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]  Slot          The slot to be released.
+
+**/
+VOID
+UfsReleaseSlotInTrl (
+  IN  UFS_PEIM_HC_PRIVATE_DATA     *Private,
+  IN  UINT8                        Slot
+  )
+{
+  Private->SlotBitmap &= ~UFS_TRL_SLOT_BIT (Slot);
+}
 
 /**
-  Start specified slot in transfer list of a UFS device.
+  Ring the doorbell for a set of slots in transfer list of a UFS device.
 
   @param[in]  Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
-  @param[in]  Slot          The slot to be started.
+  @param[in]  SlotMask      The bit mask of the slots to be started.
 
 **/
 VOID
-UfsStartExecCmd (
+UfsStartExecCmds (
   IN  UFS_PEIM_HC_PRIVATE_DATA     *Private,
-  IN  UINT8                        Slot
+  IN  UINT32                       SlotMask
   )
 {
   UINTN         UfsHcBase;
@@ -715,8 +744,29 @@ UfsStartExecCmd (
     MmioWrite32 (Address, UFS_HC_UTRLRSR);
   }
 
+  //
+  // Writing 0 to a doorbell bit has no effect, so requests that are already
+  // in flight are not disturbed.
+  //
   Address = UfsHcBase + UFS_HC_UTRLDBR_OFFSET;
-  MmioWrite32 (Address, BIT0 << Slot);
+  MmioWrite32 (Address, SlotMask);
+}
+
+
+/**
+  Start specified slot in transfer list of a UFS device.
+
+  @param[in]  Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]  Slot          The slot to be started.
+
+**/
+VOID
+UfsStartExecCmd (
+  IN  UFS_PEIM_HC_PRIVATE_DATA     *Private,
+  IN  UINT8                        Slot
+  )
+{
+  UfsStartExecCmds (Private, UFS_TRL_SLOT_BIT (Slot));
 }
 
 /**
@@ -816,6 +866,7 @@ UfsRwDeviceDesc (
   //
   Status = UfsCreateDMCommandDesc (Private, &Packet, Trd);
   if (EFI_ERROR (Status)) {
+    UfsReleaseSlotInTrl (Private, Slot);
     return Status;
   }
 
@@ -870,6 +921,7 @@ UfsRwDeviceDesc (
 
 Exit:
   UfsStopExecCmd (Private, Slot);
+  UfsReleaseSlotInTrl (Private, Slot);
   UfsFreeMem (Private->Pool, CmdDescBase, CmdDescSize);
 
   return Status;
@@ -946,6 +998,7 @@ UfsRwFlags (
   Trd    = ((UTP_TRD *)Private->UtpTrlBase) + Slot;
   Status = UfsCreateDMCommandDesc (Private, &Packet, Trd);
   if (EFI_ERROR (Status)) {
+    UfsReleaseSlotInTrl (Private, Slot);
     return Status;
   }
 
@@ -987,6 +1040,7 @@ UfsRwFlags (
 
 Exit:
   UfsStopExecCmd (Private, Slot);
+  UfsReleaseSlotInTrl (Private, Slot);
   UfsFreeMem (Private->Pool, CmdDescBase, CmdDescSize);
 
   return Status;
@@ -1057,6 +1111,7 @@ UfsExecNopCmds (
   Trd    = ((UTP_TRD *)Private->UtpTrlBase) + Slot;
   Status = UfsCreateNopCommandDesc (Private, Trd);
   if (EFI_ERROR (Status)) {
+    UfsReleaseSlotInTrl (Private, Slot);
     return Status;
   }
 
@@ -1089,88 +1144,38 @@ UfsExecNopCmds (
 
 Exit:
   UfsStopExecCmd (Private, Slot);
+  UfsReleaseSlotInTrl (Private, Slot);
   UfsFreeMem (Private->Pool, CmdDescBase, CmdDescSize);
 
   return Status;
 }
 
 /**
-  Sends a UFS-supported SCSI Request Packet to a UFS device that is attached to the UFS host controller.
+  Check the result of a completed SCSI request and update the packet accordingly.
 
-  @param[in]      Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
-  @param[in]      Lun           The LUN of the UFS device to send the SCSI Request Packet.
-  @param[in, out] Packet        A pointer to the SCSI Request Packet to send to a specified Lun of the
-                                UFS device.
+  @param[in]      Trd           The pointer to the UTP Transfer Request Descriptor of the request.
+  @param[in, out] Packet        A pointer to the SCSI Request Packet that was executed.
 
-  @retval EFI_SUCCESS           The SCSI Request Packet was sent by the host. For bi-directional
-                                commands, InTransferLength bytes were transferred from
-                                InDataBuffer. For write and bi-directional commands,
-                                OutTransferLength bytes were transferred by
-                                OutDataBuffer.
-  @retval EFI_DEVICE_ERROR      A device error occurred while attempting to send the SCSI Request
-                                Packet.
-  @retval EFI_OUT_OF_RESOURCES  The resource for transfer is not available.
-  @retval EFI_TIMEOUT           A timeout occurred while waiting for the SCSI Request Packet to execute.
+  @retval EFI_SUCCESS           The SCSI Request Packet completed successfully.
+  @retval EFI_DEVICE_ERROR      The device or the host controller reported an error.
 
 **/
+STATIC
 EFI_STATUS
-EFIAPI
-UfsExecScsiCmds (
-  IN     UFS_PEIM_HC_PRIVATE_DATA      *Private,
-  IN     UINT8                         Lun,
+UfsGetScsiCmdResult (
+  IN     UTP_TRD                       *Trd,
   IN OUT UFS_SCSI_REQUEST_PACKET       *Packet
   )
 {
-  EFI_STATUS                           Status;
-  UINT8                                Slot;
-  UTP_TRD                              *Trd;
-  UINTN                                Address;
   UINT8                                *CmdDescBase;
-  UINT32                               CmdDescSize;
   UTP_RESPONSE_UPIU                    *Response;
   UINT16                               SenseDataLen;
   UINT32                               ResTranCount;
-  VOID                                 *PacketBufferMap;
-
-  //
-  // Find out which slot of transfer request list is available.
-  //
-  Status = UfsFindAvailableSlotInTrl (Private, &Slot);
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
-
-  Trd = ((UTP_TRD *)Private->UtpTrlBase) + Slot;
-  PacketBufferMap = NULL;
-
-  //
-  // Fill transfer request descriptor to this slot.
-  //
-  Status = UfsCreateScsiCommandDesc (Private, Lun, Packet, Trd, &PacketBufferMap);
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
-
-  CmdDescBase = (UINT8 *) (UINTN) (LShiftU64 ((UINT64)Trd->UcdBaU, 32) | LShiftU64 ((UINT64)Trd->UcdBa, 7));
-  CmdDescSize = Trd->PrdtO * sizeof (UINT32) + Trd->PrdtL * sizeof (UTP_TR_PRD);
-
-  //
-  // Start to execute the transfer request.
-  //
-  UfsStartExecCmd (Private, Slot);
-
-  //
-  // Wait for the completion of the transfer request.
-  //
-  Address = Private->UfsHcBase + UFS_HC_UTRLDBR_OFFSET;
-  Status = UfsWaitMemSet (Address, BIT0 << Slot, 0, Packet->Timeout);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
 
   //
   // Get sense data if exists
   //
+  CmdDescBase  = (UINT8 *) (UINTN) (LShiftU64 ((UINT64)Trd->UcdBaU, 32) | LShiftU64 ((UINT64)Trd->UcdBa, 7));
   Response     = (UTP_RESPONSE_UPIU *) (CmdDescBase + Trd->RuO * sizeof (UINT32));
   SenseDataLen = Response->SenseDataLen;
   SwapLittleEndianToBigEndian ((UINT8 *)&SenseDataLen, sizeof (UINT16));
@@ -1192,38 +1197,252 @@ UfsExecScsiCmds (
   //
   if (Response->Response != 0) {
     DEBUG ((DEBUG_ERROR, "UfsExecScsiCmds() fails with Target Failure\n"));
-    Status = EFI_DEVICE_ERROR;
-    goto Exit;
+    return EFI_DEVICE_ERROR;
   }
 
-  if (Trd->Ocs == 0) {
+  if (Trd->Ocs != 0) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if ((Response->Flags & BIT5) == BIT5) {
+    ResTranCount = Response->ResTranCount;
+    SwapLittleEndianToBigEndian ((UINT8 *)&ResTranCount, sizeof (UINT32));
     if (Packet->DataDirection == UfsDataIn) {
-      if ((Response->Flags & BIT5) == BIT5) {
-        ResTranCount = Response->ResTranCount;
-        SwapLittleEndianToBigEndian ((UINT8 *)&ResTranCount, sizeof (UINT32));
-        Packet->InTransferLength -= ResTranCount;
-      }
+      Packet->InTransferLength -= ResTranCount;
     } else if (Packet->DataDirection == UfsDataOut) {
-      if ((Response->Flags & BIT5) == BIT5) {
-        ResTranCount = Response->ResTranCount;
-        SwapLittleEndianToBigEndian ((UINT8 *)&ResTranCount, sizeof (UINT32));
-        Packet->OutTransferLength -= ResTranCount;
-      }
+      Packet->OutTransferLength -= ResTranCount;
     }
-  } else {
-    Status = EFI_DEVICE_ERROR;
   }
 
-Exit:
-  if (PacketBufferMap != NULL) {
-    IoMmuUnmap (PacketBufferMap);
+  return EFI_SUCCESS;
+}
+
+/**
+  Tear down a SCSI request: unmap its data buffer, clear the slot, free the
+  command descriptor and give the slot back.
+
+  @param[in]  Private           The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]  Slot              The slot the request was placed in.
+  @param[in]  BufferMap         The mapping of the data buffer, or NULL.
+
+**/
+STATIC
+VOID
+UfsRetireScsiCmd (
+  IN  UFS_PEIM_HC_PRIVATE_DATA         *Private,
+  IN  UINT8                            Slot,
+  IN  VOID                             *BufferMap
+  )
+{
+  UTP_TRD                              *Trd;
+  UINT8                                *CmdDescBase;
+  UINT32                               CmdDescSize;
+
+  Trd         = ((UTP_TRD *)Private->UtpTrlBase) + Slot;
+  CmdDescBase = (UINT8 *) (UINTN) (LShiftU64 ((UINT64)Trd->UcdBaU, 32) | LShiftU64 ((UINT64)Trd->UcdBa, 7));
+  CmdDescSize = Trd->PrdtO * sizeof (UINT32) + Trd->PrdtL * sizeof (UTP_TR_PRD);
+
+  if (BufferMap != NULL) {
+    IoMmuUnmap (BufferMap);
   }
   UfsStopExecCmd (Private, Slot);
+  UfsReleaseSlotInTrl (Private, Slot);
   UfsFreeMem (Private->Pool, CmdDescBase, CmdDescSize);
+}
+
+/**
+  Sends a list of UFS-supported SCSI Request Packets to a UFS device that is attached
+  to the UFS host controller, keeping as many of them in flight as the transfer
+  request list allows.
+
+  Free slots are filled with requests and the doorbell is rung once for the whole
+  set. Completed slots are then reaped by scanning the doorbell register, and the
+  freed slots are refilled with the remaining requests until all of them are done.
+  Once a request fails no new request is submitted; the ones already in flight
+  are still waited for.
+
+  @param[in]      Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]      Lun           The LUN of the UFS device to send the SCSI Request Packets.
+  @param[in]      GetPacket     The function returning the SCSI Request Packet of each request.
+                                The Timeout of the first packet bounds the wait for each
+                                completion.
+  @param[in]      Context       The context passed to GetPacket.
+  @param[in]      Count         The number of requests.
+
+  @retval EFI_SUCCESS           All the SCSI Request Packets completed successfully.
+  @retval EFI_DEVICE_ERROR      A device error occurred while attempting to send a SCSI Request
+                                Packet.
+  @retval EFI_OUT_OF_RESOURCES  The resource for transfer is not available.
+  @retval EFI_TIMEOUT           A timeout occurred while waiting for the SCSI Request Packets to execute.
+
+**/
+EFI_STATUS
+UfsExecScsiCmdQueue (
+  IN     UFS_PEIM_HC_PRIVATE_DATA      *Private,
+  IN     UINT8                         Lun,
+  IN     UFS_GET_SCSI_PACKET           GetPacket,
+  IN     VOID                          *Context,
+  IN     UINTN                         Count
+  )
+{
+  EFI_STATUS                           Status;
+  EFI_STATUS                           CmdStatus;
+  UFS_SCSI_REQUEST_PACKET              *Packet[UFS_MAX_TRL_SLOTS];
+  VOID                                 *BufferMap[UFS_MAX_TRL_SLOTS];
+  UINTN                                Next;
+  UINT8                                Slot;
+  UINT32                               Pending;
+  UINT32                               InFlight;
+  UINT32                               Completed;
+  UINTN                                Address;
+  UINT64                               Timeout;
+  UINT64                               Delay;
+
+  ASSERT ((Private != NULL) && (GetPacket != NULL));
+
+  Status   = EFI_SUCCESS;
+  Next     = 0;
+  InFlight = 0;
+  Timeout  = 0;
+  Address  = Private->UfsHcBase + UFS_HC_UTRLDBR_OFFSET;
+
+  while ((InFlight != 0) || ((Next < Count) && !EFI_ERROR (Status))) {
+    //
+    // Fill every free slot, then ring the doorbell once for all of them.
+    //
+    Pending = 0;
+    while ((Next < Count) && !EFI_ERROR (Status)) {
+      if (EFI_ERROR (UfsFindAvailableSlotInTrl (Private, &Slot))) {
+        break;
+      }
+
+      Packet[Slot]    = GetPacket (Context, Next, Slot);
+      BufferMap[Slot] = NULL;
+      if (Next == 0) {
+        Timeout = Packet[Slot]->Timeout;
+      }
+      CmdStatus = UfsCreateScsiCommandDesc (Private, Lun, Packet[Slot],
+                                            ((UTP_TRD *)Private->UtpTrlBase) + Slot, &BufferMap[Slot]);
+      if (EFI_ERROR (CmdStatus)) {
+        UfsReleaseSlotInTrl (Private, Slot);
+        //
+        // Running out of descriptor or DMA mapping space is only fatal when
+        // nothing is outstanding that would give some back.
+        //
+        if ((InFlight | Pending) == 0) {
+          Status = CmdStatus;
+        }
+        break;
+      }
+
+      Next++;
+      Pending |= UFS_TRL_SLOT_BIT (Slot);
+    }
+
+    if (Pending != 0) {
+      UfsStartExecCmds (Private, Pending);
+      InFlight |= Pending;
+    }
+
+    if (InFlight == 0) {
+      break;
+    }
+
+    //
+    // Wait for at least one of the outstanding requests to complete.
+    //
+    Delay = DivU64x32 (Timeout, 10) + 1;
+    do {
+      Completed = InFlight & ~MmioRead32 (Address);
+      if (Completed != 0) {
+        break;
+      }
+      MicroSecondDelay (1);
+    } while ((Timeout == 0) || (--Delay > 0));
+
+    if (Completed == 0) {
+      Status = EFI_TIMEOUT;
+      break;
+    }
+
+    for (Slot = 0; Completed != 0; Slot++) {
+      if ((Completed & UFS_TRL_SLOT_BIT (Slot)) == 0) {
+        continue;
+      }
+      CmdStatus = UfsGetScsiCmdResult (((UTP_TRD *)Private->UtpTrlBase) + Slot, Packet[Slot]);
+      if (EFI_ERROR (CmdStatus) && !EFI_ERROR (Status)) {
+        Status = CmdStatus;
+      }
+      UfsRetireScsiCmd (Private, Slot, BufferMap[Slot]);
+      Completed &= ~UFS_TRL_SLOT_BIT (Slot);
+      InFlight  &= ~UFS_TRL_SLOT_BIT (Slot);
+    }
+  }
+
+  //
+  // Abort whatever is still outstanding after a timeout.
+  //
+  for (Slot = 0; InFlight != 0; Slot++) {
+    if ((InFlight & UFS_TRL_SLOT_BIT (Slot)) != 0) {
+      UfsRetireScsiCmd (Private, Slot, BufferMap[Slot]);
+      InFlight &= ~UFS_TRL_SLOT_BIT (Slot);
+    }
+  }
 
   return Status;
 }
 
+/**
+  Return the caller's packet for UfsExecScsiCmds ().
+
+  @param[in]  Context           The SCSI Request Packet.
+  @param[in]  Index             The index of the request, always 0.
+  @param[in]  Slot              The transfer request slot the request is placed in.
+
+  @retval                       The SCSI Request Packet.
+
+**/
+STATIC
+UFS_SCSI_REQUEST_PACKET *
+UfsGetSinglePacket (
+  IN  VOID                             *Context,
+  IN  UINTN                            Index,
+  IN  UINT8                            Slot
+  )
+{
+  return (UFS_SCSI_REQUEST_PACKET *)Context;
+}
+
+/**
+  Sends a UFS-supported SCSI Request Packet to a UFS device that is attached to the UFS host controller.
+
+  @param[in]      Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]      Lun           The LUN of the UFS device to send the SCSI Request Packet.
+  @param[in, out] Packet        A pointer to the SCSI Request Packet to send to a specified Lun of the
+                                UFS device.
+
+  @retval EFI_SUCCESS           The SCSI Request Packet was sent by the host. For bi-directional
+                                commands, InTransferLength bytes were transferred from
+                                InDataBuffer. For write and bi-directional commands,
+                                OutTransferLength bytes were transferred by
+                                OutDataBuffer.
+  @retval EFI_DEVICE_ERROR      A device error occurred while attempting to send the SCSI Request
+                                Packet.
+  @retval EFI_OUT_OF_RESOURCES  The resource for transfer is not available.
+  @retval EFI_TIMEOUT           A timeout occurred while waiting for the SCSI Request Packet to execute.
+
+**/
+EFI_STATUS
+EFIAPI
+UfsExecScsiCmds (
+  IN     UFS_PEIM_HC_PRIVATE_DATA      *Private,
+  IN     UINT8                         Lun,
+  IN OUT UFS_SCSI_REQUEST_PACKET       *Packet
+  )
+{
+  return UfsExecScsiCmdQueue (Private, Lun, UfsGetSinglePacket, Packet, 1);
+}
+
 
 /**
   Sent UIC DME_LINKSTARTUP command to start the link startup procedure.
@@ -138,6 +138,7 @@ typedef struct _UFS_PEIM_HC_PRIVATE_DATA {
 
   VOID                              *UtpTrlBase;
   UINT8                             Nutrs;
+  UINT32                            SlotBitmap;
   VOID                              *TrlMapping;
   VOID                              *UtpTmrlBase;
   UINT8                             Nutmrs;
@@ -152,6 +153,12 @@ typedef struct _UFS_PEIM_HC_PRIVATE_DATA {
 
 #define IS_ALIGNED(addr, size)      (((UINTN) (addr) & (size - 1)) == 0)
 
+//
+// The transfer request list has at most 32 slots, one doorbell bit each.
+//
+#define UFS_MAX_TRL_SLOTS           32
+#define UFS_TRL_SLOT_BIT(Slot)      ((UINT32)1 << (Slot))
+
 #define UFS_SCSI_OP_LENGTH_SIX      0x6
 #define UFS_SCSI_OP_LENGTH_TEN      0xa
 #define UFS_SCSI_OP_LENGTH_SIXTEEN  0x10
@@ -197,6 +204,58 @@ UfsExecScsiCmds (
   IN OUT UFS_SCSI_REQUEST_PACKET       *Packet
   );
 
+/**
+  Get the SCSI Request Packet of a queued request.
+
+  The packet must stay valid until the request completes. Requests are asked
+  for in index order, again for the same index if it could not be submitted.
+  At most one request per slot is in flight, so a packet stored per slot can
+  be reused once its slot is handed out again.
+
+  @param[in]  Context           The context passed to UfsExecScsiCmdQueue ().
+  @param[in]  Index             The index of the request, 0 to Count - 1.
+  @param[in]  Slot              The transfer request slot the request is placed in.
+
+  @retval                       A pointer to the SCSI Request Packet of the request.
+
+**/
+typedef
+UFS_SCSI_REQUEST_PACKET *
+(*UFS_GET_SCSI_PACKET) (
+  IN  VOID                             *Context,
+  IN  UINTN                            Index,
+  IN  UINT8                            Slot
+  );
+
+/**
+  Sends a list of UFS-supported SCSI Request Packets to a UFS device that is attached
+  to the UFS host controller, keeping as many of them in flight as the transfer
+  request list allows.
+
+  @param[in]      Private       The pointer to the UFS_PEIM_HC_PRIVATE_DATA data structure.
+  @param[in]      Lun           The LUN of the UFS device to send the SCSI Request Packets.
+  @param[in]      GetPacket     The function returning the SCSI Request Packet of each request.
+                                The Timeout of the first packet bounds the wait for each
+                                completion.
+  @param[in]      Context       The context passed to GetPacket.
+  @param[in]      Count         The number of requests.
+
+  @retval EFI_SUCCESS           All the SCSI Request Packets completed successfully.
+  @retval EFI_DEVICE_ERROR      A device error occurred while attempting to send a SCSI Request
+                                Packet.
+  @retval EFI_OUT_OF_RESOURCES  The resource for transfer is not available.
+  @retval EFI_TIMEOUT           A timeout occurred while waiting for the SCSI Request Packets to execute.
+
+**/
+EFI_STATUS
+UfsExecScsiCmdQueue (
+  IN     UFS_PEIM_HC_PRIVATE_DATA      *Private,
+  IN     UINT8                         Lun,
+  IN     UFS_GET_SCSI_PACKET           GetPacket,
+  IN     VOID                          *Context,
+  IN     UINTN                         Count
+  );
+
 /**
   Initialize the UFS host controller.
 
@@ -181,7 +181,6 @@ BotDataPhase (
   UINT8           EndpointAddr;
   UINTN           Remain;
   UINTN           Increment;
-  UINT32          MaxPacketLen;
   UINT8           *BufferPtr;
   UINTN           TransferredSize;
 
@@ -191,26 +190,19 @@ BotDataPhase (
   BufferPtr       = (UINT8 *) DataBuffer;
   TransferredSize = 0;
 
-  //
-  // retrieve the the max packet length of the given endpoint
-  //
   if (Direction == EfiUsbDataIn) {
-    MaxPacketLen  = (PeiBotDev->BulkInEndpoint)->MaxPacketSize;
     EndpointAddr  = (PeiBotDev->BulkInEndpoint)->EndpointAddress;
   } else {
-    MaxPacketLen  = (PeiBotDev->BulkOutEndpoint)->MaxPacketSize;
     EndpointAddr  = (PeiBotDev->BulkOutEndpoint)->EndpointAddress;
   }
 
   while (Remain > 0) {
     //
-    // Using 15 packets to avoid Bitstuff error
+    // Hand the whole remaining data phase to the host controller at once. The
+    // xHCI driver splits it into as many TRBs as needed, so there is no reason
+    // to go through the bulk pipe a few packets at a time.
     //
-    if (Remain > 16 * MaxPacketLen) {
-      Increment = 16 * MaxPacketLen;
-    } else {
-      Increment = Remain;
-    }
+    Increment = Remain;
 
     Status = UsbIoPpi->UsbBulkTransfer (
                PeiServices,
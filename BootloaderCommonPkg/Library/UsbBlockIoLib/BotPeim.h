@@ -58,6 +58,14 @@ typedef struct {
 #define CSWSIG  0x53425355
 #define CBWSIG  0x43425355
 
+//
+// Largest data phase requested by a single CBW. 120KB is what USB 2.0 mass
+// storage devices are generally known to accept; SuperSpeed devices (1024 byte
+// bulk packets) are given 1MB.
+//
+#define USB_BOT_MAX_TRANSFER_SIZE      (120 * SIZE_1KB)
+#define USB_BOT_MAX_TRANSFER_SIZE_SS   SIZE_1MB
+
 /**
   Sends out ATAPI Inquiry Packet Command to the specified device. This command will
   return INQUIRY data of the device.
@@ -371,6 +371,7 @@ PeiUsbRead10 (
   ATAPI_PACKET_COMMAND  Packet;
   ATAPI_READ10_CMD      *Read10Packet;
   UINT16                MaxBlock;
+  UINT32                MaxTransfer;
   UINT32                BlocksRemaining;
   UINT16                SectorCount;
   UINT32                Lba32;
@@ -390,7 +391,12 @@ PeiUsbRead10 (
 
   BlockSize       = (UINT32) PeiBotDevice->Media.BlockSize;
 
-  MaxBlock        = (UINT16) (65535 / BlockSize);
+  if ((PeiBotDevice->BulkInEndpoint)->MaxPacketSize >= 1024) {
+    MaxTransfer   = USB_BOT_MAX_TRANSFER_SIZE_SS;
+  } else {
+    MaxTransfer   = USB_BOT_MAX_TRANSFER_SIZE;
+  }
+  MaxBlock        = (UINT16) MAX (MaxTransfer / BlockSize, 1);
   BlocksRemaining = (UINT32) NumberOfBlocks;
 
   Status          = EFI_SUCCESS;
@@ -427,7 +433,7 @@ PeiUsbRead10 (
 
     ByteCount               = SectorCount * BlockSize;
 
-    TimeOut                 = (UINT16) (SectorCount * 2000);
+    TimeOut                 = (UINT16) MIN ((UINT32)SectorCount * 2000, MAX_UINT16);
 
     //
     // send command packet
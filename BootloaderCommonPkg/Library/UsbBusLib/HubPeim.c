@@ -477,6 +477,9 @@ PeiDoHubConfig (
 /**
   Send reset signal over the given root hub port.
 
+  The caller is responsible for the connect debounce delay, so that it can be
+  shared by all the ports of a hub.
+
   @param  PeiServices    General-purpose services that are available to every PEIM.
   @param  UsbIoPpi       Indicates the PEI_USB_IO_PPI instance.
   @param  PortNum        Usb hub port number (starting from 1).
@@ -493,8 +496,6 @@ PeiResetHubPort (
   UINTN               Index;
   EFI_USB_PORT_STATUS HubPortStatus;
 
-  MicroSecondDelay (100 * 1000);
-
   //
   // reset root port
   //
@@ -109,6 +109,54 @@ GetExpectedDescriptor (
   OUT UINTN       *ParsedBytes
   );
 
+/**
+  Set or clear a feature of a root hub port through whichever host controller PPI is present.
+
+  @param  PeiServices       Describes the list of possible PEI Services.
+  @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
+  @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
+  @param  PortNum           The root hub port.
+  @param  Feature           The port feature.
+  @param  Set               TRUE to set the feature, FALSE to clear it.
+
+  @retval EFI_SUCCESS       The feature was updated.
+  @retval Others            The host controller failed to update the feature.
+
+**/
+STATIC
+EFI_STATUS
+RootPortFeature (
+  IN EFI_PEI_SERVICES               **PeiServices,
+  IN PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
+  IN PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
+  IN UINT8                          PortNum,
+  IN EFI_USB_PORT_FEATURE           Feature,
+  IN BOOLEAN                        Set
+  );
+
+/**
+  Get the status of a root hub port through whichever host controller PPI is present.
+
+  @param  PeiServices       Describes the list of possible PEI Services.
+  @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
+  @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
+  @param  PortNum           The root hub port.
+  @param  PortStatus        The port status returned.
+
+  @retval EFI_SUCCESS       The port status was returned.
+  @retval Others            The host controller failed to return the port status.
+
+**/
+STATIC
+EFI_STATUS
+RootPortStatus (
+  IN  EFI_PEI_SERVICES               **PeiServices,
+  IN  PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
+  IN  PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
+  IN  UINT8                          PortNum,
+  OUT EFI_USB_PORT_STATUS            *PortStatus
+  );
+
 /**
   The Hub Enumeration just scans the hub ports one time. It also
   doesn't support hot-plug.
@@ -138,9 +186,11 @@ PeiHubEnumeration (
   PEI_USB_DEVICE        *NewPeiUsbDevice;
   UINTN                 InterfaceIndex;
   UINTN                 EndpointIndex;
+  BOOLEAN               Debounced;
 
 
   UsbIoPpi    = &PeiUsbDevice->UsbIoPpi;
+  Debounced   = FALSE;
 
   DEBUG ((DEBUG_VERBOSE, "PeiHubEnumeration: DownStreamPortNo: %x\n", PeiUsbDevice->DownStreamPortNo));
 
@@ -209,7 +259,13 @@ PeiHubEnumeration (
             ((PortStatus.PortStatus & (USB_PORT_STAT_CONNECTION | USB_PORT_STAT_ENABLE)) == 0)) {
           //
           // If the port already has reset change flag and is connected and enabled, skip the port reset logic.
+          // All the hub ports were powered together, so a single debounce
+          // delay covers every port connected to this hub.
           //
+          if (!Debounced) {
+            MicroSecondDelay (USB_HUB_PORT_DEBOUNCE_STALL);
+            Debounced = TRUE;
+          }
           PeiResetHubPort (PeiServices, UsbIoPpi, (UINT8) (Index + 1));
 
           PeiHubGetPortStatus (
@@ -349,6 +405,10 @@ PeiUsbEnumeration (
   UINT8                 CurrentAddress;
   UINTN                 InterfaceIndex;
   UINTN                 EndpointIndex;
+  UINT8                 ResetPorts[MAX_UINT8];
+  UINTN                 ResetCount;
+  UINTN                 ResetIndex;
+  BOOLEAN               PortReset;
 
   CurrentAddress = 0;
   if (Usb2HcPpi != NULL) {
@@ -370,32 +430,43 @@ PeiUsbEnumeration (
 
   DEBUG ((DEBUG_VERBOSE, "PeiUsbEnumeration: NumOfRootPort: %x\n", NumOfRootPort));
 
+  //
+  // Reset all the newly connected root ports together first, so that they
+  // share the debounce, reset and recovery delays instead of paying them
+  // one port after another.
+  //
+  ResetCount = 0;
   for (Index = 0; Index < NumOfRootPort; Index++) {
+    RootPortStatus (PeiServices, UsbHcPpi, Usb2HcPpi, Index, &PortStatus);
+    if (((PortStatus.PortChangeStatus & (USB_PORT_STAT_C_CONNECTION | USB_PORT_STAT_C_ENABLE | USB_PORT_STAT_C_OVERCURRENT |
+                                         USB_PORT_STAT_C_RESET)) != 0) &&
+        IsPortConnect (PortStatus.PortStatus) &&
+        (((PortStatus.PortChangeStatus & USB_PORT_STAT_C_RESET) == 0) ||
+         ((PortStatus.PortStatus & (USB_PORT_STAT_CONNECTION | USB_PORT_STAT_ENABLE)) == 0))) {
+      ResetPorts[ResetCount++] = Index;
+    }
+  }
+  ResetRootPorts (PeiServices, UsbHcPpi, Usb2HcPpi, ResetPorts, ResetCount, USB_ROOT_PORT_RECOVERY_STALL);
+
+  ResetIndex = 0;
+  for (Index = 0; Index < NumOfRootPort; Index++) {
+    PortReset = (BOOLEAN) ((ResetIndex < ResetCount) && (ResetPorts[ResetIndex] == Index));
+    if (PortReset) {
+      ResetIndex++;
+    }
+
     //
     // First get root port status to detect changes happen
     //
-    if (Usb2HcPpi != NULL) {
-      Usb2HcPpi->GetRootHubPortStatus (
-        PeiServices,
-        Usb2HcPpi,
-        (UINT8) Index,
-        &PortStatus
-        );
-    } else {
-      UsbHcPpi->GetRootHubPortStatus (
-        PeiServices,
-        UsbHcPpi,
-        (UINT8) Index,
-        &PortStatus
-        );
-    }
+    RootPortStatus (PeiServices, UsbHcPpi, Usb2HcPpi, Index, &PortStatus);
     DEBUG ((DEBUG_VERBOSE, "USB Status --- Port: %x ConnectChange[%04x] Status[%04x]\n", Index, PortStatus.PortChangeStatus,
             PortStatus.PortStatus));
     //
     // Only handle connection/enable/overcurrent/reset change.
     //
-    if ((PortStatus.PortChangeStatus & (USB_PORT_STAT_C_CONNECTION | USB_PORT_STAT_C_ENABLE | USB_PORT_STAT_C_OVERCURRENT |
-                                        USB_PORT_STAT_C_RESET)) == 0) {
+    if (!PortReset &&
+        ((PortStatus.PortChangeStatus & (USB_PORT_STAT_C_CONNECTION | USB_PORT_STAT_C_ENABLE | USB_PORT_STAT_C_OVERCURRENT |
+                                         USB_PORT_STAT_C_RESET)) == 0)) {
       continue;
     } else {
       if (IsPortConnect (PortStatus.PortStatus)) {
@@ -433,8 +504,12 @@ PeiUsbEnumeration (
         PeiUsbDevice->IsHub             = 0x0;
         PeiUsbDevice->DownStreamPortNo  = 0x0;
 
-        if (((PortStatus.PortChangeStatus & USB_PORT_STAT_C_RESET) == 0) ||
-            ((PortStatus.PortStatus & (USB_PORT_STAT_CONNECTION | USB_PORT_STAT_ENABLE)) == 0)) {
+        if (PortReset) {
+          //
+          // Already reset above, PortStatus is current.
+          //
+        } else if (((PortStatus.PortChangeStatus & USB_PORT_STAT_C_RESET) == 0) ||
+                   ((PortStatus.PortStatus & (USB_PORT_STAT_CONNECTION | USB_PORT_STAT_ENABLE)) == 0)) {
           //
           // If the port already has reset change flag and is connected and enabled, skip the port reset logic.
           //
@@ -446,37 +521,9 @@ PeiUsbEnumeration (
             0
             );
 
-          if (Usb2HcPpi != NULL) {
-            Usb2HcPpi->GetRootHubPortStatus (
-              PeiServices,
-              Usb2HcPpi,
-              (UINT8) Index,
-              &PortStatus
-              );
-          } else {
-            UsbHcPpi->GetRootHubPortStatus (
-              PeiServices,
-              UsbHcPpi,
-              (UINT8) Index,
-              &PortStatus
-              );
-          }
+          RootPortStatus (PeiServices, UsbHcPpi, Usb2HcPpi, Index, &PortStatus);
         } else {
-          if (Usb2HcPpi != NULL) {
-            Usb2HcPpi->ClearRootHubPortFeature (
-              PeiServices,
-              Usb2HcPpi,
-              (UINT8) Index,
-              EfiUsbPortResetChange
-              );
-          } else {
-            UsbHcPpi->ClearRootHubPortFeature (
-              PeiServices,
-              UsbHcPpi,
-              (UINT8) Index,
-              EfiUsbPortResetChange
-              );
-          }
+          RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, Index, EfiUsbPortResetChange, FALSE);
         }
 
         PeiUsbDevice->DeviceSpeed = (UINT8) PeiUsbGetDeviceSpeed (PortStatus.PortStatus);
@@ -915,235 +962,205 @@ GetExpectedDescriptor (
 }
 
 /**
-  Send reset signal over the given root hub port.
+  Set or clear a feature of a root hub port through whichever host controller PPI is present.
 
   @param  PeiServices       Describes the list of possible PEI Services.
   @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
   @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
-  @param  PortNum           The port to be reset.
-  @param  RetryIndex        The retry times.
+  @param  PortNum           The root hub port.
+  @param  Feature           The port feature.
+  @param  Set               TRUE to set the feature, FALSE to clear it.
+
+  @retval EFI_SUCCESS       The feature was updated.
+  @retval Others            The host controller failed to update the feature.
 
 **/
-VOID
-ResetRootPort (
+STATIC
+EFI_STATUS
+RootPortFeature (
   IN EFI_PEI_SERVICES               **PeiServices,
   IN PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
   IN PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
   IN UINT8                          PortNum,
-  IN UINT8                          RetryIndex
+  IN EFI_USB_PORT_FEATURE           Feature,
+  IN BOOLEAN                        Set
   )
 {
-  EFI_STATUS             Status;
-  UINTN                  Index;
-  EFI_USB_PORT_STATUS    PortStatus;
-
-
   if (Usb2HcPpi != NULL) {
-    MicroSecondDelay (200 * 1000);
-
-    //
-    // reset root port
-    //
-    Status = Usb2HcPpi->SetRootHubPortFeature (
-               PeiServices,
-               Usb2HcPpi,
-               PortNum,
-               EfiUsbPortReset
-               );
-
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "SetRootHubPortFeature EfiUsbPortReset Failed\n"));
-      return;
-    }
-
-    //
-    // Drive the reset signal for at least 50ms. Check USB 2.0 Spec
-    // section 7.1.7.5 for timing requirements.
-    //
-    MicroSecondDelay (USB_SET_ROOT_PORT_RESET_STALL);
-
-    //
-    // clear reset root port
-    //
-    Status = Usb2HcPpi->ClearRootHubPortFeature (
-               PeiServices,
-               Usb2HcPpi,
-               PortNum,
-               EfiUsbPortReset
-               );
-
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "ClearRootHubPortFeature EfiUsbPortReset Failed\n"));
-      return;
+    if (Set) {
+      return Usb2HcPpi->SetRootHubPortFeature (PeiServices, Usb2HcPpi, PortNum, Feature);
     }
+    return Usb2HcPpi->ClearRootHubPortFeature (PeiServices, Usb2HcPpi, PortNum, Feature);
+  }
 
-    MicroSecondDelay (USB_CLR_ROOT_PORT_RESET_STALL);
+  if (Set) {
+    return UsbHcPpi->SetRootHubPortFeature (PeiServices, UsbHcPpi, PortNum, Feature);
+  }
+  return UsbHcPpi->ClearRootHubPortFeature (PeiServices, UsbHcPpi, PortNum, Feature);
+}
 
-    //
-    // USB host controller won't clear the RESET bit until
-    // reset is actually finished.
-    //
-    ZeroMem (&PortStatus, sizeof (EFI_USB_PORT_STATUS));
-
-    for (Index = 0; Index < USB_WAIT_PORT_STS_CHANGE_LOOP; Index++) {
-      Status = Usb2HcPpi->GetRootHubPortStatus (
-                 PeiServices,
-                 Usb2HcPpi,
-                 PortNum,
-                 &PortStatus
-                 );
-      if (EFI_ERROR (Status)) {
-        return;
-      }
+/**
+  Get the status of a root hub port through whichever host controller PPI is present.
 
-      if (!USB_BIT_IS_SET (PortStatus.PortStatus, USB_PORT_STAT_RESET)) {
-        break;
-      }
+  @param  PeiServices       Describes the list of possible PEI Services.
+  @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
+  @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
+  @param  PortNum           The root hub port.
+  @param  PortStatus        The port status returned.
 
-      MicroSecondDelay (USB_WAIT_PORT_STS_CHANGE_STALL);
-    }
+  @retval EFI_SUCCESS       The port status was returned.
+  @retval Others            The host controller failed to return the port status.
 
-    if (Index == USB_WAIT_PORT_STS_CHANGE_LOOP) {
-      DEBUG ((DEBUG_ERROR, "ResetRootPort: reset not finished in time on port %d\n", PortNum));
-      return;
-    }
+**/
+STATIC
+EFI_STATUS
+RootPortStatus (
+  IN  EFI_PEI_SERVICES               **PeiServices,
+  IN  PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
+  IN  PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
+  IN  UINT8                          PortNum,
+  OUT EFI_USB_PORT_STATUS            *PortStatus
+  )
+{
+  if (Usb2HcPpi != NULL) {
+    return Usb2HcPpi->GetRootHubPortStatus (PeiServices, Usb2HcPpi, PortNum, PortStatus);
+  }
+  return UsbHcPpi->GetRootHubPortStatus (PeiServices, UsbHcPpi, PortNum, PortStatus);
+}
 
-    Usb2HcPpi->ClearRootHubPortFeature (
-      PeiServices,
-      Usb2HcPpi,
-      PortNum,
-      EfiUsbPortResetChange
-      );
+/**
+  Send reset signal over a set of root hub ports at the same time.
 
-    Usb2HcPpi->ClearRootHubPortFeature (
-      PeiServices,
-      Usb2HcPpi,
-      PortNum,
-      EfiUsbPortConnectChange
-      );
+  All the ports go through debounce, reset and reset recovery together, so the
+  fixed delays are paid once for the whole set instead of once per port. Each
+  port is enabled as soon as the host controller reports its reset as done.
 
-    //
-    // Set port enable
-    //
-    Usb2HcPpi->SetRootHubPortFeature (
-      PeiServices,
-      Usb2HcPpi,
-      PortNum,
-      EfiUsbPortEnable
-      );
+  @param  PeiServices       Describes the list of possible PEI Services.
+  @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
+  @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
+  @param  Ports             The ports to be reset.
+  @param  PortCount         The number of ports in Ports.
+  @param  RecoveryStall     The time to wait after the ports are enabled, in microseconds.
 
-    Usb2HcPpi->ClearRootHubPortFeature (
-      PeiServices,
-      Usb2HcPpi,
-      PortNum,
-      EfiUsbPortEnableChange
-      );
+**/
+VOID
+ResetRootPorts (
+  IN EFI_PEI_SERVICES               **PeiServices,
+  IN PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
+  IN PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
+  IN UINT8                          *Ports,
+  IN UINTN                          PortCount,
+  IN UINTN                          RecoveryStall
+  )
+{
+  EFI_STATUS             Status;
+  UINTN                  Index;
+  UINTN                  Loop;
+  UINTN                  Pending;
+  UINT8                  PortNum;
+  EFI_USB_PORT_STATUS    PortStatus;
+  BOOLEAN                Enabled[MAX_UINT8 + 1];
 
-    MicroSecondDelay ((RetryIndex + 1) * 50 * 1000);
-  } else {
-    MicroSecondDelay (200 * 1000);
+  if (PortCount == 0) {
+    return;
+  }
 
-    //
-    // reset root port
-    //
-    Status = UsbHcPpi->SetRootHubPortFeature (
-               PeiServices,
-               UsbHcPpi,
-               PortNum,
-               EfiUsbPortReset
-               );
+  MicroSecondDelay (USB_ROOT_PORT_DEBOUNCE_STALL);
 
+  //
+  // Drive the reset signal for at least 50ms. Check USB 2.0 Spec
+  // section 7.1.7.5 for timing requirements.
+  //
+  for (Index = 0; Index < PortCount; Index++) {
+    Status = RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, Ports[Index], EfiUsbPortReset, TRUE);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "SetRootHubPortFeature EfiUsbPortReset Failed\n"));
-      return;
     }
+  }
 
-    //
-    // Drive the reset signal for at least 50ms. Check USB 2.0 Spec
-    // section 7.1.7.5 for timing requirements.
-    //
-    MicroSecondDelay (USB_SET_ROOT_PORT_RESET_STALL);
-
-    //
-    // clear reset root port
-    //
-    Status = UsbHcPpi->ClearRootHubPortFeature (
-               PeiServices,
-               UsbHcPpi,
-               PortNum,
-               EfiUsbPortReset
-               );
+  MicroSecondDelay (USB_SET_ROOT_PORT_RESET_STALL);
 
+  for (Index = 0; Index < PortCount; Index++) {
+    Status = RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, Ports[Index], EfiUsbPortReset, FALSE);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "ClearRootHubPortFeature EfiUsbPortReset Failed\n"));
-      return;
     }
+  }
 
-    MicroSecondDelay (USB_CLR_ROOT_PORT_RESET_STALL);
+  MicroSecondDelay (USB_CLR_ROOT_PORT_RESET_STALL);
 
-    //
-    // USB host controller won't clear the RESET bit until
-    // reset is actually finished.
-    //
-    ZeroMem (&PortStatus, sizeof (EFI_USB_PORT_STATUS));
-
-    for (Index = 0; Index < USB_WAIT_PORT_STS_CHANGE_LOOP; Index++) {
-      Status = UsbHcPpi->GetRootHubPortStatus (
-                 PeiServices,
-                 UsbHcPpi,
-                 PortNum,
-                 &PortStatus
-                 );
-      if (EFI_ERROR (Status)) {
-        return;
+  //
+  // USB host controller won't clear the RESET bit until
+  // reset is actually finished. Enable every port whose reset is done
+  // and keep polling the others.
+  //
+  ZeroMem (Enabled, sizeof (Enabled));
+  Pending = PortCount;
+  for (Loop = 0; (Loop < USB_WAIT_PORT_STS_CHANGE_LOOP) && (Pending > 0); Loop++) {
+    for (Index = 0; Index < PortCount; Index++) {
+      PortNum = Ports[Index];
+      if (Enabled[PortNum]) {
+        continue;
       }
 
-      if (!USB_BIT_IS_SET (PortStatus.PortStatus, USB_PORT_STAT_RESET)) {
-        break;
+      ZeroMem (&PortStatus, sizeof (EFI_USB_PORT_STATUS));
+      Status = RootPortStatus (PeiServices, UsbHcPpi, Usb2HcPpi, PortNum, &PortStatus);
+      if (!EFI_ERROR (Status) && USB_BIT_IS_SET (PortStatus.PortStatus, USB_PORT_STAT_RESET)) {
+        continue;
       }
 
-      MicroSecondDelay (USB_WAIT_PORT_STS_CHANGE_STALL);
+      Enabled[PortNum] = TRUE;
+      Pending--;
+      if (EFI_ERROR (Status)) {
+        continue;
+      }
+
+      RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, PortNum, EfiUsbPortResetChange, FALSE);
+      RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, PortNum, EfiUsbPortConnectChange, FALSE);
+
+      //
+      // Set port enable
+      //
+      RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, PortNum, EfiUsbPortEnable, TRUE);
+      RootPortFeature (PeiServices, UsbHcPpi, Usb2HcPpi, PortNum, EfiUsbPortEnableChange, FALSE);
     }
 
-    if (Index == USB_WAIT_PORT_STS_CHANGE_LOOP) {
-      DEBUG ((DEBUG_ERROR, "ResetRootPort: reset not finished in time on port %d\n", PortNum));
-      return;
+    if (Pending > 0) {
+      MicroSecondDelay (USB_WAIT_PORT_STS_CHANGE_STALL);
     }
+  }
 
-    UsbHcPpi->ClearRootHubPortFeature (
-      PeiServices,
-      UsbHcPpi,
-      PortNum,
-      EfiUsbPortResetChange
-      );
+  for (Index = 0; Index < PortCount; Index++) {
+    if (!Enabled[Ports[Index]]) {
+      DEBUG ((DEBUG_ERROR, "ResetRootPort: reset not finished in time on port %d\n", Ports[Index]));
+    }
+  }
 
-    UsbHcPpi->ClearRootHubPortFeature (
-      PeiServices,
-      UsbHcPpi,
-      PortNum,
-      EfiUsbPortConnectChange
-      );
+  if (Pending < PortCount) {
+    MicroSecondDelay (RecoveryStall);
+  }
+}
 
-    //
-    // Set port enable
-    //
-    UsbHcPpi->SetRootHubPortFeature (
-      PeiServices,
-      UsbHcPpi,
-      PortNum,
-      EfiUsbPortEnable
-      );
+/**
+  Send reset signal over the given root hub port.
 
-    UsbHcPpi->ClearRootHubPortFeature (
-      PeiServices,
-      UsbHcPpi,
-      PortNum,
-      EfiUsbPortEnableChange
-      );
+  @param  PeiServices       Describes the list of possible PEI Services.
+  @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
+  @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
+  @param  PortNum           The port to be reset.
+  @param  RetryIndex        The retry times.
 
-    MicroSecondDelay ((RetryIndex + 1) * 50 * 1000);
-  }
-  return;
+**/
+VOID
+ResetRootPort (
+  IN EFI_PEI_SERVICES               **PeiServices,
+  IN PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
+  IN PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
+  IN UINT8                          PortNum,
+  IN UINT8                          RetryIndex
+  )
+{
+  ResetRootPorts (PeiServices, UsbHcPpi, Usb2HcPpi, &PortNum, 1, (RetryIndex + 1) * USB_ROOT_PORT_RECOVERY_STALL);
 }
 
 /**
@@ -79,6 +79,19 @@ typedef struct {
 //
 #define USB_CLR_ROOT_PORT_RESET_STALL   (20 * USB_BUS_1_MILLISECOND)
 
+//
+// Wait for a new connection to settle before resetting the port. USB 2.0
+// section 7.1.7.3 asks for at least 100ms; root ports use a longer value
+// set by experience.
+//
+#define USB_ROOT_PORT_DEBOUNCE_STALL    (200 * USB_BUS_1_MILLISECOND)
+#define USB_HUB_PORT_DEBOUNCE_STALL     (100 * USB_BUS_1_MILLISECOND)
+
+//
+// Wait for reset recovery after root ports are enabled, set by experience
+//
+#define USB_ROOT_PORT_RECOVERY_STALL    (50 * USB_BUS_1_MILLISECOND)
+
 //
 // Wait for port statue reg change, set by experience
 //
@@ -247,4 +260,25 @@ ResetRootPort (
   IN UINT8                          RetryIndex
   );
 
+/**
+  Send reset signal over a set of root hub ports at the same time.
+
+  @param  PeiServices       Describes the list of possible PEI Services.
+  @param  UsbHcPpi          The pointer of PEI_USB_HOST_CONTROLLER_PPI instance.
+  @param  Usb2HcPpi         The pointer of PEI_USB2_HOST_CONTROLLER_PPI instance.
+  @param  Ports             The ports to be reset.
+  @param  PortCount         The number of ports in Ports.
+  @param  RecoveryStall     The time to wait after the ports are enabled, in microseconds.
+
+**/
+VOID
+ResetRootPorts (
+  IN EFI_PEI_SERVICES               **PeiServices,
+  IN PEI_USB_HOST_CONTROLLER_PPI    *UsbHcPpi,
+  IN PEI_USB2_HOST_CONTROLLER_PPI   *Usb2HcPpi,
+  IN UINT8                          *Ports,
+  IN UINTN                          PortCount,
+  IN UINTN                          RecoveryStall
+  );
+
 #endif
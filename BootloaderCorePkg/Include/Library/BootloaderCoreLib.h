@@ -117,12 +117,31 @@ typedef struct {
   UINT8         Data[];
 } VBT_ENTRY_HDR;
 
+#define S3_BOOT_SCRIPT_ENTRIES   64
+
+//
+// One register access recorded on the normal boot path and
+// replayed on S3 resume (see S3SaveRestoreLib)
+//
+typedef struct {
+  UINT8         OpCode;
+  UINT8         Type;
+  UINT8         Width;
+  UINT8         Reserved;
+  UINT32        Address;
+  UINT32        Timeout;
+  UINT64        Value;
+  UINT64        Mask;
+} S3_BOOT_SCRIPT_ENTRY;
+
 typedef struct {
-  UINT32        AcpiTop;
-  UINT32        AcpiBase;
-  UINT32        AcpiGnvs;
-  UINT8         BootMediaType;
-  UINT8         BootPartition;
+  UINT32                AcpiTop;
+  UINT32                AcpiBase;
+  UINT32                AcpiGnvs;
+  UINT8                 BootMediaType;
+  UINT8                 BootPartition;
+  UINT16                BootScriptCount;
+  S3_BOOT_SCRIPT_ENTRY  BootScript[S3_BOOT_SCRIPT_ENTRIES];
 } S3_DATA;
 
 #pragma pack()
@@ -189,6 +208,7 @@ typedef struct {
   UINT32            MemPoolStart;
   UINT32            MemPoolCurrTop;
   UINT32            MemPoolCurrBottom;
+  UINT32            MemPoolMaxBottom;
   UINT32            MemUsableTop;
   UINT32            PayloadId;
   UINT32            DebugPrintErrorLevel;
@@ -15,6 +15,21 @@
 #define S3_SAVE_REG_COMM_ID   2
 #define BL_SW_SMI_COMM_ID     3
 
+//
+// S3 boot script opcodes
+//
+#define S3_BOOT_SCRIPT_OP_WRITE      1
+#define S3_BOOT_SCRIPT_OP_POLL       2
+
+//
+// S3 boot script register types. Addresses are MMIO or IO addresses,
+// PCI_LIB_ADDRESS encoded PCI config addresses, or MSR indexes.
+//
+#define S3_BOOT_SCRIPT_MMIO          0
+#define S3_BOOT_SCRIPT_IO            1
+#define S3_BOOT_SCRIPT_PCI           2
+#define S3_BOOT_SCRIPT_MSR           3
+
 //
 // Format to share info between bootloader and payload.
 // Structures can be present in any order within the 4KB
@@ -168,5 +183,78 @@ RestoreS3RegInfo (
   IN  S3_SAVE_REG   *S3SaveReg
   );
 
+/**
+  Write a register and record the write in the S3 boot script.
+
+  When Mask is not zero only the bits set in Mask are updated, the other
+  bits keep the value read back from the register. The write is recorded
+  only on the normal boot path, and is replayed by S3BootScriptExecute ()
+  on S3 resume.
+
+  @param[in]  Type                  S3_BOOT_SCRIPT_MMIO/IO/PCI/MSR.
+  @param[in]  Width                 Access width in bytes (MSR accesses are always 8).
+  @param[in]  Address               Register address.
+  @param[in]  Value                 Value to write.
+  @param[in]  Mask                  Bits to update, or 0 to write the full register.
+
+  @retval     EFI_SUCCESS           The register was written and recorded.
+  @retval     EFI_INVALID_PARAMETER Invalid Type or Width.
+  @retval     EFI_OUT_OF_RESOURCES  The register was written but the script is full.
+
+**/
+EFI_STATUS
+EFIAPI
+S3BootScriptWrite (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask
+  );
+
+/**
+  Poll a register until the masked value matches, and record the poll
+  in the S3 boot script so it is repeated at the same point on resume.
+
+  @param[in]  Type                  S3_BOOT_SCRIPT_MMIO/IO/PCI/MSR.
+  @param[in]  Width                 Access width in bytes (MSR accesses are always 8).
+  @param[in]  Address               Register address.
+  @param[in]  Value                 Expected value of the masked register.
+  @param[in]  Mask                  Bits to compare.
+  @param[in]  Timeout               Timeout in microseconds.
+
+  @retval     EFI_SUCCESS           The condition was met.
+  @retval     EFI_TIMEOUT           The condition was not met in time.
+  @retval     EFI_INVALID_PARAMETER Invalid Type or Width.
+  @retval     EFI_OUT_OF_RESOURCES  The poll completed but the script is full.
+
+**/
+EFI_STATUS
+EFIAPI
+S3BootScriptPoll (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask,
+  IN  UINT32    Timeout
+  );
+
+/**
+  Replay the S3 boot script recorded on the normal boot path.
+  This function is only called in the S3 resume path.
+
+  @retval     EFI_SUCCESS           The script was replayed.
+  @retval     EFI_NOT_FOUND         No script was recorded.
+  @retval     EFI_TIMEOUT           A poll entry did not complete in time.
+  @retval     EFI_INVALID_PARAMETER The script contains an invalid entry.
+
+**/
+EFI_STATUS
+EFIAPI
+S3BootScriptExecute (
+  VOID
+  );
+
 
 #endif
@@ -96,21 +96,34 @@ UpdateAcpiGnvs (
   UINT8 *Ptr;
   UINT8 *End;
 
-  Ptr = (UINT8 *)Dsdt;
-  End = (UINT8 *)Dsdt + Dsdt->Length;
+  //
+  // The GNVS region is encoded as:
+  //   ExtOp RegionOp 'GNVS' RegionSpace DWordPrefix Offset WordPrefix Length
+  // Only the last possible start of that sequence needs to be scanned.
+  //
+  if (Dsdt->Length < sizeof (EFI_ACPI_DESCRIPTION_HEADER) + 15) {
+    return;
+  }
+  Ptr = (UINT8 *)Dsdt + sizeof (EFI_ACPI_DESCRIPTION_HEADER);
+  End = (UINT8 *)Dsdt + Dsdt->Length - 15;
 
   /*
    * Loop through the ASL looking for values that we must fix up.
+   * Match the opcode bytes first, they are rare in the AML stream.
    */
-  for (; Ptr < End; Ptr++) {
-    if (* (UINT32 *)Ptr != SIGNATURE_32 ('G', 'N', 'V', 'S')) {
+  for (; Ptr <= End; Ptr++) {
+    if ((Ptr[0] != AML_EXT_OP) || (Ptr[1] != AML_EXT_REGION_OP)) {
       continue;
     }
-    if (* (Ptr - 1) != AML_EXT_REGION_OP) {
+    if (ReadUnaligned32 ((UINT32 *)(Ptr + 2)) != SIGNATURE_32 ('G', 'N', 'V', 'S')) {
       continue;
     }
-    * (UINT32 *) (Ptr + 6)  = GnvsBase;
-    * (UINT16 *) (Ptr + 11) = (UINT16)GetAcpiGnvsSize();
+    if ((Ptr[7] != AML_DWORD_PREFIX) || (Ptr[12] != AML_WORD_PREFIX)) {
+      DEBUG ((DEBUG_ERROR, "Unexpected GNVS region encoding in DSDT!\n"));
+      break;
+    }
+    WriteUnaligned32 ((UINT32 *)(Ptr + 8), GnvsBase);
+    WriteUnaligned16 ((UINT16 *)(Ptr + 13), (UINT16)GetAcpiGnvsSize());
     break;
   }
 }
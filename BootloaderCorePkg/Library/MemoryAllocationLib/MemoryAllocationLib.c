@@ -13,6 +13,7 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BootloaderCoreLib.h>
+#include <Library/BlMemoryAllocationLib.h>
 
 #define   POOL_MIN_ALIGNMENT    0x10
 
@@ -48,6 +49,9 @@ InternalUpdateMemPoolBottom (
   LdrGlobal = GetLoaderGlobalDataPointer();
   ASSERT (LdrGlobal->MemPoolCurrTop >= Bottom);
   LdrGlobal->MemPoolCurrBottom = Bottom;
+  if (Bottom > LdrGlobal->MemPoolMaxBottom) {
+    LdrGlobal->MemPoolMaxBottom = Bottom;
+  }
 }
 
 /**
@@ -232,6 +236,7 @@ FreeTemporaryMemory (
   LdrGlobal = GetLoaderGlobalDataPointer();
   if (Buffer == NULL) {
     LdrGlobal->MemPoolCurrBottom = LdrGlobal->MemPoolStart;
+    LdrGlobal->MemPoolMaxBottom  = LdrGlobal->MemPoolStart;
   } else {
     NewBottom = (UINT32)(UINTN)Buffer;
     if (NewBottom < LdrGlobal->MemPoolCurrBottom) {
@@ -240,6 +245,105 @@ FreeTemporaryMemory (
   }
 }
 
+/**
+  Open a temporary memory arena.
+
+  The arena marks the current temporary memory pool position. All temporary
+  memory allocated after this point belongs to the arena until it is closed,
+  and the peak usage of the arena is tracked. Arenas can be nested.
+
+  @param[out] Arena     The arena handle to initialize.
+  @param[in]  Name      The arena name used in the debug log.
+
+**/
+VOID
+EFIAPI
+OpenTemporaryMemoryArena (
+  OUT TEMPORARY_MEMORY_ARENA  *Arena,
+  IN  CONST CHAR8             *Name
+  )
+{
+  LOADER_GLOBAL_DATA  *LdrGlobal;
+
+  LdrGlobal = GetLoaderGlobalDataPointer();
+  Arena->Signature      = TEMPORARY_MEMORY_ARENA_SIGNATURE;
+  Arena->Base           = LdrGlobal->MemPoolCurrBottom;
+  Arena->SavedHighWater = LdrGlobal->MemPoolMaxBottom;
+  Arena->Peak           = 0;
+  Arena->Name           = Name;
+
+  // Track the high water mark relative to this arena
+  LdrGlobal->MemPoolMaxBottom = Arena->Base;
+}
+
+/**
+  Release all temporary memory allocated within an arena.
+
+  The arena stays open and can be used again. Its peak usage is retained.
+  If the pool was already freed below the arena, e.g. by
+  FreeTemporaryMemory (NULL), the pool is left as it is.
+
+  @param[in]  Arena     The arena handle.
+
+**/
+VOID
+EFIAPI
+ReleaseTemporaryMemoryArena (
+  IN  TEMPORARY_MEMORY_ARENA  *Arena
+  )
+{
+  LOADER_GLOBAL_DATA  *LdrGlobal;
+  UINT32               Peak;
+
+  ASSERT (Arena->Signature == TEMPORARY_MEMORY_ARENA_SIGNATURE);
+
+  LdrGlobal = GetLoaderGlobalDataPointer();
+  if (LdrGlobal->MemPoolMaxBottom > Arena->Base) {
+    Peak = LdrGlobal->MemPoolMaxBottom - Arena->Base;
+    if (Peak > Arena->Peak) {
+      Arena->Peak = Peak;
+    }
+  }
+
+  if (LdrGlobal->MemPoolCurrBottom > Arena->Base) {
+    LdrGlobal->MemPoolCurrBottom = Arena->Base;
+  }
+}
+
+/**
+  Close a temporary memory arena.
+
+  All temporary memory allocated within the arena is released and the arena
+  peak usage is reported.
+
+  @param[in]  Arena     The arena handle.
+
+  @retval     The peak temporary memory usage in bytes within the arena.
+
+**/
+UINT32
+EFIAPI
+CloseTemporaryMemoryArena (
+  IN  TEMPORARY_MEMORY_ARENA  *Arena
+  )
+{
+  LOADER_GLOBAL_DATA  *LdrGlobal;
+
+  ReleaseTemporaryMemoryArena (Arena);
+
+  // Propagate the high water mark to the enclosing arena, unless the pool
+  // was reset meanwhile and the saved mark is stale
+  LdrGlobal = GetLoaderGlobalDataPointer();
+  if (LdrGlobal->MemPoolMaxBottom >= Arena->Base) {
+    LdrGlobal->MemPoolMaxBottom = MAX (Arena->SavedHighWater, Arena->Base + Arena->Peak);
+  }
+  Arena->Signature = 0;
+
+  DEBUG ((DEBUG_INFO, "Temp arena %a peak: 0x%X\n", (Arena->Name == NULL) ? "" : Arena->Name, Arena->Peak));
+
+  return Arena->Peak;
+}
+
 /**
   Frees one or more 4KB pages that were previously allocated with one of the page allocation
   functions in the Memory Allocation Library.
@@ -330,3 +434,19 @@ AllocateRuntimePool (
 {
   return NULL;
 }
+
+/**
+  Retrieve the small pool allocator statistics.
+
+  @param[out]  Stats         The pointer to receive the statistics.
+
+  @retval     EFI_UNSUPPORTED        The allocator does not keep statistics.
+**/
+EFI_STATUS
+EFIAPI
+GetMemoryPoolStats (
+  OUT  MEMORY_POOL_STATS  *Stats
+  )
+{
+  return EFI_UNSUPPORTED;
+}
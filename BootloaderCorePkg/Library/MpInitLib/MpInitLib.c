@@ -218,13 +218,12 @@ ApFunc (
   //
   CpuInit (Index);
 
-  //
-  // Signal AP completion
-  //
-  InterlockedIncrement (&mMpDataStructPtr->ApDoneCounter);
+  if (Index >= FixedPcdGet32 (PcdCpuMaxLogicalProcessorNumber)) {
+    AsmCliHlt();
+  }
 
   //
-  // Enter task loop
+  // Signal AP completion through its own task slot, and enter task loop
   //
   WaitTask = TRUE;
   State  = & (mSysCpuTask.CpuTask[Index].State);
@@ -407,11 +406,6 @@ MpInit (
       //
       ApDataPtr->ApCounter = 0;
 
-      //
-      // Initialize the mMpDataStructure
-      //
-      mMpDataStruct.ApDoneCounter    = 0;
-
       //
       // Get SMM Base Info for S3 resume
       //
@@ -422,9 +416,9 @@ MpInit (
       }
 
       //
-      // Send Init-SIPI-SIPI to all APs and wait for completion
-      // It includes a 200us delay for AP's check-in
-      // If it is not long enough, extra delay can be added after this call
+      // Send Init-SIPI-SIPI to all APs. It includes a 200us delay for AP's
+      // check-in. The APs then run CpuInit on their own while the BSP returns
+      // to continue Stage2; EnumMpInitRun collects the result later.
       //
       SendInitSipiSipiAllExcludingSelf ((UINT32)(UINTN)ApBuffer);
 
@@ -440,30 +434,32 @@ MpInit (
     } else {
       DEBUG ((DEBUG_INFO, "MP Init (Run)\n"));
 
-      //
-      // Wait for task done
-      //
       ApDataPtr = (AP_DATA_STRUCT *) (ApBuffer + mStubCodeSize);
       ApCounter = (volatile UINT32 *)&ApDataPtr->ApCounter;
-      TimeOutCounter = 0;
-      while (TimeOutCounter < AP_TASK_TIMEOUT_CNT) {
-        if (mMpDataStruct.ApDoneCounter == *ApCounter) {
-          break;
-        }
-        MicroSecondDelay (AP_TASK_TIMEOUT_UNIT);
-        TimeOutCounter++ ;
-      }
-
-
-      CpuCount = (*ApCounter) + 1;
+      CpuCount  = (*ApCounter) + 1;
       DEBUG ((DEBUG_INFO, "Detected %d CPU threads\n", CpuCount));
-      if (TimeOutCounter == AP_TASK_TIMEOUT_CNT) {
-        DEBUG ((DEBUG_INFO, "MPINIT timeout with %d APs completed.\n", mMpDataStruct.ApDoneCounter));
-      }
 
       if (CpuCount > FixedPcdGet32 (PcdCpuMaxLogicalProcessorNumber)) {
         CpuCount =  FixedPcdGet32 (PcdCpuMaxLogicalProcessorNumber);
-        DEBUG ((DEBUG_WARN, "PcdCpuMaxLogicalProcessorNumber is too small !\n", mMpDataStruct.ApDoneCounter));
+        DEBUG ((DEBUG_WARN, "PcdCpuMaxLogicalProcessorNumber is too small !\n"));
+      }
+
+      //
+      // Wait for task done. Each AP marks its own task slot ready once CpuInit
+      // is done, so usually all of them are already ready by now.
+      //
+      TimeOutCounter = AP_TASK_TIMEOUT_UNIT * AP_TASK_TIMEOUT_CNT;
+      Index = 1;
+      while (Index < CpuCount) {
+        if (mSysCpuTask.CpuTask[Index].State == EnumCpuReady) {
+          Index++;
+        } else if (TimeOutCounter > 0) {
+          MicroSecondDelay (1);
+          TimeOutCounter--;
+        } else {
+          DEBUG ((DEBUG_INFO, "MPINIT timeout with %d APs completed.\n", Index - 1));
+          break;
+        }
       }
 
       mSysCpuInfo.CpuCount = CpuCount;
@@ -513,6 +509,13 @@ MpInit (
       //
       SendInitIpiAllExcludingSelf();
 
+      //
+      // Mark the APs as gone so that no more tasks are handed to them
+      //
+      for (Index = 1; Index < mSysCpuTask.CpuCount; Index++) {
+        mSysCpuTask.CpuTask[Index].State = EnumCpuEnd;
+      }
+
       mMpInitPhase = EnumMpInitDone;
     }
   }
@@ -67,7 +67,6 @@ typedef struct {
 } AP_DATA_STRUCT;
 
 typedef struct {
-  UINT32            ApDoneCounter;
   UINT32            SmmRebaseDoneCounter;
   SPIN_LOCK         SpinLock;
 } MP_DATA_EXCHANGE_STRUCT;
@@ -10,7 +10,6 @@
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/PciExpressLib.h>
-#include <Library/SortLib.h>
 #include <Library/HobLib.h>
 #include <InternalPciEnumerationLib.h>
 #include <Library/BootloaderCommonLib.h>
@@ -19,6 +18,11 @@
 
 #define  DEBUG_PCI_ENUM    0
 
+//
+// One BAR bucket per alignment bit, plus one for BARs without alignment
+//
+#define  PCI_BAR_BUCKETS   65
+
 UINT8   *mPoolPtr;
 
 STATIC PCI_RES_ALLOC_TABLE  *mResAllocTablePtr;
@@ -904,32 +908,136 @@ PciScanBus (
 }
 
 /**
-  The function is called by PerformInsertionSortList to sort PCI Bar by its alignment.
+  Get the alignment bucket of a PCI BAR.
 
-  @param[in] Buffer1         The pointer to first list entry.
-  @param[in] Buffer2         The pointer to second list entry.
+  Buckets are indexed by the highest bit of the alignment mask, so a
+  larger alignment always falls into a higher bucket.
 
-  @retval 0                  Buffer2 alignment is less than or equal to Buffer1 alignment.
-  @retval 1                  Buffer2 alignment is greater than Buffer1 alignment.
+  @param[in] PciBar          The pointer to the PCI BAR.
+
+  @retval                    The bucket index, 0 to PCI_BAR_BUCKETS - 1.
 
 **/
-INTN
-EFIAPI
-ComparePciBarRes (
-  IN CONST VOID                 *Buffer1,
-  IN CONST VOID                 *Buffer2
+STATIC
+UINT32
+GetPciBarBucket (
+  IN PCI_BAR                    *PciBar
   )
 {
-  PCI_BAR_RESOURCE      *NewResBar;
-  PCI_BAR_RESOURCE      *CurrResBar;
+  if (PciBar->Alignment == 0) {
+    return 0;
+  }
 
-  NewResBar   = PCI_BAR_RESOURCE_FROM_LINK (Buffer1);
-  CurrResBar  = PCI_BAR_RESOURCE_FROM_LINK (Buffer2);
+  return (UINT32)HighBitSet64 (PciBar->Alignment) + 1;
+}
 
-  //
-  // Descending Order
-  //
-  return (CurrResBar->PciBar->Alignment > NewResBar->PciBar->Alignment) ? 1 : 0;
+/**
+  Add a PCI BAR to the tail of its alignment bucket.
+
+  @param[in] Buckets         The alignment bucket list heads.
+  @param[in] PciBar          The pointer to the PCI BAR.
+
+**/
+STATIC
+VOID
+AddPciBarResource (
+  IN LIST_ENTRY                 *Buckets,
+  IN PCI_BAR                    *PciBar
+  )
+{
+  PCI_BAR_RESOURCE      *PciBarRes;
+
+  PciBarRes = (PCI_BAR_RESOURCE *)PciAllocatePool (sizeof (PCI_BAR_RESOURCE));
+  PciBarRes->PciBar = PciBar;
+  InsertTailList (&Buckets[GetPciBarBucket (PciBar)], &PciBarRes->Link);
+}
+
+/**
+  Move the BAR with the largest alignment pad to the tail of a bucket.
+
+  All BARs of a bucket have the same alignment, and every BAR but the last
+  one placed is padded up to it. Placing the BAR with the largest pad last
+  gives the smallest span for the bucket.
+
+  @param[in] Bucket          The alignment bucket list head.
+
+**/
+STATIC
+VOID
+MoveLargestPadToTail (
+  IN LIST_ENTRY                 *Bucket
+  )
+{
+  LIST_ENTRY            *CurrentLink;
+  PCI_BAR_RESOURCE      *PciBarRes;
+  PCI_BAR_RESOURCE      *LargestRes;
+  UINT64                 Pad;
+  UINT64                 LargestPad;
+
+  LargestRes  = NULL;
+  LargestPad  = 0;
+  CurrentLink = Bucket->ForwardLink;
+  while (CurrentLink != Bucket) {
+    PciBarRes = PCI_BAR_RESOURCE_FROM_LINK (CurrentLink);
+    Pad = ALIGN (PciBarRes->PciBar->Length, PciBarRes->PciBar->Alignment) - PciBarRes->PciBar->Length;
+    if (Pad > LargestPad) {
+      LargestPad = Pad;
+      LargestRes = PciBarRes;
+    }
+    CurrentLink = CurrentLink->ForwardLink;
+  }
+
+  if (LargestRes != NULL) {
+    RemoveEntryList (&LargestRes->Link);
+    InsertTailList (Bucket, &LargestRes->Link);
+  }
+}
+
+/**
+  Place BARs with a smaller alignment into an alignment hole.
+
+  A hole is left when a bridge window length is not a multiple of the
+  alignment of the next BAR. The smaller buckets are scanned from the
+  largest alignment down and every BAR fitting below the limit is
+  assigned and removed from its bucket.
+
+  @param[in] Buckets         The alignment bucket list heads.
+  @param[in] Bucket          The bucket of the BAR that caused the hole.
+  @param[in] Base            The start of the hole.
+  @param[in] Limit           The end of the hole.
+
+  @retval                    The first free address after the placed BARs.
+
+**/
+STATIC
+UINT64
+FillPciBarHole (
+  IN LIST_ENTRY                 *Buckets,
+  IN UINT32                      Bucket,
+  IN UINT64                      Base,
+  IN UINT64                      Limit
+  )
+{
+  LIST_ENTRY            *CurrentLink;
+  PCI_BAR_RESOURCE      *PciBarRes;
+  UINT64                 Start;
+
+  while ((Bucket > 0) && (Base < Limit)) {
+    Bucket--;
+    CurrentLink = Buckets[Bucket].ForwardLink;
+    while ((CurrentLink != &Buckets[Bucket]) && (Base < Limit)) {
+      PciBarRes   = PCI_BAR_RESOURCE_FROM_LINK (CurrentLink);
+      CurrentLink = CurrentLink->ForwardLink;
+      Start = ALIGN (Base, PciBarRes->PciBar->Alignment);
+      if (Start + PciBarRes->PciBar->Length <= Limit) {
+        PciBarRes->PciBar->BaseAddress = Start;
+        Base = Start + PciBarRes->PciBar->Length;
+        RemoveEntryList (&PciBarRes->Link);
+      }
+    }
+  }
+
+  return Base;
 }
 
 /**
@@ -1131,17 +1239,41 @@ CalculateResource (
   LIST_ENTRY                *CurrentLink;
   PCI_IO_DEVICE             *PciIoDevice;
   UINT32                     Idx;
-  PCI_BAR_RESOURCE           ParentRes;
+  UINT32                     Bucket;
+  LIST_ENTRY                *Buckets;
   PCI_BAR_RESOURCE          *PciBarRes;
+  PCI_BAR                   *PciBar;
+  VOID                      *PoolMark;
   UINT64                     Base;
+  UINT64                     Start;
   UINT64                     Alignment;
 
   if ((BarType == PciBarTypeUnknown) || (BarType > PciBarTypePMem64)) {
     return;
   }
 
-  ParentRes.PciBar = NULL;
-  InitializeListHead (&ParentRes.Link);
+  //
+  // Size the bridge windows of the next level first
+  //
+  CurrentLink = Parent->ChildList.ForwardLink;
+  while (CurrentLink != NULL && CurrentLink != &Parent->ChildList) {
+    PciIoDevice = PCI_IO_DEVICE_FROM_LINK (CurrentLink);
+    if (PciIoDevice->ChildList.ForwardLink != &PciIoDevice->ChildList) {
+      CalculateResource (PciIoDevice, BarType);
+    }
+    CurrentLink = CurrentLink->ForwardLink;
+  }
+
+  //
+  // Bucket the BARs of this level by alignment. The bucket nodes are only
+  // needed here, so the pool is rolled back once the BARs are assigned.
+  //
+  PoolMark = GetAllocationPool ();
+  Buckets  = (LIST_ENTRY *)PciAllocatePool (sizeof (LIST_ENTRY) * PCI_BAR_BUCKETS);
+  for (Bucket = 0; Bucket < PCI_BAR_BUCKETS; Bucket++) {
+    InitializeListHead (&Buckets[Bucket]);
+  }
+
   CurrentLink = Parent->ChildList.ForwardLink;
   while (CurrentLink != NULL && CurrentLink != &Parent->ChildList) {
     PciIoDevice = PCI_IO_DEVICE_FROM_LINK (CurrentLink);
@@ -1151,44 +1283,50 @@ CalculateResource (
       //
       for (Idx = 0; Idx < PPB_MAX_BAR; Idx++) {
         if ((PciIoDevice->PpbBar[Idx].Length > 0) && (PciIoDevice->PpbBar[Idx].BarType == BarType)) {
-          PciBarRes = (PCI_BAR_RESOURCE *)PciAllocatePool (sizeof (PCI_BAR_RESOURCE));
-          PciBarRes->PciBar = &PciIoDevice->PpbBar[Idx];
-          PerformInsertionSortList (&ParentRes.Link, &PciBarRes->Link, ComparePciBarRes);
+          AddPciBarResource (Buckets, &PciIoDevice->PpbBar[Idx]);
         }
       }
-      CalculateResource (PciIoDevice, BarType);
     }
     for (Idx = 0; Idx < PCI_MAX_BAR; Idx++) {
       if (PciIoDevice->PciBar[Idx].BarType == BarType) {
-        PciBarRes = (PCI_BAR_RESOURCE *)PciAllocatePool (sizeof (PCI_BAR_RESOURCE));
-        PciBarRes->PciBar = &PciIoDevice->PciBar[Idx];
-        PerformInsertionSortList (&ParentRes.Link, &PciBarRes->Link, ComparePciBarRes);
+        AddPciBarResource (Buckets, &PciIoDevice->PciBar[Idx]);
       }
       if (FeaturePcdGet (PcdSrIovSupport)) {
         if (PciIoDevice->VfPciBar[Idx].BarType == BarType) {
-          PciBarRes = (PCI_BAR_RESOURCE *)PciAllocatePool (sizeof (PCI_BAR_RESOURCE));
-          PciBarRes->PciBar = &PciIoDevice->VfPciBar[Idx];
-          PerformInsertionSortList (&ParentRes.Link, &PciBarRes->Link, ComparePciBarRes);
+          AddPciBarResource (Buckets, &PciIoDevice->VfPciBar[Idx]);
         }
       }
     }
     CurrentLink = CurrentLink->ForwardLink;
   }
 
+  //
+  // Assign from the largest alignment down so that the BARs pack without
+  // holes. A hole in front of a BAR, left by a bridge window length, is
+  // filled with BARs from the smaller buckets first.
+  //
   Base      = 0;
   Alignment = 0;
-  CurrentLink = ParentRes.Link.ForwardLink;
-  while (CurrentLink != NULL && CurrentLink != &ParentRes.Link) {
-    PciBarRes = PCI_BAR_RESOURCE_FROM_LINK (CurrentLink);
-    if (Alignment == 0) {
-      Alignment = PciBarRes->PciBar->Alignment;
+  Bucket    = PCI_BAR_BUCKETS;
+  while (Bucket > 0) {
+    Bucket--;
+    MoveLargestPadToTail (&Buckets[Bucket]);
+    while (!IsListEmpty (&Buckets[Bucket])) {
+      PciBarRes = PCI_BAR_RESOURCE_FROM_LINK (GetFirstNode (&Buckets[Bucket]));
+      RemoveEntryList (&PciBarRes->Link);
+      PciBar    = PciBarRes->PciBar;
+      Alignment = MAX (Alignment, PciBar->Alignment);
+      Start     = ALIGN (Base, PciBar->Alignment);
+      if (Start > Base) {
+        Base = FillPciBarHole (Buckets, Bucket, Base, Start);
+      }
+      PciBar->BaseAddress = Start;
+      Base = Start + PciBar->Length;
     }
-    Base = ALIGN (Base, PciBarRes->PciBar->Alignment);
-    PciBarRes->PciBar->BaseAddress = Base;
-    Base += PciBarRes->PciBar->Length;
-    CurrentLink = CurrentLink->ForwardLink;
   }
 
+  SetAllocationPool (PoolMark);
+
   if (BarType <= PciBarTypeIo32) {
     if (Alignment < 0xFFF) {
       Alignment = 0xFFF;
@@ -0,0 +1,363 @@
+/** @file
+  S3 boot script: register writes and polls recorded on the normal
+  boot path and replayed on the S3 resume path.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/PciLib.h>
+#include <Library/TimerLib.h>
+#include <Library/BootloaderCoreLib.h>
+#include <Library/S3SaveRestoreLib.h>
+
+/**
+  Check that a register type and access width are supported.
+
+  @param[in]  Type      Register type.
+  @param[in]  Width     Access width in bytes.
+
+  @retval     TRUE      Supported.
+  @retval     FALSE     Not supported.
+
+**/
+STATIC
+BOOLEAN
+IsValidAccess (
+  IN  UINT8     Type,
+  IN  UINT8     Width
+  )
+{
+  if (Type == S3_BOOT_SCRIPT_MSR) {
+    return (BOOLEAN)(Width == 8);
+  }
+
+  if (Type > S3_BOOT_SCRIPT_MSR) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)((Width == 1) || (Width == 2) || (Width == 4));
+}
+
+/**
+  Read a register.
+
+  @param[in]  Type      Register type.
+  @param[in]  Width     Access width in bytes.
+  @param[in]  Address   Register address.
+
+  @retval               The register value.
+
+**/
+STATIC
+UINT64
+RegisterRead (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address
+  )
+{
+  switch (Type) {
+  case S3_BOOT_SCRIPT_MMIO:
+    return (Width == 1) ? MmioRead8 (Address) : ((Width == 2) ? MmioRead16 (Address) : MmioRead32 (Address));
+  case S3_BOOT_SCRIPT_IO:
+    return (Width == 1) ? IoRead8 (Address) : ((Width == 2) ? IoRead16 (Address) : IoRead32 (Address));
+  case S3_BOOT_SCRIPT_PCI:
+    return (Width == 1) ? PciRead8 (Address) : ((Width == 2) ? PciRead16 (Address) : PciRead32 (Address));
+  default:
+    return AsmReadMsr64 (Address);
+  }
+}
+
+/**
+  Write a register, optionally preserving the bits outside of Mask.
+
+  @param[in]  Type      Register type.
+  @param[in]  Width     Access width in bytes.
+  @param[in]  Address   Register address.
+  @param[in]  Value     Value to write.
+  @param[in]  Mask      Bits to update, or 0 to write the full register.
+
+**/
+STATIC
+VOID
+RegisterWrite (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask
+  )
+{
+  if (Mask != 0) {
+    Value = (RegisterRead (Type, Width, Address) & ~Mask) | (Value & Mask);
+  }
+
+  switch (Type) {
+  case S3_BOOT_SCRIPT_MMIO:
+    if (Width == 1) {
+      MmioWrite8 (Address, (UINT8)Value);
+    } else if (Width == 2) {
+      MmioWrite16 (Address, (UINT16)Value);
+    } else {
+      MmioWrite32 (Address, (UINT32)Value);
+    }
+    break;
+  case S3_BOOT_SCRIPT_IO:
+    if (Width == 1) {
+      IoWrite8 (Address, (UINT8)Value);
+    } else if (Width == 2) {
+      IoWrite16 (Address, (UINT16)Value);
+    } else {
+      IoWrite32 (Address, (UINT32)Value);
+    }
+    break;
+  case S3_BOOT_SCRIPT_PCI:
+    if (Width == 1) {
+      PciWrite8 (Address, (UINT8)Value);
+    } else if (Width == 2) {
+      PciWrite16 (Address, (UINT16)Value);
+    } else {
+      PciWrite32 (Address, (UINT32)Value);
+    }
+    break;
+  default:
+    AsmWriteMsr64 (Address, Value);
+    break;
+  }
+}
+
+/**
+  Poll a register until the masked value matches.
+
+  @param[in]  Type      Register type.
+  @param[in]  Width     Access width in bytes.
+  @param[in]  Address   Register address.
+  @param[in]  Value     Expected value of the masked register.
+  @param[in]  Mask      Bits to compare.
+  @param[in]  Timeout   Timeout in microseconds.
+
+  @retval     EFI_SUCCESS   The condition was met.
+  @retval     EFI_TIMEOUT   The condition was not met in time.
+
+**/
+STATIC
+EFI_STATUS
+RegisterPoll (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask,
+  IN  UINT32    Timeout
+  )
+{
+  while ((RegisterRead (Type, Width, Address) & Mask) != (Value & Mask)) {
+    if (Timeout == 0) {
+      return EFI_TIMEOUT;
+    }
+    MicroSecondDelay (1);
+    Timeout--;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Append an entry to the S3 boot script.
+
+  Nothing is recorded on the S3 resume path, where the script is replayed.
+
+  @param[in]  OpCode    S3_BOOT_SCRIPT_OP_WRITE or S3_BOOT_SCRIPT_OP_POLL.
+  @param[in]  Type      Register type.
+  @param[in]  Width     Access width in bytes.
+  @param[in]  Address   Register address.
+  @param[in]  Value     Value to write, or expected value for a poll.
+  @param[in]  Mask      Bits to update or compare.
+  @param[in]  Timeout   Poll timeout in microseconds.
+
+  @retval     EFI_SUCCESS           The entry was recorded.
+  @retval     EFI_OUT_OF_RESOURCES  The script is full.
+
+**/
+STATIC
+EFI_STATUS
+RecordEntry (
+  IN  UINT8     OpCode,
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask,
+  IN  UINT32    Timeout
+  )
+{
+  LOADER_GLOBAL_DATA    *LdrGlobal;
+  S3_DATA               *S3Data;
+  S3_BOOT_SCRIPT_ENTRY  *Entry;
+
+  if (GetBootMode () == BOOT_ON_S3_RESUME) {
+    return EFI_SUCCESS;
+  }
+
+  LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer ();
+  S3Data    = (S3_DATA *)LdrGlobal->S3DataPtr;
+  if ((S3Data == NULL) || (S3Data->BootScriptCount >= S3_BOOT_SCRIPT_ENTRIES)) {
+    DEBUG ((DEBUG_ERROR, "S3 boot script is full!\n"));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Entry = &S3Data->BootScript[S3Data->BootScriptCount];
+  Entry->OpCode   = OpCode;
+  Entry->Type     = Type;
+  Entry->Width    = Width;
+  Entry->Reserved = 0;
+  Entry->Address  = Address;
+  Entry->Timeout  = Timeout;
+  Entry->Value    = Value;
+  Entry->Mask     = Mask;
+  S3Data->BootScriptCount++;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Write a register and record the write in the S3 boot script.
+
+  When Mask is not zero only the bits set in Mask are updated, the other
+  bits keep the value read back from the register. The write is recorded
+  only on the normal boot path, and is replayed by S3BootScriptExecute ()
+  on S3 resume.
+
+  @param[in]  Type                  S3_BOOT_SCRIPT_MMIO/IO/PCI/MSR.
+  @param[in]  Width                 Access width in bytes (MSR accesses are always 8).
+  @param[in]  Address               Register address.
+  @param[in]  Value                 Value to write.
+  @param[in]  Mask                  Bits to update, or 0 to write the full register.
+
+  @retval     EFI_SUCCESS           The register was written and recorded.
+  @retval     EFI_INVALID_PARAMETER Invalid Type or Width.
+  @retval     EFI_OUT_OF_RESOURCES  The register was written but the script is full.
+
+**/
+EFI_STATUS
+EFIAPI
+S3BootScriptWrite (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask
+  )
+{
+  if (!IsValidAccess (Type, Width)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  RegisterWrite (Type, Width, Address, Value, Mask);
+
+  return RecordEntry (S3_BOOT_SCRIPT_OP_WRITE, Type, Width, Address, Value, Mask, 0);
+}
+
+/**
+  Poll a register until the masked value matches, and record the poll
+  in the S3 boot script so it is repeated at the same point on resume.
+
+  @param[in]  Type                  S3_BOOT_SCRIPT_MMIO/IO/PCI/MSR.
+  @param[in]  Width                 Access width in bytes (MSR accesses are always 8).
+  @param[in]  Address               Register address.
+  @param[in]  Value                 Expected value of the masked register.
+  @param[in]  Mask                  Bits to compare.
+  @param[in]  Timeout               Timeout in microseconds.
+
+  @retval     EFI_SUCCESS           The condition was met.
+  @retval     EFI_TIMEOUT           The condition was not met in time.
+  @retval     EFI_INVALID_PARAMETER Invalid Type or Width.
+  @retval     EFI_OUT_OF_RESOURCES  The poll completed but the script is full.
+
+**/
+EFI_STATUS
+EFIAPI
+S3BootScriptPoll (
+  IN  UINT8     Type,
+  IN  UINT8     Width,
+  IN  UINT32    Address,
+  IN  UINT64    Value,
+  IN  UINT64    Mask,
+  IN  UINT32    Timeout
+  )
+{
+  EFI_STATUS    Status;
+
+  if (!IsValidAccess (Type, Width)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = RegisterPoll (Type, Width, Address, Value, Mask, Timeout);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return RecordEntry (S3_BOOT_SCRIPT_OP_POLL, Type, Width, Address, Value, Mask, Timeout);
+}
+
+/**
+  Replay the S3 boot script recorded on the normal boot path.
+  This function is only called in the S3 resume path.
+
+  @retval     EFI_SUCCESS           The script was replayed.
+  @retval     EFI_NOT_FOUND         No script was recorded.
+  @retval     EFI_TIMEOUT           A poll entry did not complete in time.
+  @retval     EFI_INVALID_PARAMETER The script contains an invalid entry.
+
+**/
+EFI_STATUS
+EFIAPI
+S3BootScriptExecute (
+  VOID
+  )
+{
+  LOADER_GLOBAL_DATA    *LdrGlobal;
+  S3_DATA               *S3Data;
+  S3_BOOT_SCRIPT_ENTRY  *Entry;
+  EFI_STATUS             Status;
+  UINT32                 Index;
+
+  LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer ();
+  S3Data    = (S3_DATA *)LdrGlobal->S3DataPtr;
+  if ((S3Data == NULL) || (S3Data->BootScriptCount == 0)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (S3Data->BootScriptCount > S3_BOOT_SCRIPT_ENTRIES) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  for (Index = 0; Index < S3Data->BootScriptCount; Index++) {
+    Entry = &S3Data->BootScript[Index];
+    if (!IsValidAccess (Entry->Type, Entry->Width)) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if (Entry->OpCode == S3_BOOT_SCRIPT_OP_WRITE) {
+      RegisterWrite (Entry->Type, Entry->Width, Entry->Address, Entry->Value, Entry->Mask);
+    } else if (Entry->OpCode == S3_BOOT_SCRIPT_OP_POLL) {
+      Status = RegisterPoll (Entry->Type, Entry->Width, Entry->Address, Entry->Value, Entry->Mask, Entry->Timeout);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "S3 boot script poll @ 0x%08X timed out!\n", Entry->Address));
+        return Status;
+      }
+    } else {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "S3 boot script replayed %d entries\n", S3Data->BootScriptCount));
+
+  return EFI_SUCCESS;
+}
@@ -259,6 +259,11 @@ NormalBootPath (
     AddMeasurePoint (0x31E0);
   }
 
+  if (MEASURED_BOOT_ENABLED ()) {
+    // Queued PCR extends must reach the TPM before the payload can read PCRs
+    TpmFlushPendingExtends ();
+  }
+
   AddMeasurePoint (0x31F0);
 
   DEBUG ((DEBUG_INFO, "HOB @ 0x%08X\n", LdrGlobal->LdrHobList));
@@ -306,6 +311,7 @@ S3ResumePath (
 {
   LOADER_GLOBAL_DATA             *LdrGlobal;
   S3_DATA                        *S3Data;
+  EFI_STATUS                      Status;
 
   LdrGlobal = (LOADER_GLOBAL_DATA *)GetLoaderGlobalDataPointer();
   S3Data    = (S3_DATA *)LdrGlobal->S3DataPtr;
@@ -315,6 +321,12 @@ S3ResumePath (
     AddMeasurePoint (0x31C0);
   }
 
+  // Replay the register writes recorded on the normal boot path
+  Status = S3BootScriptExecute ();
+  if (EFI_ERROR (Status) && (Status != EFI_NOT_FOUND)) {
+    CpuHaltWithStatus ("S3 boot script replay failed !", Status);
+  }
+
   // Call the board notification
   BoardInit (EndOfStages);
 
@@ -355,6 +367,7 @@ SecStartup (
 {
   EFI_STATUS                      Status;
   EFI_STATUS                      SubStatus;
+  EFI_STATUS                      MpStatus;
   STAGE2_PARAM                   *Stage2Param;
   VOID                           *NvsData;
   UINT32                          MrcDataLen;
@@ -458,21 +471,15 @@ SecStartup (
 
   // MP Init phase 1
   if (FixedPcdGetBool (PcdSmpEnabled)) {
-    Status = MpInit (EnumMpInitWakeup);
+    MpStatus = MpInit (EnumMpInitWakeup);
   } else {
     DEBUG ((DEBUG_INIT, "BSP Init\n"));
     BspInit ();
+    MpStatus = EFI_SUCCESS;
   }
   AddMeasurePoint (0x3060);
 
-  // MP Init phase 2
-  if (FixedPcdGetBool (PcdSmpEnabled) && !EFI_ERROR (Status)) {
-    Status = MpInit (EnumMpInitRun);
-    AddMeasurePoint (0x3080);
-  }
-  ASSERT_EFI_ERROR (Status);
-
-  // PCI Enumeration
+  // PCI Enumeration, overlapped with the APs running CpuInit
   BoardInit (PrePciEnumeration);
   AddMeasurePoint (0x3090);
 
@@ -484,7 +491,26 @@ SecStartup (
 
     BoardInit (PostPciEnumeration);
     AddMeasurePoint (0x30B0);
+  }
 
+  // MP Init phase 2
+  if (FixedPcdGetBool (PcdSmpEnabled) && !EFI_ERROR (MpStatus)) {
+    MpStatus = MpInit (EnumMpInitRun);
+    AddMeasurePoint (0x3080);
+    if (!EFI_ERROR (MpStatus)) {
+      // Idle APs can take parallel work from now on
+      CpuTaskPoolInit (MpGetTask ());
+    }
+  }
+  ASSERT_EFI_ERROR (MpStatus);
+
+  if (FeaturePcdGet (PcdMemoryScrubEnabled) && (GetDmaBufferPtr () != NULL)) {
+    // Clear the DMA buffer on all CPUs before any payload driver can see it
+    CpuTaskPoolScrubMemory ((UINTN)GetDmaBufferPtr (), PcdGet32 (PcdDmaBufferSize), 0);
+    AddMeasurePoint (0x3085);
+  }
+
+  if (FixedPcdGetBool (PcdPciEnumEnabled)) {
     if (!EFI_ERROR (Status)) {
       if (BootMode != BOOT_ON_FLASH_UPDATE) {
         BoardNotifyPhase (PostPciEnumeration);
@@ -38,6 +38,7 @@
 #include <Library/LiteFvLib.h>
 #include <Library/SortLib.h>
 #include <Library/StageLib.h>
+#include <Library/S3SaveRestoreLib.h>
 #include <Library/ThunkLib.h>
 #include <Library/LocalApicLib.h>
 #include <Library/ContainerLib.h>
@@ -59,6 +60,7 @@
 #include <Library/DebugAgentLib.h>
 #include <Library/ElfLib.h>
 #include <Library/SmbiosInitLib.h>
+#include <Library/CpuTaskPoolLib.h>
 #include <VerInfo.h>
 
 #define UIMAGE_FIT_MAGIC               (0x56190527)
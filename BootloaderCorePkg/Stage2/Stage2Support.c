@@ -628,9 +628,10 @@ PrintStackHeapInfo (
 
   DEBUG ((
            DEBUG_INFO,
-           "Stage2 heap: 0x%X (0x%X used, 0x%X free)\n",
+           "Stage2 heap: 0x%X (0x%X used, 0x%X temp peak, 0x%X free)\n",
            LdrGlobal->MemPoolEnd - LdrGlobal->MemPoolStart,
            LdrGlobal->MemPoolEnd - LdrGlobal->MemPoolCurrTop,
+           LdrGlobal->MemPoolMaxBottom - LdrGlobal->MemPoolStart,
            LdrGlobal->MemPoolCurrTop - LdrGlobal->MemPoolStart
            ));
 }
@@ -18,8 +18,11 @@ import subprocess
 import struct
 import hashlib
 import string
+import time
+import threading
 from   ctypes import *
 from   functools import reduce
+from   concurrent.futures import ThreadPoolExecutor, wait, FIRST_COMPLETED
 from   importlib.machinery import SourceFileLoader
 from   SingleSign import *
 
@@ -53,6 +56,14 @@ HASH_TYPE_VALUE = {
 # Hash values defined should match with cryptolib.h
 HASH_VAL_STRING = dict(map(reversed, HASH_TYPE_VALUE.items()))
 
+# Output cache for compress/sign steps, disabled while the directory is empty
+BUILD_CACHE = {
+            'dir'   : '',
+            'hit'   : 0,
+            'miss'  : 0,
+            'lock'  : threading.Lock(),
+    }
+
 AUTH_TYPE_HASH_VALUE = {
             # Auth_type      : Hash_type
             "SHA2_256"       : 1,
@@ -111,6 +122,7 @@ class LZ_HEADER(Structure):
         b'LZDM' : 'Dummy',
         b'LZ4 ' : 'Lz4',
         b'LZMA' : 'Lzma',
+        b'LZMF' : 'LzmaF86',
     }
 
 def print_bytes (data, indent=0, offset=0, show_ascii = False):
@@ -238,6 +250,105 @@ def run_process (arg_list, print_cmd = False, capture_out = False):
 
     return output
 
+def set_build_cache_dir (cache_dir):
+    # An empty directory disables the cache
+    if cache_dir and not os.path.exists(cache_dir):
+        os.makedirs(cache_dir)
+    BUILD_CACHE['dir']  = cache_dir
+    BUILD_CACHE['hit']  = 0
+    BUILD_CACHE['miss'] = 0
+
+def get_build_cache_key (*inputs):
+    # Content hash of everything that determines a step output
+    if not BUILD_CACHE['dir']:
+        return ''
+    digest = hashlib.sha256()
+    for each in inputs:
+        if not isinstance(each, (bytes, bytearray)):
+            each = str(each).encode()
+        digest.update(b'%d:' % len(each))
+        digest.update(each)
+    return digest.hexdigest()
+
+def get_cached_file (cache_key, out_file):
+    if not cache_key:
+        return False
+    cache_file = os.path.join(BUILD_CACHE['dir'], cache_key)
+    hit = os.path.exists(cache_file)
+    if hit:
+        shutil.copyfile (cache_file, out_file)
+    with BUILD_CACHE['lock']:
+        BUILD_CACHE['hit' if hit else 'miss'] += 1
+    return hit
+
+def put_cached_file (cache_key, in_file):
+    if not cache_key:
+        return
+    # Write to a temporary file first so that a parallel reader never sees a partial entry
+    cache_file = os.path.join(BUILD_CACHE['dir'], cache_key)
+    temp_file  = '%s.%d.tmp' % (cache_file, threading.get_ident())
+    shutil.copyfile (in_file, temp_file)
+    os.replace (temp_file, cache_file)
+
+def get_key_file_data (in_key):
+    return get_file_data (get_key_from_store (in_key))
+
+def run_parallel (func, args_list, jobs = 0):
+    # Run func for each argument tuple on a thread pool, and return the results in order
+    if jobs == 0:
+        jobs = os.cpu_count() or 1
+    if jobs == 1 or len(args_list) < 2:
+        return [func(*args) for args in args_list]
+    with ThreadPoolExecutor(max_workers = jobs) as pool:
+        futures = [pool.submit(func, *args) for args in args_list]
+        return [each.result() for each in futures]
+
+class BuildStepRunner:
+    # Run named build steps in parallel once the steps they depend on are done,
+    # and record the time spent in each one
+    def __init__ (self, jobs = 0):
+        self.jobs  = jobs if jobs else (os.cpu_count() or 1)
+        self.steps = []
+        self.times = {}
+
+    def add (self, name, func, deps = []):
+        self.steps.append ((name, func, deps))
+
+    def run_step (self, name, func):
+        start = time.time()
+        func ()
+        self.times[name] = (start - self.start, time.time() - start)
+
+    def run (self):
+        self.start = time.time()
+        pending = list(self.steps)
+        running = {}
+        done    = set()
+        with ThreadPoolExecutor(max_workers = self.jobs) as pool:
+            while pending or running:
+                for step in list(pending):
+                    name, func, deps = step
+                    if all(dep in done for dep in deps):
+                        pending.remove (step)
+                        running[pool.submit(self.run_step, name, func)] = name
+                if not running:
+                    raise Exception ("Unresolved build step dependencies: %s !" % ', '.join([step[0] for step in pending]))
+                finished, _ = wait(running, return_when = FIRST_COMPLETED)
+                for each in finished:
+                    name = running.pop(each)
+                    each.result()
+                    done.add (name)
+        self.times['TOTAL'] = (0, time.time() - self.start)
+
+    def report (self):
+        lines = ['%-20s %10s %10s' % ('Step', 'Start(s)', 'Time(s)')]
+        for name, _, _ in self.steps + [('TOTAL', None, None)]:
+            if name in self.times:
+                lines.append ('%-20s %10.2f %10.2f' % ((name,) + self.times[name]))
+        if BUILD_CACHE['dir']:
+            lines.append ('Cache: %d hits, %d misses in %s' % (BUILD_CACHE['hit'], BUILD_CACHE['miss'], BUILD_CACHE['dir']))
+        return '\n'.join(lines)
+
 # Adjust hash type algorithm based on Public key file
 def adjust_hash_type (pub_key_file):
     key_type =  get_key_type (pub_key_file)
@@ -252,6 +363,13 @@ def adjust_hash_type (pub_key_file):
 
 def rsa_sign_file (priv_key, pub_key, hash_type, sign_scheme, in_file, out_file, inc_dat = False, inc_key = False):
 
+    cache_key = get_build_cache_key ('sign', get_key_file_data (priv_key) if BUILD_CACHE['dir'] else '',
+                                     hash_type, sign_scheme, inc_dat, inc_key, get_file_data(in_file) if BUILD_CACHE['dir'] else '')
+    if get_cached_file (cache_key, out_file):
+        if inc_key and pub_key:
+            gen_pub_key (priv_key, pub_key)
+        return
+
     bins = bytearray()
     if inc_dat:
         bins.extend(get_file_data(in_file))
@@ -273,6 +391,8 @@ def rsa_sign_file (priv_key, pub_key, hash_type, sign_scheme, in_file, out_file,
     if len(bins) != len(out_data):
         gen_file_from_object (out_file, bins)
 
+    put_cached_file (cache_key, out_file)
+
 def get_key_type (in_key):
 
     # Check in_key is file or key Id
@@ -311,7 +431,20 @@ def get_auth_hash_type (key_type, sign_scheme):
 
 def gen_pub_key (in_key, pub_key = None):
 
-    keydata = single_sign_gen_pub_key (in_key, pub_key)
+    cache_key = get_build_cache_key ('pubkey', get_key_file_data (in_key) if BUILD_CACHE['dir'] else '')
+    cache_file = os.path.join(BUILD_CACHE['dir'], cache_key) if cache_key else ''
+    if cache_key and os.path.exists(cache_file):
+        with BUILD_CACHE['lock']:
+            BUILD_CACHE['hit'] += 1
+        keydata = bytearray(get_file_data(cache_file))
+    else:
+        keydata = single_sign_gen_pub_key (in_key, pub_key)
+        if cache_key:
+            temp_file = '%s.%d.tmp' % (cache_file, threading.get_ident())
+            gen_file_from_object (temp_file, keydata)
+            os.replace (temp_file, cache_file)
+            with BUILD_CACHE['lock']:
+                BUILD_CACHE['miss'] += 1
 
     publickey = PUB_KEY_HDR()
     publickey.KeySize  = len(keydata)
@@ -344,6 +477,8 @@ def decompress (in_file, out_file, tool_dir = ''):
     temp   = os.path.splitext(out_file)[0] + '.tmp'
     if lz_hdr.signature == b"LZMA":
         alg = "Lzma"
+    elif lz_hdr.signature == b"LZMF":
+        alg = "LzmaF86"
     elif lz_hdr.signature == b"LZ4 ":
         alg = "Lz4"
     else:
@@ -354,7 +489,15 @@ def decompress (in_file, out_file, tool_dir = ''):
     fo.close()
 
     compress_tool = "%sCompress" % alg
-    if alg == "Lz4":
+    if alg == "LzmaF86":
+        # Same LZMA stream, with the x86 BCJ filter undone after decoding
+        cmdline = [
+            os.path.join (tool_dir, "LzmaCompress"),
+            "-d", "--f86",
+            "-o", out_file,
+            temp]
+        run_process (cmdline, False, True)
+    elif alg == "Lz4":
         try:
             cmdline = [
                 os.path.join (tool_dir, compress_tool),
@@ -398,6 +541,8 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
 
     if alg == "Lzma":
         sig = "LZMA"
+    elif alg == "LzmaF86":
+        sig = "LZMF"
     elif alg == "Tiano":
         sig = "LZUF"
     elif alg == "Lz4":
@@ -407,6 +552,10 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
     else:
         raise Exception ("Unsupported compression '%s' !" % alg)
 
+    cache_key = get_build_cache_key ('compress', sig, svn, get_file_data(in_file) if BUILD_CACHE['dir'] else '')
+    if get_cached_file (cache_key, out_file):
+        return out_file
+
     in_len = os.path.getsize(in_file)
     if in_len > 0:
         compress_tool = "%sCompress" % alg
@@ -440,6 +589,16 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
                 in_file]
             run_process (cmdline, False, True)
             compress_data = get_file_data(out_file)
+        elif sig == "LZMF":
+            # x86 BCJ filter converts relative CALL/JMP targets to absolute
+            # ones before LZMA, which improves the ratio on code images
+            cmdline = [
+                os.path.join (tool_dir, "LzmaCompress"),
+                "-e", "--f86",
+                "-o", out_file,
+                in_file]
+            run_process (cmdline, False, True)
+            compress_data = get_file_data(out_file)
     else:
         compress_data = bytearray()
 
@@ -453,4 +612,6 @@ def compress (in_file, alg, svn=0, out_path = '', tool_dir = ''):
     data.extend (compress_data)
     gen_file_from_object (out_file, data)
 
+    put_cached_file (cache_key, out_file)
+
     return out_file
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+## @ CompressBench.py
+# This script compares the compression algorithms supported by the
+# container and stage images on a set of binaries, and reports the
+# compression ratio and the host compression/decompression speed.
+#
+# Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import os
+import sys
+import glob
+import time
+import shutil
+import argparse
+import tempfile
+
+from CommonUtility import *
+
+script_dir = os.path.dirname(__file__)
+
+compress_algs = ['Lz4', 'Lzma', 'LzmaF86']
+
+
+def get_default_files ():
+    fv_dir = os.path.realpath (os.path.join (script_dir, '../../Build/BootloaderCorePkg'))
+    files  = []
+    for pattern in ['STAGE*.fd', 'PAYLOAD.bin', '*.efi']:
+        files.extend (glob.glob (os.path.join (fv_dir, '*', 'FV', pattern)))
+    return sorted (set (files))
+
+
+def bench_file (in_file, alg, out_dir, tool_dir, repeat):
+    lz_file  = os.path.join (out_dir, 'bench.lz')
+    bin_file = os.path.join (out_dir, 'bench.bin')
+
+    comp_time = None
+    for _ in range (repeat):
+        start = time.perf_counter ()
+        compress (in_file, alg, 0, lz_file, tool_dir)
+        comp_time = min (comp_time or 1e9, time.perf_counter () - start)
+
+    dec_time = None
+    for _ in range (repeat):
+        start = time.perf_counter ()
+        decompress (lz_file, bin_file, tool_dir)
+        dec_time = min (dec_time or 1e9, time.perf_counter () - start)
+
+    if get_file_data (bin_file) != get_file_data (in_file):
+        raise Exception ("%s round trip of '%s' failed !" % (alg, in_file))
+
+    return os.path.getsize (lz_file), comp_time, dec_time
+
+
+def bench_compress (args):
+    if args.tool_dir == '':
+        if os.name == 'nt':
+            args.tool_dir = os.path.realpath (os.path.join (script_dir, '../../BaseTools/Bin/Win32'))
+        else:
+            args.tool_dir = os.path.realpath (os.path.join (script_dir, '../../BaseTools/BinWrappers/PosixLike'))
+
+    files = args.files if args.files else get_default_files ()
+    files = [each for each in files if os.path.getsize (each) > 0]
+    if len(files) == 0:
+        print ("No input file, build a platform first or give files on the command line !")
+        return 1
+
+    # The build cache would hide the compression time
+    set_build_cache_dir ('')
+
+    out_dir = tempfile.mkdtemp ()
+    total   = dict ((alg, [0, 0, 0.0, 0.0]) for alg in args.algs)
+    try:
+        print ('%-24s %-8s %10s %10s %7s %10s %10s' % ('File', 'Alg', 'Size', 'LzSize', 'Ratio', 'Comp MB/s', 'Dec MB/s'))
+        for in_file in files:
+            in_len = os.path.getsize (in_file)
+            for alg in args.algs:
+                lz_len, comp_time, dec_time = bench_file (in_file, alg, out_dir, args.tool_dir, args.repeat)
+                print ('%-24s %-8s %10d %10d %6.1f%% %10.1f %10.1f' % (os.path.basename (in_file)[-24:], alg, in_len, lz_len,
+                       lz_len * 100.0 / in_len, in_len / comp_time / 1e6, in_len / dec_time / 1e6))
+                total[alg][0] += in_len
+                total[alg][1] += lz_len
+                total[alg][2] += comp_time
+                total[alg][3] += dec_time
+
+        print ('')
+        for alg in args.algs:
+            in_len, lz_len, comp_time, dec_time = total[alg]
+            print ('%-24s %-8s %10d %10d %6.1f%% %10.1f %10.1f' % ('Total', alg, in_len, lz_len,
+                   lz_len * 100.0 / in_len, in_len / comp_time / 1e6, in_len / dec_time / 1e6))
+    finally:
+        shutil.rmtree (out_dir)
+
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('files', nargs='*', help='Files to compress, default to the stage and payload images in the build directory')
+    parser.add_argument('-a', '--alg', dest='algs', nargs='+', choices=compress_algs, default=compress_algs, help='Compression algorithms to compare')
+    parser.add_argument('-r', '--repeat', dest='repeat', type=int, default=3, help='Runs per file, the fastest one is reported')
+    parser.add_argument('-t', '--tooldir', dest='tool_dir', type=str, default='', help='Compression tool directory')
+    args = parser.parse_args()
+
+    return bench_compress (args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -444,6 +444,7 @@ class CONTAINER ():
         self.set_header_svn_info (svn)
 
         name_set = set()
+        comp_list = []
         is_last_entry = False
         for name, file, compress_alg, auth_type, key_file, alignment, region_size, svn in layout[1:]:
             if is_last_entry:
@@ -481,12 +482,21 @@ class CONTAINER ():
                     compress_alg        = 'Dummy'
                     is_last_entry       = True
 
-            # compress the component
+            comp_list.append ((component, region_size, (in_file, compress_alg, svn, auth_type, key_file)))
+
+        # compress and sign the components in parallel, unless the intermediate files would collide
+        def process_component (in_file, compress_alg, svn, auth_type, key_file):
             lz_file = compress (in_file, compress_alg, svn, self.out_dir, self.tool_dir)
-            component.data = bytearray(get_file_data (lz_file))
+            hash_data, auth_data = CONTAINER.calculate_auth_data (lz_file, auth_type, key_file, self.out_dir)
+            return bytearray(get_file_data (lz_file)), hash_data, auth_data
+
+        lz_names = set([os.path.splitext(os.path.basename(each[2][0]))[0] for each in comp_list])
+        results  = run_parallel (process_component, [each[2] for each in comp_list], 0 if len(lz_names) == len(comp_list) else 1)
 
-            # calculate the component auth info
-            component.hash_data, component.auth_data = CONTAINER.calculate_auth_data (lz_file, auth_type, key_file, self.out_dir)
+        for (component, region_size, _), (data, hash_data, auth_data) in zip(comp_list, results):
+            component.data      = data
+            component.hash_data = hash_data
+            component.auth_data = auth_data
             component.hash_size = len(component.hash_data)
             if region_size == 0:
                 # arrange the region size automatically
@@ -647,7 +657,7 @@ class CONTAINER ():
                     offset = sizeof(lz_header)
                     data = component.data[offset : offset + lz_header.compressed_len]
                     gen_file_from_object (bin_file, data)
-                elif signature in [b'LZMA', b'LZ4 ']:
+                elif signature in [b'LZMA', b'LZMF', b'LZ4 ']:
                     decompress (sig_file, bin_file, self.tool_dir)
                 else:
                     raise Exception ("Unknown LZ format!")
@@ -843,7 +853,7 @@ def main():
     cmd_display.add_argument('-o',  dest='out_image',  type=str, default='', help='Container new output image path')
     cmd_display.add_argument('-n',  dest='comp_name',  type=str, required=True, help='Component name to replace')
     cmd_display.add_argument('-f',  dest='comp_file',  type=str, required=True, help='Component input file path')
-    cmd_display.add_argument('-c',  dest='compress', choices=['lz4', 'lzma', 'dummy'], default='dummy', help='compression algorithm')
+    cmd_display.add_argument('-c',  dest='compress', choices=['lz4', 'lzma', 'lzmaF86', 'dummy'], default='dummy', help='compression algorithm')
     cmd_display.add_argument('-k',  dest='key_file',  type=str, default='', help='Key Id or Private key file path to sign component')
     cmd_display.add_argument('-td', dest='tool_dir', type=str, default='', help='Compression tool directory')
     cmd_display.add_argument('-s', dest='svn', type=int,  default=0, help='Security version number for Component')
@@ -853,7 +863,7 @@ def main():
     cmd_display = sub_parser.add_parser('sign', help='compress and sign a component image')
     cmd_display.add_argument('-f',  dest='comp_file',  type=str, required=True, help='Component input file path')
     cmd_display.add_argument('-o',  dest='out_file',  type=str, default='', help='Signed output image path')
-    cmd_display.add_argument('-c',  dest='compress', choices=['lz4', 'lzma', 'dummy'],  default='dummy', help='compression algorithm')
+    cmd_display.add_argument('-c',  dest='compress', choices=['lz4', 'lzma', 'lzmaF86', 'dummy'],  default='dummy', help='compression algorithm')
     cmd_display.add_argument('-a',  dest='auth', choices=['SHA2_256', 'SHA2_384', 'RSA2048_PKCS1_SHA2_256',
                 'RSA3072_PKCS1_SHA2_384', 'RSA2048_PSS_SHA2_256', 'RSA3072_PSS_SHA2_384', 'NONE'], default='NONE',  help='authentication algorithm')
     cmd_display.add_argument('-k',  dest='key_file',  type=str, default='', help='Key Id or Private key file path to sign component')
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+## @ NvBlobTool.py
+# This script compresses non-volatile data blobs, such as MRC training
+# data dumps, in the same formats as RleCompressLib: the RLE format and
+# the NV blob format (LZ4 block with an optional byte delta filter).
+# The 'bench' command compares the ratio and the time of both formats.
+#
+# Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import os
+import sys
+import time
+import struct
+import argparse
+
+from CommonUtility import *
+
+NV_BLOB_SIGNATURE    = b'NVLZ'
+NV_BLOB_METHOD_STORE = 0
+NV_BLOB_METHOD_LZ4   = 1
+NV_BLOB_HEADER_FMT   = '<4sIBBH'
+NV_BLOB_HEADER_SIZE  = struct.calcsize(NV_BLOB_HEADER_FMT)
+NV_BLOB_HASH_BITS    = 11
+NV_BLOB_STRIDES      = [1, 2, 4]
+
+LZ4_MIN_MATCH        = 4
+LZ4_LAST_LITERALS    = 5
+LZ4_MF_LIMIT         = 12
+LZ4_MAX_OFFSET       = 0xFFFF
+LZ4_RUN_MASK         = 0x0F
+
+
+def rle_compress (data):
+    # Same encoding as RleCompressData (): a byte repeated twice is
+    # followed by the count of further repeats, up to 253.
+    out   = bytearray()
+    index = 0
+    while index < len(data):
+        count = 1
+        while index + count < len(data) and data[index + count] == data[index] and count < 255:
+            count += 1
+        if count == 1:
+            out.append (data[index])
+        else:
+            out.extend ([data[index], data[index], count - 2])
+        index += count
+    return out
+
+
+def rle_decompress (data):
+    out   = bytearray()
+    index = 0
+    while index < len(data):
+        out.append (data[index])
+        if index + 1 < len(data) and data[index + 1] == data[index]:
+            out.append (data[index])
+            if index + 2 < len(data):
+                out.extend ([data[index]] * data[index + 2])
+            index += 3
+        else:
+            index += 1
+    return out
+
+
+def delta_filter (data, stride):
+    if stride == 0:
+        return bytes(data)
+    out = bytearray(data)
+    for index in range(stride, len(data)):
+        out[index] = (data[index] - data[index - stride]) & 0xFF
+    return bytes(out)
+
+
+def lz4_put_length (out, length):
+    while length >= 0xFF:
+        out.append (0xFF)
+        length -= 0xFF
+    out.append (length)
+
+
+def lz4_put_sequence (out, literals, offset, match_len):
+    token_index = len(out)
+    out.append (min(len(literals), LZ4_RUN_MASK) << 4)
+    if len(literals) >= LZ4_RUN_MASK:
+        lz4_put_length (out, len(literals) - LZ4_RUN_MASK)
+    out.extend (literals)
+    if match_len:
+        out.extend (struct.pack('<H', offset))
+        match_len -= LZ4_MIN_MATCH
+        out[token_index] |= min(match_len, LZ4_RUN_MASK)
+        if match_len >= LZ4_RUN_MASK:
+            lz4_put_length (out, match_len - LZ4_RUN_MASK)
+
+
+def lz4_compress (data):
+    # Greedy parse with the same hash table as NvBlobCodec.c, so the
+    # output is identical to the firmware compressor
+    out    = bytearray()
+    table  = [0] * (1 << NV_BLOB_HASH_BITS)
+    length = len(data)
+    anchor = 0
+    pos    = 0
+    while pos + LZ4_MF_LIMIT <= length:
+        seq  = struct.unpack_from('<I', data, pos)[0]
+        hash = ((seq * 2654435761) & 0xFFFFFFFF) >> (32 - NV_BLOB_HASH_BITS)
+        cand = (pos & ~0xFFFF) | table[hash]
+        if cand >= pos:
+            cand -= 0x10000
+        table[hash] = pos & 0xFFFF
+        if cand < 0 or pos - cand > LZ4_MAX_OFFSET or data[cand:cand + 4] != data[pos:pos + 4]:
+            pos += 1
+            continue
+        match_len = LZ4_MIN_MATCH
+        while pos + match_len < length - LZ4_LAST_LITERALS and data[pos + match_len] == data[cand + match_len]:
+            match_len += 1
+        lz4_put_sequence (out, data[anchor:pos], pos - cand, match_len)
+        pos   += match_len
+        anchor = pos
+    lz4_put_sequence (out, data[anchor:], 0, 0)
+    return out
+
+
+def lz4_decompress (data):
+    out   = bytearray()
+    index = 0
+    while index < len(data):
+        token = data[index]
+        index += 1
+        lit_len = token >> 4
+        if lit_len == LZ4_RUN_MASK:
+            while True:
+                lit_len += data[index]
+                index   += 1
+                if data[index - 1] != 0xFF:
+                    break
+        out.extend (data[index:index + lit_len])
+        index += lit_len
+        if index == len(data):
+            break
+        offset = struct.unpack_from('<H', data, index)[0]
+        index += 2
+        if offset == 0 or offset > len(out):
+            raise Exception ("Invalid LZ4 match offset !")
+        match_len = token & LZ4_RUN_MASK
+        if match_len == LZ4_RUN_MASK:
+            while True:
+                match_len += data[index]
+                index     += 1
+                if data[index - 1] != 0xFF:
+                    break
+        for _ in range(match_len + LZ4_MIN_MATCH):
+            out.append (out[-offset])
+    return out
+
+
+def nv_blob_compress (data):
+    best_stride = 0
+    best_data   = lz4_compress (data)
+    for stride in NV_BLOB_STRIDES:
+        lz_data = lz4_compress (delta_filter (data, stride))
+        if len(lz_data) < len(best_data):
+            best_stride = stride
+            best_data   = lz_data
+    if len(best_data) >= len(data):
+        header = struct.pack(NV_BLOB_HEADER_FMT, NV_BLOB_SIGNATURE, len(data), NV_BLOB_METHOD_STORE, 0, 0)
+        return header + bytes(data)
+    header = struct.pack(NV_BLOB_HEADER_FMT, NV_BLOB_SIGNATURE, len(data), NV_BLOB_METHOD_LZ4, best_stride, 0)
+    return header + bytes(best_data)
+
+
+def nv_blob_decompress (data):
+    signature, length, method, stride, _ = struct.unpack_from(NV_BLOB_HEADER_FMT, data)
+    if signature != NV_BLOB_SIGNATURE:
+        raise Exception ("Invalid NV blob signature !")
+    data = data[NV_BLOB_HEADER_SIZE:]
+    if method == NV_BLOB_METHOD_STORE:
+        out = bytearray(data)
+    elif method == NV_BLOB_METHOD_LZ4:
+        out = lz4_decompress (data)
+        for index in range(stride if stride else len(out), len(out)):
+            out[index] = (out[index] + out[index - stride]) & 0xFF
+    else:
+        raise Exception ("Unsupported NV blob method %d !" % method)
+    if len(out) != length:
+        raise Exception ("NV blob length mismatch !")
+    return out
+
+
+def time_call (func, data, repeat):
+    best = None
+    for _ in range(repeat):
+        start  = time.perf_counter ()
+        result = func (data)
+        spent  = time.perf_counter () - start
+        best   = spent if best is None else min(best, spent)
+    return result, best
+
+
+def cmd_bench (args):
+    print ('%-24s %8s %8s %7s %8s %7s %6s %9s %9s' % ('File', 'Size', 'Rle', 'Ratio', 'NvBlob', 'Ratio', 'Stride', 'Rle ms', 'NvBlob ms'))
+    total = [0, 0, 0]
+    for in_file in args.files:
+        data = bytes(get_file_data (in_file))
+        rle_data, rle_time = time_call (rle_compress, data, args.repeat)
+        nv_data,  nv_time  = time_call (nv_blob_compress, data, args.repeat)
+        if rle_decompress (rle_data) != data or nv_blob_decompress (nv_data) != data:
+            raise Exception ("Round trip of '%s' failed !" % in_file)
+        size = max(len(data), 1)
+        print ('%-24s %8d %8d %6.1f%% %8d %6.1f%% %6d %9.2f %9.2f' % (os.path.basename (in_file)[-24:], len(data),
+               len(rle_data), len(rle_data) * 100.0 / size, len(nv_data), len(nv_data) * 100.0 / size, nv_data[9],
+               rle_time * 1000, nv_time * 1000))
+        total[0] += len(data)
+        total[1] += len(rle_data)
+        total[2] += len(nv_data)
+
+    if len(args.files) > 1 and total[0]:
+        print ('%-24s %8d %8d %6.1f%% %8d %6.1f%%' % ('Total', total[0], total[1], total[1] * 100.0 / total[0],
+               total[2], total[2] * 100.0 / total[0]))
+    print ('\nTimes are from this host script, use them only to compare the two formats.')
+
+
+def cmd_compress (args):
+    gen_file_from_object (args.out_file, nv_blob_compress (bytes(get_file_data (args.in_file))))
+
+
+def cmd_decompress (args):
+    data = bytes(get_file_data (args.in_file))
+    if data[0:4] == NV_BLOB_SIGNATURE:
+        out = nv_blob_decompress (data)
+    else:
+        out = rle_decompress (data)
+    gen_file_from_object (args.out_file, out)
+
+
+def main():
+    parser     = argparse.ArgumentParser()
+    sub_parser = parser.add_subparsers(help='command')
+
+    cmd_display = sub_parser.add_parser('bench', help='compare RLE and NV blob compression of data dumps')
+    cmd_display.add_argument('files', nargs='+', help='Data dump files, such as MRC training data')
+    cmd_display.add_argument('-r', dest='repeat', type=int, default=3, help='Runs per file, the fastest one is reported')
+    cmd_display.set_defaults(func=cmd_bench)
+
+    cmd_display = sub_parser.add_parser('compress', help='create an NV blob')
+    cmd_display.add_argument('-i', dest='in_file', type=str, required=True, help='Input data file')
+    cmd_display.add_argument('-o', dest='out_file', type=str, required=True, help='Output NV blob file')
+    cmd_display.set_defaults(func=cmd_compress)
+
+    cmd_display = sub_parser.add_parser('decompress', help='decompress an NV blob or RLE data')
+    cmd_display.add_argument('-i', dest='in_file', type=str, required=True, help='Input NV blob or RLE file')
+    cmd_display.add_argument('-o', dest='out_file', type=str, required=True, help='Output data file')
+    cmd_display.set_defaults(func=cmd_decompress)
+
+    args = parser.parse_args()
+    try:
+        func = args.func
+    except AttributeError:
+        parser.error("too few arguments")
+
+    func(args)
+
+
+if __name__ == '__main__':
+    main()
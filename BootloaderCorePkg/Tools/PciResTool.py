@@ -0,0 +1,319 @@
+#!/usr/bin/env python3
+## @ PciResTool.py
+# This script models the PCI resource sizing done by CalculateResource ()
+# in PciEnumerationLib on synthetic topologies. The BARs of each bridge
+# level are bucketed by alignment and placed in one pass, with alignment
+# holes filled from the smaller buckets, exactly as the library does. The
+# insertion sorted layout used before is kept for comparison.
+# The 'test' command checks the layout invariants on random topologies,
+# the 'bench' command compares both allocators on a large topology.
+#
+# Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import sys
+import random
+import argparse
+
+PCI_BAR_TYPE_IO16    = 1
+PCI_BAR_TYPE_IO32    = 2
+PCI_BAR_TYPE_MEM32   = 3
+PCI_BAR_TYPE_PMEM32  = 4
+PCI_BAR_TYPE_MEM64   = 5
+PCI_BAR_TYPE_PMEM64  = 6
+PCI_BAR_TYPE_NAMES   = ['', 'Io16', 'Io32', 'Mem32', 'PMem32', 'Mem64', 'PMem64']
+
+PCI_MAX_BAR          = 6
+PPB_MAX_BAR          = 2
+PCI_BAR_BUCKETS      = 65
+
+# List nodes visited by the allocator, a host independent cost measure
+node_visits          = [0]
+
+
+class PciBar:
+    def __init__ (self, bar_type = 0, length = 0, alignment = 0):
+        self.bar_type  = bar_type
+        self.length    = length
+        self.alignment = alignment
+        self.base      = 0
+
+
+class PciDevice:
+    def __init__ (self):
+        self.pci_bar   = [PciBar () for idx in range(PCI_MAX_BAR)]
+        self.ppb_bar   = [PciBar () for idx in range(PPB_MAX_BAR)]
+        self.vf_bar    = [PciBar () for idx in range(PCI_MAX_BAR)]
+        self.children  = []
+
+
+def align_up (base, alignment):
+    # Same as the ALIGN () macro, Alignment is a mask
+    return (base + alignment) & ~alignment
+
+
+def get_bar_bucket (bar):
+    # Bucket index is HighBitSet64 (Alignment) + 1, or 0 without alignment
+    return bar.alignment.bit_length ()
+
+
+def get_level_bars (parent, bar_type, sriov):
+    # BARs of one bridge level, in the order CalculateResource () visits them
+    bars = []
+    for dev in parent.children:
+        if dev.children:
+            for bar in dev.ppb_bar:
+                if bar.length > 0 and bar.bar_type == bar_type:
+                    bars.append (bar)
+        for idx in range(PCI_MAX_BAR):
+            if dev.pci_bar[idx].bar_type == bar_type:
+                bars.append (dev.pci_bar[idx])
+            if sriov and dev.vf_bar[idx].bar_type == bar_type:
+                bars.append (dev.vf_bar[idx])
+    return bars
+
+
+def move_largest_pad_to_tail (bars):
+    # Only the last BAR of a bucket is not padded up to the bucket alignment
+    largest     = None
+    largest_pad = 0
+    node_visits[0] += len(bars)
+    for bar in bars:
+        pad = align_up (bar.length, bar.alignment) - bar.length
+        if pad > largest_pad:
+            largest_pad = pad
+            largest     = bar
+    if largest is not None:
+        bars.remove (largest)
+        bars.append (largest)
+
+
+def fill_bar_hole (buckets, bucket, base, limit):
+    while bucket > 0 and base < limit:
+        bucket -= 1
+        left = []
+        for bar in buckets[bucket]:
+            node_visits[0] += 1
+            start = align_up (base, bar.alignment)
+            if base < limit and start + bar.length <= limit:
+                bar.base = start
+                base     = start + bar.length
+            else:
+                left.append (bar)
+        buckets[bucket][:] = left
+    return base
+
+
+def place_bars_bucket (bars):
+    buckets = [[] for idx in range(PCI_BAR_BUCKETS)]
+    for bar in bars:
+        buckets[get_bar_bucket (bar)].append (bar)
+
+    base      = 0
+    alignment = 0
+    for bucket in range(PCI_BAR_BUCKETS - 1, -1, -1):
+        move_largest_pad_to_tail (buckets[bucket])
+        node_visits[0] += len(buckets[bucket])
+        for bar in buckets[bucket]:
+            alignment = max(alignment, bar.alignment)
+            start     = align_up (base, bar.alignment)
+            if start > base:
+                base = fill_bar_hole (buckets, bucket, base, start)
+            bar.base = start
+            base     = start + bar.length
+        buckets[bucket] = []
+    return base, alignment
+
+
+def place_bars_sorted (bars):
+    # Former layout: PerformInsertionSortList () with ComparePciBarRes ()
+    sorted_bars = []
+    for bar in bars:
+        pos = len(sorted_bars)
+        while pos > 0 and not (sorted_bars[pos - 1].alignment > bar.alignment):
+            pos -= 1
+        node_visits[0] += len(sorted_bars) - pos + 1
+        sorted_bars.insert (pos, bar)
+    node_visits[0] += len(sorted_bars)
+
+    base      = 0
+    alignment = 0
+    for bar in sorted_bars:
+        if alignment == 0:
+            alignment = bar.alignment
+        base     = align_up (base, bar.alignment)
+        bar.base = base
+        base    += bar.length
+    return base, alignment
+
+
+def calculate_resource (parent, bar_type, place, sriov):
+    for dev in parent.children:
+        if dev.children:
+            calculate_resource (dev, bar_type, place, sriov)
+
+    base, alignment = place (get_level_bars (parent, bar_type, sriov))
+
+    granularity = 0xFFF if bar_type <= PCI_BAR_TYPE_IO32 else 0xFFFFF
+    window = parent.pci_bar[bar_type - 1]
+    window.bar_type  = bar_type
+    window.alignment = max(alignment, granularity)
+    window.length    = align_up (base, granularity)
+
+
+def check_resource (parent, bar_type, sriov, path = 'root'):
+    window = parent.pci_bar[bar_type - 1]
+    bars   = get_level_bars (parent, bar_type, sriov)
+    ranges = []
+    for bar in bars:
+        if bar.base & bar.alignment:
+            raise Exception ('%s: %s BAR at 0x%X is not aligned to 0x%X' % (path, PCI_BAR_TYPE_NAMES[bar_type], bar.base, bar.alignment + 1))
+        if bar.base + bar.length > window.length:
+            raise Exception ('%s: %s BAR at 0x%X is outside of the 0x%X window' % (path, PCI_BAR_TYPE_NAMES[bar_type], bar.base, window.length))
+        if bar.alignment > window.alignment:
+            raise Exception ('%s: %s window alignment 0x%X is below a BAR alignment' % (path, PCI_BAR_TYPE_NAMES[bar_type], window.alignment + 1))
+        if bar.length > 0:
+            ranges.append ((bar.base, bar.base + bar.length))
+
+    ranges.sort ()
+    for idx in range(1, len(ranges)):
+        if ranges[idx][0] < ranges[idx - 1][1]:
+            raise Exception ('%s: %s BARs overlap at 0x%X' % (path, PCI_BAR_TYPE_NAMES[bar_type], ranges[idx][0]))
+
+    for idx, dev in enumerate(parent.children):
+        if dev.children:
+            check_resource (dev, bar_type, sriov, '%s/%d' % (path, idx))
+
+
+def add_bar (bars, rand, bar_type, length, alignment = None):
+    for bar in bars:
+        if bar.bar_type == 0:
+            bar.bar_type  = bar_type
+            bar.length    = length
+            bar.alignment = length - 1 if alignment is None else alignment
+            return
+
+
+def new_endpoint (rand):
+    dev = PciDevice ()
+    for idx in range(rand.randint (1, 4)):
+        kind = rand.random ()
+        if kind < 0.15:
+            add_bar (dev.pci_bar, rand, PCI_BAR_TYPE_IO16, 1 << rand.randint (2, 8))
+        elif kind < 0.55:
+            add_bar (dev.pci_bar, rand, PCI_BAR_TYPE_MEM32, 1 << rand.randint (12, 24))
+        elif kind < 0.75:
+            add_bar (dev.pci_bar, rand, PCI_BAR_TYPE_PMEM32, 1 << rand.randint (12, 28))
+        else:
+            add_bar (dev.pci_bar, rand, PCI_BAR_TYPE_PMEM64, 1 << rand.randint (14, 34))
+    if rand.random () < 0.1:
+        # SR-IOV VF BAR: NumVfs copies aligned to the size of one VF BAR
+        vf_size = 1 << rand.randint (14, 22)
+        add_bar (dev.vf_bar, rand, rand.choice ([PCI_BAR_TYPE_MEM32, PCI_BAR_TYPE_PMEM64]),
+                 vf_size * rand.randint (1, 64), vf_size - 1)
+    return dev
+
+
+def new_bridge (rand, depth, max_depth, fan_out):
+    dev = PciDevice ()
+    if rand.random () < 0.1:
+        add_bar (dev.ppb_bar, rand, PCI_BAR_TYPE_MEM32, 1 << rand.randint (12, 16))
+    for idx in range(rand.randint (1, fan_out)):
+        if depth < max_depth and rand.random () < 0.4:
+            dev.children.append (new_bridge (rand, depth + 1, max_depth, fan_out))
+        else:
+            dev.children.append (new_endpoint (rand))
+    return dev
+
+
+def new_topology (seed, ports, max_depth, fan_out):
+    rand = random.Random (seed)
+    root = PciDevice ()
+    for idx in range(ports):
+        if rand.random () < 0.6:
+            root.children.append (new_bridge (rand, 1, max_depth, fan_out))
+        else:
+            root.children.append (new_endpoint (rand))
+    return root
+
+
+def count_bars (parent):
+    count = 0
+    for dev in parent.children:
+        count += sum(1 for bar in dev.pci_bar + dev.vf_bar + dev.ppb_bar if bar.bar_type != 0)
+        count += count_bars (dev)
+    return count
+
+
+def run_allocator (args, seed, place):
+    root = new_topology (seed, args.ports, args.depth, args.fan_out)
+    node_visits[0] = 0
+    for bar_type in range(PCI_BAR_TYPE_IO16, PCI_BAR_TYPE_PMEM64 + 1):
+        calculate_resource (root, bar_type, place, args.sriov)
+    return root, node_visits[0]
+
+
+def cmd_test (args):
+    for seed in range(args.seed, args.seed + args.count):
+        bucket_root, bucket_visits = run_allocator (args, seed, place_bars_bucket)
+        sorted_root, sorted_visits = run_allocator (args, seed, place_bars_sorted)
+        for bar_type in range(PCI_BAR_TYPE_IO16, PCI_BAR_TYPE_PMEM64 + 1):
+            check_resource (bucket_root, bar_type, args.sriov, 'seed %d' % seed)
+            check_resource (sorted_root, bar_type, args.sriov, 'seed %d' % seed)
+            if bucket_root.pci_bar[bar_type - 1].length > sorted_root.pci_bar[bar_type - 1].length:
+                raise Exception ('seed %d: %s window grew from 0x%X to 0x%X' % (seed, PCI_BAR_TYPE_NAMES[bar_type],
+                                 sorted_root.pci_bar[bar_type - 1].length, bucket_root.pci_bar[bar_type - 1].length))
+    print ('%d topologies passed' % args.count)
+
+
+def cmd_bench (args):
+    bucket_root, bucket_visits = run_allocator (args, args.seed, place_bars_bucket)
+    sorted_root, sorted_visits = run_allocator (args, args.seed, place_bars_sorted)
+    print ('%d BARs, %d root ports, depth %d\n' % (count_bars (bucket_root), args.ports, args.depth))
+    print ('%-8s %14s %14s' % ('Type', 'Sorted', 'Bucketed'))
+    for bar_type in range(PCI_BAR_TYPE_IO16, PCI_BAR_TYPE_PMEM64 + 1):
+        print ('%-8s %14X %14X' % (PCI_BAR_TYPE_NAMES[bar_type], sorted_root.pci_bar[bar_type - 1].length,
+               bucket_root.pci_bar[bar_type - 1].length))
+    print ('%-8s %14d %14d' % ('Visits', sorted_visits, bucket_visits))
+    print ('\nVisits counts the BAR list nodes each allocator walks, it scales like the firmware run time.')
+
+
+def main():
+    parser     = argparse.ArgumentParser()
+    sub_parser = parser.add_subparsers(help='command')
+
+    cmd_display = sub_parser.add_parser('test', help='check the resource layout of random topologies')
+    cmd_display.add_argument('-n', dest='count', type=int, default=100, help='Number of topologies')
+    cmd_display.add_argument('-s', dest='seed', type=int, default=0, help='First random seed')
+    cmd_display.add_argument('-p', dest='ports', type=int, default=8, help='Root ports per topology')
+    cmd_display.add_argument('-d', dest='depth', type=int, default=6, help='Maximum bridge depth')
+    cmd_display.add_argument('-f', dest='fan_out', type=int, default=8, help='Maximum devices below a bridge')
+    cmd_display.add_argument('--no-sriov', dest='sriov', action='store_false', help='Ignore VF BARs, as without PcdSrIovSupport')
+    cmd_display.set_defaults(func=cmd_test)
+
+    cmd_display = sub_parser.add_parser('bench', help='compare both allocators on a large topology')
+    cmd_display.add_argument('-s', dest='seed', type=int, default=0, help='Random seed')
+    cmd_display.add_argument('-p', dest='ports', type=int, default=64, help='Root ports')
+    cmd_display.add_argument('-d', dest='depth', type=int, default=4, help='Maximum bridge depth')
+    cmd_display.add_argument('-f', dest='fan_out', type=int, default=16, help='Maximum devices below a bridge')
+    cmd_display.add_argument('--no-sriov', dest='sriov', action='store_false', help='Ignore VF BARs, as without PcdSrIovSupport')
+    cmd_display.set_defaults(func=cmd_bench)
+
+    args = parser.parse_args()
+    if not hasattr(args, 'func'):
+        parser.print_help()
+        return 1
+
+    try:
+        args.func(args)
+    except Exception as e:
+        print ('%s' % e)
+        return 1
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -162,6 +162,9 @@ class BaseBoard(object):
 
         self.KEY_GEN                 = 0
 
+        # Reuse compressed/signed post-build outputs whose inputs did not change
+        self._POST_BUILD_CACHE       = 1
+
         self.VERINFO_IMAGE_ID       = 'SB_???? '
         self.VERINFO_PROJ_ID        = 1
         self.VERINFO_CORE_MAJOR_VER = 0
@@ -218,6 +221,7 @@ class BaseBoard(object):
         self.ENABLE_CSME_UPDATE    = 0
         self.ENABLE_EMMC_HS400     = 1
         self.ENABLE_DMA_PROTECTION = 0
+        self.ENABLE_MEMORY_SCRUB   = 0
         self.ENABLE_MULTI_USB_BOOT_DEV = 0
         self.ENABLE_SBL_SETUP      = 0
         self.ENABLE_PAYLOD_MODULE  = 0
@@ -996,6 +1000,18 @@ class Build(object):
 
         rgn_name_list = [rgn['name'] for rgn in self._region_list]
 
+        # compress the existing source components in parallel up front, skipping
+        # components stitched by this function and ones listed with several algorithms
+        lz_algos = {}
+        out_list = [comp_name for comp_name, file_list in self._img_list]
+        for comp_name, file_list in self._img_list:
+            for src, algo, val, mode, pos in file_list:
+                if algo and not (mode & STITCH_OPS.MODE_FILE_IGNOR) and src not in out_list:
+                    lz_algos.setdefault (os.path.join(self._fv_dir, src), set()).add (algo)
+        lz_list = [(src_path, algos.pop()) for src_path, algos in lz_algos.items() if len(algos) == 1 and os.path.exists(src_path)]
+        run_parallel (compress, lz_list)
+        lz_done = set(lz_list)
+
         for idx, (comp_name, file_list)  in enumerate(self._img_list):
             if (self._board.ENABLE_FWU == 0) and (comp_name == 'Stitch_FWU.bin') :
                 print("No firmware update payload specified, skip firmware update.")
@@ -1017,7 +1033,8 @@ class Build(object):
                     raise Exception ("Component '%s' could not be found !" % src)
 
                 if algo:
-                    compress(src_path, algo)
+                    if (src_path, algo) not in lz_done:
+                        compress(src_path, algo)
                     src_path = bas_path + '.lz'
                 else:
                     if src == 'STAGE2.fd':
@@ -1302,6 +1319,38 @@ class Build(object):
 
     def post_build(self):
 
+        if self._board._POST_BUILD_CACHE:
+            set_build_cache_dir (os.path.join(self._workspace, 'Build', 'BootloaderCorePkg', 'PostBuildCache'))
+        else:
+            set_build_cache_dir ('')
+
+        # independent steps run in parallel, stitching waits for all of them.
+        # Payload and containers share intermediate file names in the FV dir,
+        # so they run one after the other and parallelize per component instead.
+        runner = BuildStepRunner ()
+        runner.add ('Components',  self.gen_post_build_components)
+        runner.add ('Payload',     self.gen_post_build_payload)
+        runner.add ('Containers',  self.gen_post_build_containers, ['Payload'])
+        runner.add ('PatchStages', self.patch_stages)
+        runner.add ('Redundant',   self.create_redundant_components, ['PatchStages'])
+        runner.add ('Stitch',      lambda : self.create_bootloader_image ('ImgStitch.txt'),
+                                   ['Components', 'Payload', 'Containers', 'Redundant'])
+        runner.run ()
+
+        # print flash map
+        if len(self._comp_list) > 0:
+            print_addr = False if getattr(self._board, "GetFlashMapList", None) else True
+            flash_map_text = decode_flash_map (os.path.join(self._fv_dir, 'FlashMap.bin'), print_addr)
+            print('%s' % flash_map_text)
+            fd = open (os.path.join(self._fv_dir, 'FlashMap.txt'), 'w')
+            fd.write (flash_map_text)
+            fd.close ()
+
+        print('Post-build steps:\n%s' % runner.report ())
+
+
+    def gen_post_build_components(self):
+
         # create bootloader reserved binary of 4K size
         gen_file_with_size (os.path.join(self._fv_dir, 'SBLRSVD.bin'), 0x1000)
 
@@ -1340,12 +1389,6 @@ class Build(object):
                 os.path.join(self._fv_dir, '../%s/Microcode.bin' % self._arch),
                 os.path.join(self._fv_dir, "UCODE.bin"))
 
-        # generate payload
-        gen_payload_bin (self._fv_dir, self._arch, self._pld_list,
-                         os.path.join(self._fv_dir, "PAYLOAD.bin"),
-                         self._board._CONTAINER_PRIVATE_KEY, HASH_VAL_STRING[self._board.SIGN_HASH_TYPE],
-                         self._board._SIGNING_SCHEME, self._board.BOARD_PKG_NAME)
-
         # create firmware update key
         if self._board.ENABLE_FWU:
             srcfile = "../%s/PayloadPkg/FirmwareUpdate/FirmwareUpdate/OUTPUT/FirmwareUpdate.efi" % self._arch
@@ -1360,31 +1403,23 @@ class Build(object):
                 file_space = getattr(self._board, 'SPI_IAS%d_SIZE' % idx)
                 gen_ias_file (file_path, file_space, os.path.join(self._fv_dir, "SPI_IAS%d.bin" % idx))
 
-        # generate container images
-        if getattr(self._board, "GetContainerList", None):
-            container_list = self._board.GetContainerList ()
-            component_dir = os.path.join(os.environ['PLT_SOURCE'], 'Platform', self._board.BOARD_PKG_NAME, 'Binaries')
-            gen_container_bin (container_list, self._fv_dir, component_dir, self._key_dir , '')
 
-        # patch stages
-        self.patch_stages ()
+    def gen_post_build_payload(self):
 
-        # create redundant components
-        self.create_redundant_components ()
+        # generate payload
+        gen_payload_bin (self._fv_dir, self._arch, self._pld_list,
+                         os.path.join(self._fv_dir, "PAYLOAD.bin"),
+                         self._board._CONTAINER_PRIVATE_KEY, HASH_VAL_STRING[self._board.SIGN_HASH_TYPE],
+                         self._board._SIGNING_SCHEME, self._board.BOARD_PKG_NAME)
 
 
-        # stitch all components
-        layout_name = 'ImgStitch.txt'
-        self.create_bootloader_image (layout_name)
+    def gen_post_build_containers(self):
 
-        # print flash map
-        if len(self._comp_list) > 0:
-            print_addr = False if getattr(self._board, "GetFlashMapList", None) else True
-            flash_map_text = decode_flash_map (os.path.join(self._fv_dir, 'FlashMap.bin'), print_addr)
-            print('%s' % flash_map_text)
-            fd = open (os.path.join(self._fv_dir, 'FlashMap.txt'), 'w')
-            fd.write (flash_map_text)
-            fd.close ()
+        # generate container images
+        if getattr(self._board, "GetContainerList", None):
+            container_list = self._board.GetContainerList ()
+            component_dir = os.path.join(os.environ['PLT_SOURCE'], 'Platform', self._board.BOARD_PKG_NAME, 'Binaries')
+            gen_container_bin (container_list, self._fv_dir, component_dir, self._key_dir , '')
 
 
 def main():
@@ -1423,7 +1458,8 @@ def main():
                                         USE_VERSION       = args.usever,      \
                                         _PAYLOAD_NAME     = args.payload,     \
                                         _FSP_PATH_NAME    = args.fsppath,     \
-                                        KEY_GEN           = args.keygen
+                                        KEY_GEN           = args.keygen,      \
+                                        _POST_BUILD_CACHE = 0 if args.nocache else 1
                                         );
                 os.environ['PLT_SOURCE']  = os.path.abspath (os.path.join (os.path.dirname (board_cfgs[index]), '../..'))
                 Build(board).build()
@@ -1439,6 +1475,7 @@ def main():
     buildp.add_argument('-p',  '--payload' , dest='payload', type=str, help='Payload file name', default ='OsLoader.efi')
     buildp.add_argument('board', metavar='board', choices=board_names, help='Board Name (%s)' % ', '.join(board_names))
     buildp.add_argument('-k', '--keygen', action='store_true', help='Generate default keys for signing')
+    buildp.add_argument('-nc', '--nocache', action='store_true', help='Do not reuse cached compressed/signed components in post-build')
     buildp.add_argument('-t', '--toolchain', dest='toolchain', type=str, default='', help='Perferred toolchain name')
     buildp.set_defaults(func=cmd_build)
 
@@ -134,6 +134,19 @@ GetLoaderPerformanceInfo (
   BL_PERF_DATA  *PerfData
   );
 
+/**
+  Attach the CPU task pool to the APs that the bootloader left waiting
+  in the MP task loop.
+
+  @retval EFI_SUCCESS        The task pool can use the APs.
+  @retval EFI_NOT_FOUND      MP CPU task info hob not found.
+
+**/
+EFI_STATUS
+PayloadCpuTaskPoolInit (
+  VOID
+  );
+
 /**
   Payload main entry.
 
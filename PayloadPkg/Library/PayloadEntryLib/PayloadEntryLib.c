@@ -27,6 +27,103 @@
 #include <Guid/BootLoaderVersionGuid.h>
 #include <Guid/LoaderPlatformInfoGuid.h>
 #include <Guid/PciRootBridgeInfoGuid.h>
+#include <Guid/MemoryMapInfoGuid.h>
+
+/**
+  Identity map the part of a range that lies above 4GB.
+
+  @param[in]      Base            Base address of the range.
+  @param[in]      Length          Length of the range.
+  @param[in, out] MaxLimit        Highest range limit seen so far.
+
+  @retval EFI_SUCCESS             The range is mapped or is below 4GB.
+  @retval Others                  The range could not be mapped.
+
+**/
+STATIC
+EFI_STATUS
+MapHighRange (
+  IN     UINT64                 Base,
+  IN     UINT64                 Length,
+  IN OUT UINT64                 *MaxLimit
+  )
+{
+  EFI_STATUS                Status;
+
+  if ((Length == 0) || (Base + Length <= BASE_4GB)) {
+    return EFI_SUCCESS;
+  }
+
+  *MaxLimit = MAX (*MaxLimit, Base + Length);
+  if (Base < BASE_4GB) {
+    Length -= BASE_4GB - Base;
+    Base    = BASE_4GB;
+  }
+
+  Status = IdentityMapMemoryRange (Base, Length);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to map 0x%lX - 0x%lX: %r\n", Base, Base + Length, Status));
+  }
+
+  return Status;
+}
+
+/**
+  Identity map everything above 4GB that the payload may access: the
+  64-bit PCI windows, the memory map entries and the resource HOBs.
+
+  The ranges are mapped on top of the page tables inherited from the
+  stage. If any of them cannot be mapped, the whole address space up to
+  the highest limit is mapped instead.
+
+**/
+STATIC
+VOID
+MapHighMemory (
+  VOID
+  )
+{
+  PCI_ROOT_BRIDGE_INFO_HOB      *RootBridgeInfoHob;
+  PCI_ROOT_BRIDGE_RESOURCE      *Resource;
+  MEMORY_MAP_INFO               *MemoryMapInfo;
+  EFI_PEI_HOB_POINTERS           Hob;
+  BOOLEAN                        MapFailed;
+  UINT64                         MaxLimit;
+  UINT32                         Count;
+  UINT32                         Index;
+
+  MapFailed = FALSE;
+  MaxLimit  = BASE_4GB;
+
+  RootBridgeInfoHob = (PCI_ROOT_BRIDGE_INFO_HOB *)GetGuidHobData (NULL, NULL, &gLoaderPciRootBridgeInfoGuid);
+  if (RootBridgeInfoHob != NULL) {
+    for (Count = 0; Count < RootBridgeInfoHob->Count; Count++) {
+      for (Index = 0; Index < PCI_MAX_BAR; Index++) {
+        if (((Index + 1) == PciBarTypeMem64) || ((Index + 1) == PciBarTypePMem64)) {
+          Resource = &RootBridgeInfoHob->Entry[Count].Resource[Index];
+          MapFailed |= EFI_ERROR (MapHighRange (Resource->ResBase, Resource->ResLength, &MaxLimit));
+        }
+      }
+    }
+  }
+
+  MemoryMapInfo = (MEMORY_MAP_INFO *)GetGuidHobData (NULL, NULL, &gLoaderMemoryMapInfoGuid);
+  if (MemoryMapInfo != NULL) {
+    for (Index = 0; Index < MemoryMapInfo->Count; Index++) {
+      MapFailed |= EFI_ERROR (MapHighRange (MemoryMapInfo->Entry[Index].Base, MemoryMapInfo->Entry[Index].Size, &MaxLimit));
+    }
+  }
+
+  for (Hob.Raw = GetHobListPtr (); !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (GET_HOB_TYPE (Hob) == EFI_HOB_TYPE_RESOURCE_DESCRIPTOR) {
+      MapFailed |= EFI_ERROR (MapHighRange (Hob.ResourceDescriptor->PhysicalStart, Hob.ResourceDescriptor->ResourceLength, &MaxLimit));
+    }
+  }
+
+  if (MapFailed && (MaxLimit > BASE_4GB)) {
+    CreateIdentityMappingPageTables ((UINT8)HighBitSet64 (MaxLimit - 1) + 1);
+  }
+}
 
 /**
   Initialize critical payload global data.
@@ -193,11 +290,6 @@ SecStartup (
   UINT32                    StackBase;
   UINT32                    StackSize;
   LOADER_PLATFORM_INFO      *LoaderPlatformInfo;
-  PCI_ROOT_BRIDGE_INFO_HOB  *RootBridgeInfoHob;
-  UINT64                    MaxResLimit;
-  UINT64                    ResLimit;
-  UINT8                     Count;
-  UINT8                     Index;
 
   TimeStamp = ReadTimeStamp ();
 
@@ -207,24 +299,9 @@ SecStartup (
   // DEBUG will be available after PayloadInit ()
   DEBUG ((DEBUG_INIT, "\nPayload startup\n"));
 
-  RootBridgeInfoHob = (PCI_ROOT_BRIDGE_INFO_HOB *)GetGuidHobData (NULL, NULL, &gLoaderPciRootBridgeInfoGuid);
-  if (RootBridgeInfoHob != NULL) {
-    MaxResLimit = BASE_4GB;
-    for (Count = 0; Count < RootBridgeInfoHob->Count; Count++) {
-      for (Index = 0; Index < PCI_MAX_BAR; Index++) {
-        if (((Index + 1) == PciBarTypeMem64) || ((Index + 1) == PciBarTypePMem64)) {
-          ResLimit = RootBridgeInfoHob->Entry[Count].Resource[Index].ResBase
-                   + RootBridgeInfoHob->Entry[Count].Resource[Index].ResLength;
-          MaxResLimit = MAX (MaxResLimit, ResLimit);
-        }
-      }
-    }
-
-    // Only create paging in X64 mode
-    if (IS_X64 && (MaxResLimit > BASE_4GB)) {
-      Index = (UINT8)HighBitSet64 (MaxResLimit - 1);
-      CreateIdentityMappingPageTables (Index + 1);
-    }
+  // Only extend paging in X64 mode
+  if (IS_X64) {
+    MapHighMemory ();
   }
 
   // Copy libraries data
@@ -16,6 +16,7 @@
 #include <Guid/FspHeaderFile.h>
 #include <Guid/BootLoaderServiceGuid.h>
 #include <Guid/LoaderPlatformInfoGuid.h>
+#include <Library/CpuTaskPoolLib.h>
 
 /**
   Returns the System table info HOB data.
@@ -296,3 +297,29 @@ GetLoaderPerformanceInfo (
   return EFI_SUCCESS;
 }
 
+/**
+  Attach the CPU task pool to the APs that the bootloader left waiting
+  in the MP task loop.
+
+  @retval EFI_SUCCESS        The task pool can use the APs.
+  @retval EFI_NOT_FOUND      MP CPU task info hob not found.
+
+**/
+EFI_STATUS
+PayloadCpuTaskPoolInit (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE             *GuidHob;
+  SYS_CPU_TASK_HOB              *SysCpuTaskHob;
+
+  GuidHob = GetNextGuidHob (&gLoaderMpCpuTaskInfoGuid, (VOID *)(UINTN)PcdGet32 (PcdPayloadHobList));
+  if (GuidHob == NULL) {
+    CpuTaskPoolInit (NULL);
+    return EFI_NOT_FOUND;
+  }
+
+  SysCpuTaskHob = (SYS_CPU_TASK_HOB *)GET_GUID_HOB_DATA (GuidHob);
+  return CpuTaskPoolInit ((SYS_CPU_TASK *)(UINTN)SysCpuTaskHob->SysCpuTask);
+}
+
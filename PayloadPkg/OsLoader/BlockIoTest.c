@@ -27,6 +27,10 @@ TestDevBlocks (
   UINT32                       Index;
   UINT8                        *TestData1;
   UINT8                        *TestData2;
+  UINT8                        *PerfBuffer;
+  UINT64                       ReadSize;
+  UINT64                       StartTick;
+  UINT64                       ElapsedNs;
   DEVICE_BLOCK_INFO            BlockInfo;
   UINT64                       TestLba;
   UINTN                        BootMediumPciBase;
@@ -77,12 +81,15 @@ TestDevBlocks (
   TestData2 = TestData1 + 4096;
   SetMem32 (TestData1, 4096 / 4, 0x00FF5AA5);
   SetMem32 (TestData2, 4096 / 4, 0x11224488);
-
+  PerfBuffer = (UINT8 *)AllocatePages (EFI_SIZE_TO_PAGES (TEST_READ_PERF_SIZE));
 
   //Init the device.
   Status = DevBlockFunc.DevInit (BootMediumPciBase, DevInitAll);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_INFO, "Mmcinitialize Error %r\n", Status));
+    if (PerfBuffer != NULL) {
+      FreePages (PerfBuffer, EFI_SIZE_TO_PAGES (TEST_READ_PERF_SIZE));
+    }
     return Status;
   }
 
@@ -96,6 +103,19 @@ TestDevBlocks (
     }
     DEBUG ((DEBUG_INFO, "\nP[%d]: BlockNum=0x%lx BlockSize=0x%x\n", Index, BlockInfo.BlockNum, BlockInfo.BlockSize));
 
+    if ((BlockInfo.BlockNum != 0) && (BlockInfo.BlockSize != 0) && (PerfBuffer != NULL)) {
+      // Measure sequential read throughput with a single large request
+      ReadSize  = MultU64x32 (BlockInfo.BlockNum, BlockInfo.BlockSize);
+      ReadSize  = MIN (ReadSize, TEST_READ_PERF_SIZE);
+      StartTick = GetPerformanceCounter ();
+      Status    = DevBlockFunc.ReadBlocks (Index, 0, (UINTN)ReadSize, PerfBuffer);
+      ElapsedNs = GetTimeInNanoSecond (GetPerformanceCounter () - StartTick);
+      if (!EFI_ERROR (Status) && (ElapsedNs != 0)) {
+        DEBUG ((DEBUG_INFO, "    P[%d]: Read 0x%lx bytes in %ld us (%ld KB/s)\n", Index, ReadSize,
+                DivU64x32 (ElapsedNs, 1000), DivU64x64Remainder (MultU64x32 (ReadSize, 1000000), ElapsedNs, NULL)));
+      }
+    }
+
     if ((BlockInfo.BlockNum != 0) && (BlockInfo.BlockSize != 0)) {
       // Test last block read/write
       TestLba = BlockInfo.BlockNum - 1;
@@ -134,6 +154,10 @@ TestDevBlocks (
       DumpBuffer (Buffer, 0x200);
     }
   }
+
+  if (PerfBuffer != NULL) {
+    FreePages (PerfBuffer, EFI_SIZE_TO_PAGES (TEST_READ_PERF_SIZE));
+  }
   return EFI_SUCCESS;
 }
 #endif
@@ -12,6 +12,7 @@
 #include <Library/DebugLib.h>
 #include <Library/PayloadLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
 
 #include <Library/MmcAccessLib.h>
 #include <Library/SpiBlockIoLib.h>
@@ -20,6 +21,7 @@
 #include <Guid/OsBootOptionGuid.h>
 
 #define TEST_DEVICE_WRITE     0
+#define TEST_READ_PERF_SIZE   SIZE_4MB
 
 /**
   Perform the BlockIO test for the given device type.
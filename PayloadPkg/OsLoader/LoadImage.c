@@ -649,7 +649,14 @@ FreeImageData (
 
   if (ImageData->AllocType >= ImageAllocateTypeMax) {
     return;
-  } else if (ImageData->AllocType == ImageAllocateTypePool) {
+  }
+
+  if (FeaturePcdGet (PcdMemoryScrubEnabled) && (ImageData->AllocType != ImageAllocateTypePointer)) {
+    // Do not leave boot image content behind in freed memory
+    CpuTaskPoolScrubMemory ((UINTN)ImageData->Addr, ImageData->Size, 0);
+  }
+
+  if (ImageData->AllocType == ImageAllocateTypePool) {
     FreePool (ImageData->Addr);
   } else if (ImageData->AllocType == ImageAllocateTypePage) {
     FreePages (ImageData->Addr, EFI_SIZE_TO_PAGES (ImageData->Size));
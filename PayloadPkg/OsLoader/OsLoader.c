@@ -1279,6 +1279,9 @@ PayloadMain (
   DEBUG ((DEBUG_INFO, "\n\n====================Os Loader====================\n\n"));
   AddMeasurePoint (0x4010);
 
+  // Parked APs can take parallel work until ReadyToBoot
+  PayloadCpuTaskPoolInit ();
+
   //
   // Get Boot Image Info
   //
@@ -65,6 +65,7 @@
 #include <Register/Intel/Msr/ArchitecturalMsr.h>
 #include "PreOsChecker.h"
 #include <Library/StringSupportLib.h>
+#include <Library/CpuTaskPoolLib.h>
 #include <PreOsHeader.h>
 
 
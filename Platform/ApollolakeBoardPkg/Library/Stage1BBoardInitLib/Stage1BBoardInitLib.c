@@ -1944,7 +1944,16 @@ FindNvsData (
     CopyMem (CompressedData, (UINT8 *)(UINTN)MrcDataBase + MrcParamsOffset + sizeof (MRC_PARAM_HDR), DataSize);
 
     DEBUG ((DEBUG_INFO, "Decompress ParamData\n"));
-    DataSize = (UINT32)RleDecompressData (CompressedData, DataSize, MrcParamData);
+    if (*(UINT32 *)CompressedData == NV_BLOB_SIGNATURE) {
+      DataSize = (UINT32)NvBlobDecompress (CompressedData, DataSize, MrcParamData, SIZE_64KB - SIZE_1KB);
+      if (DataSize == 0) {
+        Status = EFI_NOT_FOUND;
+        break;
+      }
+    } else {
+      // Data saved by older firmware
+      DataSize = (UINT32)RleDecompressData (CompressedData, DataSize, MrcParamData);
+    }
 
     DEBUG ((DEBUG_INFO, "Read MRC VarData at 0x%X\n", MrcDataBase + MrcNvDataOffset));
     MrcVarHdr = (MRC_VAR_HDR *)MemPool;
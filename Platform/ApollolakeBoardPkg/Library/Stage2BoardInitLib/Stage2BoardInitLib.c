@@ -1389,14 +1389,16 @@ SaveNvsData (
 
   Status = EFI_SUCCESS;
   do {
-    // Compare data to see if it is the same
-    if (CompareMem (TmpPtr, PlatformData->MrcParamHdr.Crc, sizeof (PlatformData->MrcParamHdr.Crc)) == 0) {
+    // Compare data to see if it is the same as the valid copy in flash
+    if ((PlatformData->MrcParamHdr.Signature == MRC_PARAM_SIGNATURE) &&
+        (CompareMem (TmpPtr, PlatformData->MrcParamHdr.Crc, sizeof (PlatformData->MrcParamHdr.Crc)) == 0)) {
       DEBUG ((DEBUG_INFO, "MRC VarData matches data in flash, skip update!\n"));
       break;
     }
 
-    DataSize  = (UINT32)RleCompressData (Buffer, Length, (UINT8 *)MemPool + sizeof (MRC_PARAM_HDR));
+    DataSize  = (UINT32)NvBlobCompress (Buffer, Length, (UINT8 *)MemPool + sizeof (MRC_PARAM_HDR));
     DataSize += sizeof (MRC_PARAM_HDR);
+    DEBUG ((DEBUG_INFO, "MRC ParamData compressed 0x%X -> 0x%X\n", Length, DataSize));
 
     DEBUG ((DEBUG_INFO, "Writing MRC ParamData to SPI BIOS @ 0x%X:0x%X\n", BiosOffset + MrcParamsOffset, DataSize));
     Status = SpiFlashErase (FlashRegionBios, BiosOffset + MrcParamsOffset, ALIGN_UP (DataSize, SIZE_4KB));
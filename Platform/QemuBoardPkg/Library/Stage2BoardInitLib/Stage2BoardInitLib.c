@@ -253,17 +253,29 @@ BoardInit (
     break;
 
   case PrePayloadLoading:
+    // The writes are recorded in the S3 boot script on normal boot. They are
+    // still done directly on S3 resume so the lock down never depends on the
+    // script, which lives in memory the OS can modify.
     // Hide TSEG
-    PciOr8 (PCI_LIB_ADDRESS(0, 0, 0, MCH_ESMRAMC), MCH_ESMRAMC_T_EN);
+    Status = S3BootScriptWrite (S3_BOOT_SCRIPT_PCI, 1, PCI_LIB_ADDRESS(0, 0, 0, MCH_ESMRAMC),
+                                MCH_ESMRAMC_T_EN, MCH_ESMRAMC_T_EN);
+    ASSERT_EFI_ERROR (Status);
     // Close TSEG
-    PciAndThenOr8 (PCI_LIB_ADDRESS(0, 0, 0, MCH_SMRAM), (UINT8)~MCH_SMRAM_D_OPEN, MCH_SMRAM_D_CLOSE);
+    Status = S3BootScriptWrite (S3_BOOT_SCRIPT_PCI, 1, PCI_LIB_ADDRESS(0, 0, 0, MCH_SMRAM),
+                                MCH_SMRAM_D_CLOSE, MCH_SMRAM_D_OPEN | MCH_SMRAM_D_CLOSE);
+    ASSERT_EFI_ERROR (Status);
     if (PcdGet8 (PcdSmmRebaseMode) == SMM_REBASE_ENABLE) {
-      PciOr8 (PCI_LIB_ADDRESS(0, 0, 0, MCH_SMRAM), MCH_SMRAM_D_LCK);
+      Status = S3BootScriptWrite (S3_BOOT_SCRIPT_PCI, 1, PCI_LIB_ADDRESS(0, 0, 0, MCH_SMRAM),
+                                  MCH_SMRAM_D_LCK, MCH_SMRAM_D_LCK);
+      ASSERT_EFI_ERROR (Status);
       // Lock down SMI_EN register
       PmBase = PciRead32 (POWER_MGMT_REGISTER_Q35 (ICH9_PMBASE)) & ICH9_PMBASE_MASK;
-      IoWrite32 (PmBase + ICH9_PMBASE_OFS_SMI_EN, 0);
+      Status = S3BootScriptWrite (S3_BOOT_SCRIPT_IO, 4, PmBase + ICH9_PMBASE_OFS_SMI_EN, 0, 0);
+      ASSERT_EFI_ERROR (Status);
       // Prevent software from undoing the above (until platform reset).
-      PciOr16 (POWER_MGMT_REGISTER_Q35 (ICH9_GEN_PMCON_1),  ICH9_GEN_PMCON_1_SMI_LOCK);
+      Status = S3BootScriptWrite (S3_BOOT_SCRIPT_PCI, 2, POWER_MGMT_REGISTER_Q35 (ICH9_GEN_PMCON_1),
+                                  ICH9_GEN_PMCON_1_SMI_LOCK, ICH9_GEN_PMCON_1_SMI_LOCK);
+      ASSERT_EFI_ERROR (Status);
     }
     break;
 
@@ -27,6 +27,7 @@
 #include <Library/FspSupportLib.h>
 #include <Library/BoardSupportLib.h>
 #include <Library/ContainerLib.h>
+#include <Library/S3SaveRestoreLib.h>
 #include <Guid/GraphicsInfoHob.h>
 #include <Guid/SystemTableInfoGuid.h>
 #include <Guid/SerialPortInfoGuid.h>